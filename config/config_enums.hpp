@@ -389,4 +389,13 @@ enum ConfigKey_t : uint16_t {
 	TOGGLE_MAX_CONNECTIONS_BY_IP,
 	MAX_IP_CONNECTIONS,
 	STASH_MANAGE_AMOUNT,
+	DISPATCHER_TIMING_WHEEL,
+	DISPATCHER_PROFILER,
+	DISPATCHER_SLOW_CYCLE_BUDGET,
+	PATHFINDING_FLOW_FIELD,
+	NETWORK_THREADS,
+	PACKET_COMPRESSION_STREAMING,
+	PACKET_COMPRESSION_CPU_BUDGET,
+	MYSQL_CONNECTION_POOL_SIZE,
+	MYSQL_PIN_TRANSACTIONS,
 };
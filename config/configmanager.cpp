@@ -27,11 +27,22 @@
 	#define lua_strlen lua_rawlen
 #endif
 
+// Keys are used as array indexes
+static_assert(magic_enum::enum_values<ConfigKey_t>().front() == 0);
+static_assert(magic_enum::enum_values<ConfigKey_t>().back() == ConfigSnapshot::KEYS - 1);
+
+ConfigManager::ConfigManager() {
+	published.emplace_back(std::make_unique<const ConfigSnapshot>());
+	current.store(published.back().get(), std::memory_order_release);
+}
+
 ConfigManager &ConfigManager::getInstance() {
 	return inject<ConfigManager>();
 }
 
 bool ConfigManager::load() {
+	std::scoped_lock lock(loadMutex);
+
 	lua_State* L = luaL_newstate();
 	if (!L) {
 		throw std::ios_base::failure("Failed to allocate memory");
@@ -45,6 +56,9 @@ bool ConfigManager::load() {
 		return false;
 	}
 
+	// Start from the live values, keys that are only read on the first load keep them
+	pending = std::make_unique<ConfigSnapshot>(snapshot());
+
 	// Parse config
 	// Info that must be loaded one time (unless we reset the modules involved)
 	if (!loaded) {
@@ -57,6 +71,8 @@ bool ConfigManager::load() {
 		loadBoolConfig(L, TOGGLE_MAINTAIN_MODE, "toggleMaintainMode", false);
 		loadBoolConfig(L, TOGGLE_MAP_CUSTOM, "toggleMapCustom", true);
 		loadBoolConfig(L, MYSQL_DB_BACKUP, "mysqlDatabaseBackup", false);
+		loadBoolConfig(L, DISPATCHER_TIMING_WHEEL, "dispatcherTimingWheel", false);
+		loadBoolConfig(L, MYSQL_PIN_TRANSACTIONS, "mysqlPinTransactions", true);
 
 		loadFloatConfig(L, HOUSE_PRICE_RENT_MULTIPLIER, "housePriceRentMultiplier", 1.0);
 		loadFloatConfig(L, HOUSE_RENT_RATE, "houseRentRate", 1.0);
@@ -70,6 +86,7 @@ bool ConfigManager::load() {
 		loadIntConfig(L, PREMIUM_DEPOT_LIMIT, "premiumDepotLimit", 8000);
 		loadIntConfig(L, SQL_PORT, "mysqlPort", 3306);
 		loadIntConfig(L, STATUS_PORT, "statusProtocolPort", 7171);
+		loadIntConfig(L, MYSQL_CONNECTION_POOL_SIZE, "mysqlConnectionPoolSize", 4);
 
 		loadStringConfig(L, AUTH_TYPE, "authType", "password");
 		loadStringConfig(L, HOUSE_RENT_PERIOD, "houseRentPeriod", "never");
@@ -135,6 +152,9 @@ bool ConfigManager::load() {
 	loadBoolConfig(L, STAMINA_SYSTEM, "staminaSystem", true);
 	loadBoolConfig(L, STAMINA_TRAINER, "staminaTrainer", false);
 	loadBoolConfig(L, STASH_MOVING, "stashMoving", false);
+	loadBoolConfig(L, DISPATCHER_PROFILER, "dispatcherProfiler", false);
+	loadBoolConfig(L, PATHFINDING_FLOW_FIELD, "pathfindingFlowField", false);
+	loadBoolConfig(L, PACKET_COMPRESSION_STREAMING, "packetCompressionStreaming", false); // One deflate stream per connection, about 53 KB each
 	loadBoolConfig(L, TASK_HUNTING_ENABLED, "taskHuntingSystemEnabled", true);
 	loadBoolConfig(L, TASK_HUNTING_FREE_THIRD_SLOT, "taskHuntingFreeThirdSlot", false);
 	loadBoolConfig(L, TELEPORT_PLAYER_TO_VOCATION_ROOM, "teleportPlayerToVocationRoom", true);
@@ -404,6 +424,9 @@ bool ConfigManager::load() {
 	loadIntConfig(L, EXPERIENCE_SHARE_ACTIVITY, "experienceShareActivity", 2 * 60 * 1000);
 	loadIntConfig(L, MAX_IP_CONNECTIONS, "maxIPConnections", 4);
 	loadIntConfig(L, STASH_MANAGE_AMOUNT, "stashManageAmount", 100000);
+	loadIntConfig(L, DISPATCHER_SLOW_CYCLE_BUDGET, "dispatcherSlowCycleBudget", 50);
+	loadIntConfig(L, NETWORK_THREADS, "networkThreads", 0);
+	loadIntConfig(L, PACKET_COMPRESSION_CPU_BUDGET, "packetCompressionCpuBudget", 0);
 
 	loadStringConfig(L, CORE_DIRECTORY, "coreDirectory", "data");
 	loadStringConfig(L, DATA_DIRECTORY, "dataPackDirectory", "data-global");
@@ -428,6 +451,10 @@ bool ConfigManager::load() {
 
 	loaded = true;
 	lua_close(L);
+
+	const ConfigSnapshot* next = pending.get();
+	published.emplace_back(std::move(pending));
+	current.store(next, std::memory_order_release);
 	return true;
 }
 
@@ -439,6 +466,11 @@ bool ConfigManager::reload() {
 	return result;
 }
 
+void ConfigManager::setConfig(const ConfigKey_t &key, ConfigValue &&value) {
+	pending->values[key] = std::move(value);
+	pending->present[key] = true;
+}
+
 void ConfigManager::missingConfigWarning(const char* identifier) {
 	g_logger().debug("[{}]: Missing configuration for identifier: {}", __FUNCTION__, identifier);
 }
@@ -451,7 +483,7 @@ std::string ConfigManager::loadStringConfig(lua_State* L, const ConfigKey_t &key
 	} else {
 		missingConfigWarning(identifier);
 	}
-	configs[key] = value;
+	setConfig(key, value);
 	lua_pop(L, 1);
 	return value;
 }
@@ -464,7 +496,7 @@ int32_t ConfigManager::loadIntConfig(lua_State* L, const ConfigKey_t &key, const
 	} else {
 		missingConfigWarning(identifier);
 	}
-	configs[key] = value;
+	setConfig(key, value);
 	lua_pop(L, 1);
 	return value;
 }
@@ -477,7 +509,7 @@ bool ConfigManager::loadBoolConfig(lua_State* L, const ConfigKey_t &key, const c
 	} else {
 		missingConfigWarning(identifier);
 	}
-	configs[key] = value;
+	setConfig(key, value);
 	lua_pop(L, 1);
 	return value;
 }
@@ -490,39 +522,39 @@ float ConfigManager::loadFloatConfig(lua_State* L, const ConfigKey_t &key, const
 	} else {
 		missingConfigWarning(identifier);
 	}
-	configs[key] = value;
+	setConfig(key, value);
 	lua_pop(L, 1);
 	return value;
 }
 
 const std::string &ConfigManager::getString(const ConfigKey_t &key, const std::source_location &location /*= std::source_location::current()*/) const {
 	static const std::string dummyStr;
-	if (configs.contains(key) && std::holds_alternative<std::string>(configs.at(key))) {
-		return std::get<std::string>(configs.at(key));
+	if (const auto* value = find<std::string>(key)) {
+		return *value;
 	}
 	g_logger().warn("[{}] accessing invalid or wrong type index: {}[{}]. Called line: {}:{}, in {}", __FUNCTION__, magic_enum::enum_name(key), fmt::underlying(key), location.line(), location.column(), location.function_name());
 	return dummyStr;
 }
 
 int32_t ConfigManager::getNumber(const ConfigKey_t &key, const std::source_location &location /*= std::source_location::current()*/) const {
-	if (configs.contains(key) && std::holds_alternative<int32_t>(configs.at(key))) {
-		return std::get<int32_t>(configs.at(key));
+	if (const auto* value = find<int32_t>(key)) {
+		return *value;
 	}
 	g_logger().warn("[{}] accessing invalid or wrong type index: {}[{}]. Called line: {}:{}, in {}", __FUNCTION__, magic_enum::enum_name(key), fmt::underlying(key), location.line(), location.column(), location.function_name());
 	return 0;
 }
 
 bool ConfigManager::getBoolean(const ConfigKey_t &key, const std::source_location &location /*= std::source_location::current()*/) const {
-	if (configs.contains(key) && std::holds_alternative<bool>(configs.at(key))) {
-		return std::get<bool>(configs.at(key));
+	if (const auto* value = find<bool>(key)) {
+		return *value;
 	}
 	g_logger().warn("[{}] accessing invalid or wrong type index: {}[{}]. Called line: {}:{}, in {}", __FUNCTION__, magic_enum::enum_name(key), fmt::underlying(key), location.line(), location.column(), location.function_name());
 	return false;
 }
 
 float ConfigManager::getFloat(const ConfigKey_t &key, const std::source_location &location /*= std::source_location::current()*/) const {
-	if (configs.contains(key) && std::holds_alternative<float>(configs.at(key))) {
-		return std::get<float>(configs.at(key));
+	if (const auto* value = find<float>(key)) {
+		return *value;
 	}
 	g_logger().warn("[{}] accessing invalid or wrong type index: {}[{}]. Called line: {}:{}, in {}", __FUNCTION__, magic_enum::enum_name(key), fmt::underlying(key), location.line(), location.column(), location.function_name());
 	return 0.0f;
@@ -21,9 +21,20 @@
 
 using ConfigValue = std::variant<std::string, int32_t, bool, float>;
 
+/**
+ * All config values indexed by ConfigKey_t. A snapshot is immutable once published, a reload
+ * builds a new one and swaps the pointer, so readers on any thread never take a lock.
+ */
+struct ConfigSnapshot {
+	static constexpr size_t KEYS = magic_enum::enum_count<ConfigKey_t>();
+
+	std::array<ConfigValue, KEYS> values {};
+	std::array<bool, KEYS> present {};
+};
+
 class ConfigManager {
 public:
-	ConfigManager() = default;
+	ConfigManager();
 
 	// Singleton - ensures we don't accidentally copy it
 	ConfigManager(const ConfigManager &) = delete;
@@ -50,7 +61,28 @@ public:
 	[[nodiscard]] float getFloat(const ConfigKey_t &key, const std::source_location &location = std::source_location::current()) const;
 
 private:
-	phmap::flat_hash_map<ConfigKey_t, ConfigValue> configs;
+	const ConfigSnapshot &snapshot() const {
+		return *current.load(std::memory_order_acquire);
+	}
+
+	template <typename T>
+	const T* find(const ConfigKey_t &key) const {
+		const auto &configs = snapshot();
+		if (key >= ConfigSnapshot::KEYS || !configs.present[key]) {
+			return nullptr;
+		}
+		return std::get_if<T>(&configs.values[key]);
+	}
+
+	void setConfig(const ConfigKey_t &key, ConfigValue &&value);
+
+	std::atomic<const ConfigSnapshot*> current;
+	// Snapshot being filled by load(), published when it ends
+	std::unique_ptr<ConfigSnapshot> pending;
+	// Every published snapshot is kept, getString hands out references that must survive a reload
+	std::vector<std::unique_ptr<const ConfigSnapshot>> published;
+	std::mutex loadMutex;
+
 	std::string loadStringConfig(lua_State* L, const ConfigKey_t &key, const char* identifier, const std::string &defaultValue);
 	int32_t loadIntConfig(lua_State* L, const ConfigKey_t &key, const char* identifier, const int32_t &defaultValue);
 	bool loadBoolConfig(lua_State* L, const ConfigKey_t &key, const char* identifier, const bool &defaultValue);
@@ -54,15 +54,15 @@ TalkActionResult_t Spells::playerSaySpell(const std::shared_ptr<Player> &player,
 			return TALKACTION_FAILED;
 		}
 	}
-	std::string str_words = words;
-
 	if (player->hasCondition(CONDITION_FEARED)) {
 		player->sendTextMessage(MESSAGE_FAILURE, "You are feared.");
 		return TALKACTION_FAILED;
 	}
 
-	// strip trailing spaces
-	trimString(str_words);
+	// strip leading and trailing spaces, without copying the spoken line
+	std::string_view str_words = words;
+	const auto firstChar = str_words.find_first_not_of(' ');
+	str_words = firstChar == std::string_view::npos ? std::string_view {} : str_words.substr(firstChar, str_words.find_last_not_of(' ') - firstChar + 1);
 
 	const auto &instantSpell = getInstantSpell(str_words);
 	if (!instantSpell) {
@@ -74,7 +74,7 @@ TalkActionResult_t Spells::playerSaySpell(const std::shared_ptr<Player> &player,
 	if (instantSpell->getHasParam()) {
 		size_t spellLen = instantSpell->getWords().length();
 		size_t paramLen = str_words.length() - spellLen;
-		std::string paramText = str_words.substr(spellLen, paramLen);
+		std::string paramText(str_words.substr(spellLen, paramLen));
 		if (!paramText.empty() && paramText.front() == ' ') {
 			size_t loc1 = paramText.find('"', 1);
 			if (loc1 != std::string::npos) {
@@ -117,6 +117,7 @@ TalkActionResult_t Spells::playerSaySpell(const std::shared_ptr<Player> &player,
 
 void Spells::clear() {
 	instants.clear();
+	instantWords.clear();
 	runes.clear();
 }
 
@@ -129,7 +130,15 @@ bool Spells::hasInstantSpell(const std::string &word) const {
 }
 
 void Spells::setInstantSpell(const std::string &word, const std::shared_ptr<InstantSpell> &instant) {
-	instants.try_emplace(word, instant);
+	if (!instants.try_emplace(word, instant).second) {
+		return;
+	}
+
+	// Words differing only in case share a trie entry, the first one in map order wins as the old scan did
+	auto &entry = instantWords.emplace(word);
+	if (!entry || word < entry->getWords()) {
+		entry = instant;
+	}
 }
 
 bool Spells::registerInstantLuaEvent(const std::shared_ptr<InstantSpell> &instant) {
@@ -231,38 +240,25 @@ std::shared_ptr<RuneSpell> Spells::getRuneSpellByName(const std::string &name) {
 	return nullptr;
 }
 
-std::shared_ptr<InstantSpell> Spells::getInstantSpell(const std::string &words) {
-	std::shared_ptr<InstantSpell> result = nullptr;
-
-	for (auto &it : instants) {
-		const std::string &instantSpellWords = it.second->getWords();
-		size_t spellLen = instantSpellWords.length();
-		if (strncasecmp(instantSpellWords.c_str(), words.c_str(), spellLen) == 0) {
-			if (!result || spellLen > result->getWords().length()) {
-				result = it.second;
-				if (words.length() == spellLen) {
-					break;
-				}
-			}
-		}
+std::shared_ptr<InstantSpell> Spells::getInstantSpell(std::string_view words) {
+	size_t spellLen = 0;
+	const auto* match = instantWords.findLongestPrefix(words, spellLen);
+	if (!match) {
+		return nullptr;
 	}
 
-	if (result) {
-		const std::string &resultWords = result->getWords();
-		if (words.length() > resultWords.length()) {
-			if (!result->getHasParam()) {
-				return nullptr;
-			}
+	const auto &result = *match;
+	if (words.length() > spellLen) {
+		if (!result->getHasParam()) {
+			return nullptr;
+		}
 
-			size_t spellLen = resultWords.length();
-			size_t paramLen = words.length() - spellLen;
-			if (paramLen < 2 || words[spellLen] != ' ') {
-				return nullptr;
-			}
+		size_t paramLen = words.length() - spellLen;
+		if (paramLen < 2 || words[spellLen] != ' ') {
+			return nullptr;
 		}
-		return result;
 	}
-	return nullptr;
+	return result;
 }
 
 std::shared_ptr<InstantSpell> Spells::getInstantSpellById(uint16_t spellId) {
@@ -19,6 +19,7 @@
 
 #include "lua/creature/actions.hpp"
 #include "creatures/players/wheel/wheel_definitions.hpp"
+#include "utils/word_trie.hpp"
 
 class InstantSpell;
 class RuneSpell;
@@ -48,7 +49,7 @@ public:
 	std::shared_ptr<RuneSpell> getRuneSpell(uint16_t id);
 	std::shared_ptr<RuneSpell> getRuneSpellByName(const std::string &name);
 
-	std::shared_ptr<InstantSpell> getInstantSpell(const std::string &words);
+	std::shared_ptr<InstantSpell> getInstantSpell(std::string_view words);
 	std::shared_ptr<InstantSpell> getInstantSpellByName(const std::string &name);
 
 	std::shared_ptr<InstantSpell> getInstantSpellById(uint16_t spellId);
@@ -72,6 +73,8 @@ public:
 private:
 	std::map<uint16_t, std::shared_ptr<RuneSpell>> runes;
 	std::map<std::string, std::shared_ptr<InstantSpell>> instants;
+	// Case-folded words of the instants, resolves spoken lines without scanning every spell
+	WordTrie<std::shared_ptr<InstantSpell>> instantWords;
 
 	friend class CombatSpell;
 };
@@ -731,6 +731,8 @@ protected:
 	}
 
 	Position position;
+	// Slot in the spectator index of the MapSector that holds the creature
+	uint32_t sectorIndex = 0;
 
 	CountMap damageMap;
 
@@ -838,6 +840,7 @@ protected:
 
 	friend class Game;
 	friend class Map;
+	friend class MapSector;
 	friend class CreatureFunctions;
 
 	void addAsyncTask(std::function<void()> &&fnc) {
@@ -33,7 +33,7 @@
 int32_t Monster::despawnRange;
 int32_t Monster::despawnRadius;
 
-uint32_t Monster::monsterAutoID = 0x50000001;
+uint32_t Monster::monsterAutoID = Monster::FIRST_ID;
 
 std::shared_ptr<Monster> Monster::createMonster(const std::string &name) {
 	const auto &mType = g_monsters().getMonsterType(name);
@@ -652,7 +652,7 @@ void Monster::updateTargetList() {
 		return !target || target->getHealth() <= 0 || !canSee(target->getPosition());
 	});
 
-	for (const auto &spectator : Spectators().find<Creature>(position, true, 0, 0, 0, 0, false)) {
+	for (const auto &spectator : Spectators().find<Creature>(position, true)) {
 		if (spectator.get() != this && canSee(spectator->getPosition())) {
 			onCreatureFound(spectator);
 		}
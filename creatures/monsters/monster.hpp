@@ -192,6 +192,8 @@ public:
 
 	BlockType_t blockHit(const std::shared_ptr<Creature> &attacker, const CombatType_t &combatType, int32_t &damage, bool checkDefense = false, bool checkArmor = false, bool field = false) override;
 
+	// First id handed out, ids count up from here and are never reused
+	static constexpr uint32_t FIRST_ID = 0x50000001;
 	static uint32_t monsterAutoID;
 
 	void applyStacks();
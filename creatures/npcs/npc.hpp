@@ -113,6 +113,8 @@ public:
 	void removeShopPlayer(uint32_t playerGUID);
 	void closeAllShopWindows();
 
+	// First id handed out, ids count up from here and are never reused
+	static constexpr uint32_t FIRST_ID = 0x80000000;
 	static uint32_t npcAutoID;
 
 	void onCreatureWalk() override;
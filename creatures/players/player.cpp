@@ -136,7 +136,7 @@ bool Player::isPushable() {
 	return Creature::isPushable();
 }
 
-std::shared_ptr<Task> Player::createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) {
+std::shared_ptr<Task> Player::createPlayerTask(uint32_t delay, TaskFunction &&f, std::string_view context) {
 	return std::make_shared<Task>(std::move(f), context, delay);
 }
 
@@ -2128,6 +2128,12 @@ void Player::sendDistanceShoot(const Position &from, const Position &to, uint16_
 	}
 }
 
+void Player::sendDistanceShoot(BroadcastMessage &broadcast, const Position &from, const Position &to, uint16_t type) const {
+	if (client) {
+		client->sendDistanceShoot(broadcast, from, to, type);
+	}
+}
+
 void Player::sendHouseWindow(const std::shared_ptr<House> &house, uint32_t listId) const {
 	if (!client) {
 		return;
@@ -2223,12 +2229,24 @@ void Player::sendMagicEffect(const Position &pos, uint16_t type) const {
 	}
 }
 
+void Player::sendMagicEffect(BroadcastMessage &broadcast, const Position &pos, uint16_t type) const {
+	if (client) {
+		client->sendMagicEffect(broadcast, pos, type);
+	}
+}
+
 void Player::removeMagicEffect(const Position &pos, uint16_t type) const {
 	if (client) {
 		client->removeMagicEffect(pos, type);
 	}
 }
 
+void Player::removeMagicEffect(BroadcastMessage &broadcast, const Position &pos, uint16_t type) const {
+	if (client) {
+		client->removeMagicEffect(broadcast, pos, type);
+	}
+}
+
 void Player::sendPing() {
 	const int64_t timeNow = OTSYS_TIME();
 
@@ -2301,6 +2319,12 @@ void Player::sendTextMessage(const TextMessage &message) const {
 	}
 }
 
+void Player::sendTextMessage(BroadcastMessage &broadcast, MessageClasses mclass, const std::string &message) const {
+	if (client) {
+		client->sendTextMessage(broadcast, TextMessage(mclass, message));
+	}
+}
+
 void Player::sendReLoginWindow(uint8_t unfairFightReduction) const {
 	if (client) {
 		client->sendReLoginWindow(unfairFightReduction);
@@ -8496,6 +8520,12 @@ void Player::sendCreatureMove(const std::shared_ptr<Creature> &creature, const P
 	}
 }
 
+void Player::sendCreatureMove(BroadcastMessage &broadcast, const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport) const {
+	if (client) {
+		client->sendMoveCreature(broadcast, creature, newPos, newStackPos, oldPos, oldStackPos, teleport);
+	}
+}
+
 void Player::sendCreatureTurn(const std::shared_ptr<Creature> &creature) {
 	if (!creature) {
 		return;
@@ -8520,6 +8550,12 @@ void Player::sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakCla
 	}
 }
 
+void Player::sendCreatureSay(BroadcastMessage &broadcast, const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos) const {
+	if (client) {
+		client->sendCreatureSay(broadcast, creature, type, text, pos);
+	}
+}
+
 void Player::sendCreatureReload(const std::shared_ptr<Creature> &creature) const {
 	if (client) {
 		client->reloadCreature(creature);
@@ -23,12 +23,15 @@
 #include "grouping/guild.hpp"
 #include "items/cylinder.hpp"
 #include "game/movement/position.hpp"
+#include "game/scheduling/task.hpp"
 #include "creatures/creatures_definitions.hpp"
 #include "creatures/players/animus_mastery/animus_mastery.hpp"
+#include "io/functions/player_save_state.hpp"
 
 class AnimusMastery;
 class House;
 class NetworkMessage;
+class BroadcastMessage;
 class Weapon;
 class ProtocolGame;
 class Party;
@@ -168,7 +171,7 @@ public:
 		return static_self_cast<Player>();
 	}
 
-	static std::shared_ptr<Task> createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context);
+	static std::shared_ptr<Task> createPlayerTask(uint32_t delay, TaskFunction &&f, std::string_view context);
 
 	void setID() override;
 
@@ -809,8 +812,10 @@ public:
 	void sendChannelEvent(uint16_t channelId, const std::string &playerName, ChannelEvent_t channelEvent) const;
 	void sendCreatureAppear(const std::shared_ptr<Creature> &creature, const Position &pos, bool isLogin);
 	void sendCreatureMove(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport) const;
+	void sendCreatureMove(BroadcastMessage &broadcast, const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport) const;
 	void sendCreatureTurn(const std::shared_ptr<Creature> &creature);
 	void sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos = nullptr) const;
+	void sendCreatureSay(BroadcastMessage &broadcast, const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos = nullptr) const;
 	void sendCreatureReload(const std::shared_ptr<Creature> &creature) const;
 	void sendPrivateMessage(const std::shared_ptr<Player> &speaker, SpeakClasses type, const std::string &text) const;
 	void sendCreatureSquare(const std::shared_ptr<Creature> &creature, SquareColor_t color) const;
@@ -901,6 +906,7 @@ public:
 	void sendPartyPlayerVocation(const std::shared_ptr<Player> &player) const;
 	void sendPlayerVocation(const std::shared_ptr<Player> &player) const;
 	void sendDistanceShoot(const Position &from, const Position &to, uint16_t type) const;
+	void sendDistanceShoot(BroadcastMessage &broadcast, const Position &from, const Position &to, uint16_t type) const;
 	void sendHouseWindow(const std::shared_ptr<House> &house, uint32_t listId) const;
 	void sendCreatePrivateChannel(uint16_t channelId, const std::string &channelName) const;
 	void sendClosePrivate(uint16_t channelId);
@@ -911,7 +917,9 @@ public:
 	void sendClientCheck() const;
 	void sendGameNews() const;
 	void sendMagicEffect(const Position &pos, uint16_t type) const;
+	void sendMagicEffect(BroadcastMessage &broadcast, const Position &pos, uint16_t type) const;
 	void removeMagicEffect(const Position &pos, uint16_t type) const;
+	void removeMagicEffect(BroadcastMessage &broadcast, const Position &pos, uint16_t type) const;
 	void sendPing();
 	void sendPingBack() const;
 	void sendStats();
@@ -920,6 +928,7 @@ public:
 	void sendSkills() const;
 	void sendTextMessage(MessageClasses mclass, const std::string &message) const;
 	void sendTextMessage(const TextMessage &message) const;
+	void sendTextMessage(BroadcastMessage &broadcast, MessageClasses mclass, const std::string &message) const;
 	void sendReLoginWindow(uint8_t unfairFightReduction) const;
 	void sendTextWindow(const std::shared_ptr<Item> &item, uint16_t maxlen, bool canWrite) const;
 	void sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, uint16_t channelId) const;
@@ -1650,6 +1659,9 @@ private:
 	bool mountsModified = false;
 	bool outfitsModified = false;
 
+	// What the last save wrote, the next one only writes the sections that changed
+	PlayerSaveState saveState;
+
 	std::array<CharmInfo, magic_enum::enum_count<charmRune_t>() + 1> charmsArray = {};
 	uint32_t charmPoints = 0;
 	uint32_t minorCharmEchoes = 0;
@@ -8,6 +8,7 @@
 #include "creatures/players/imbuements/imbuements.hpp"
 #include "creatures/players/storages/storages.hpp"
 #include "database/databasemanager.hpp"
+#include "database/databasetasks.hpp"
 #include "declarations.hpp"
 #include "game/game.hpp"
 #include "game/scheduling/dispatcher.hpp"
@@ -78,6 +79,9 @@ void CrystalServer::initialize() {
 	// Czekamy na zakończenie ładowania konfiguracji, ponieważ może być potrzebna dalej
 	configFuture.get();
 
+	g_dispatcher().useTimingWheel(g_configManager().getBoolean(DISPATCHER_TIMING_WHEEL));
+	DispatcherProfiler::configure(g_configManager().getBoolean(DISPATCHER_PROFILER), static_cast<uint32_t>(std::max(0, g_configManager().getNumber(DISPATCHER_SLOW_CYCLE_BUDGET))));
+
 	logger.info("Server protocol: {}.{:02d}{}", CLIENT_VERSION_UPPER, CLIENT_VERSION_LOWER, g_configManager().getBoolean(OLD_PROTOCOL) ? " and 10x allowed!" : "");
 
 #ifdef FEATURE_METRICS
@@ -134,6 +138,7 @@ void CrystalServer::shutdown() {
     g_dispatcher().shutdown();
     g_metrics().shutdown();
     inject<ThreadPool>().shutdown();
+    g_databaseTasks().shutdown();
     std::exit(0);
 }
 
@@ -296,6 +301,7 @@ void CrystalServer::initializeDatabase() {
 		throw FailedToInitializeCrystalServer("Failed to connect to database!");
 	}
 	logger.debug("MySQL Version: {}", Database::getClientVersion());
+	g_databaseTasks().start();
 
 	logger.debug("Running database manager...");
 	if (!DatabaseManager::isDatabaseSetup()) {
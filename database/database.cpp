@@ -23,9 +23,14 @@
 #include "utils/tools.hpp"
 #include <ctime>
 
+thread_local Database::Connection* Database::leasedConnection = nullptr;
+
 Database::~Database() {
-	if (handle != nullptr) {
-		mysql_close(handle);
+	for (const auto &connection : connections) {
+		closeStatements(*connection);
+		if (connection->handle != nullptr) {
+			mysql_close(connection->handle);
+		}
 	}
 }
 
@@ -38,17 +43,51 @@ bool Database::connect() {
 }
 
 bool Database::connect(const std::string* host, const std::string* user, const std::string* password, const std::string* database, uint32_t port, const std::string* sock) {
+	if (host->empty() || user->empty() || password->empty() || database->empty() || port <= 0) {
+		g_logger().warn("MySQL host, user, password, database or port not provided");
+	}
+
+	auto primary = std::make_unique<Connection>();
+	if (!openConnection(*primary, host, user, password, database, port, sock)) {
+		if (primary->handle) {
+			mysql_close(primary->handle);
+		}
+		return false;
+	}
+	connections.emplace_back(std::move(primary));
+
+	// The pool is optional, a connection that fails to open only shrinks it
+	const auto poolSize = std::max<int32_t>(1, g_configManager().getNumber(MYSQL_CONNECTION_POOL_SIZE));
+	for (int32_t i = 1; i < poolSize; ++i) {
+		auto connection = std::make_unique<Connection>();
+		if (!openConnection(*connection, host, user, password, database, port, sock)) {
+			if (connection->handle) {
+				mysql_close(connection->handle);
+			}
+			g_logger().warn("Opened {} of {} MySQL pool connections", connections.size(), poolSize);
+			break;
+		}
+
+		std::scoped_lock lock { poolLock };
+		idleConnections.emplace_back(connection.get());
+		connections.emplace_back(std::move(connection));
+	}
+
+	DBResult_ptr result = storeQuery("SHOW VARIABLES LIKE 'max_allowed_packet'");
+	if (result) {
+		maxPacketSize = result->getNumber<uint64_t>("Value");
+	}
+	return true;
+}
+
+bool Database::openConnection(Connection &connection, const std::string* host, const std::string* user, const std::string* password, const std::string* database, uint32_t port, const std::string* sock) {
 	// connection handle initialization
-	handle = mysql_init(nullptr);
+	auto* handle = connection.handle = mysql_init(nullptr);
 	if (!handle) {
 		g_logger().error("Failed to initialize MySQL connection handle.");
 		return false;
 	}
 
-	if (host->empty() || user->empty() || password->empty() || database->empty() || port <= 0) {
-		g_logger().warn("MySQL host, user, password, database or port not provided");
-	}
-
 	// automatic reconnect
 	bool reconnect = true;
 	mysql_options(handle, MYSQL_OPT_RECONNECT, &reconnect);
@@ -62,14 +101,64 @@ bool Database::connect(const std::string* host, const std::string* user, const s
 		g_logger().error("MySQL Error Message: {}", mysql_error(handle));
 		return false;
 	}
+	return true;
+}
 
-	DBResult_ptr result = storeQuery("SHOW VARIABLES LIKE 'max_allowed_packet'");
-	if (result) {
-		maxPacketSize = result->getNumber<uint64_t>("Value");
+Database::Connection* Database::getConnection() const {
+	if (leasedConnection) {
+		return leasedConnection;
 	}
+	return connections.empty() ? nullptr : connections.front().get();
+}
+
+bool Database::leaseConnection() {
+	if (leasedConnection || connections.size() < 2) {
+		return false;
+	}
+
+	metrics::lock_latency measureLock("database_pool");
+	std::unique_lock lock { poolLock };
+	poolCondition.wait(lock, [this] { return !idleConnections.empty(); });
+	measureLock.stop();
+
+	leasedConnection = idleConnections.back();
+	idleConnections.pop_back();
 	return true;
 }
 
+bool Database::tryLeaseConnection() {
+	if (leasedConnection || connections.size() < 2) {
+		return false;
+	}
+
+	std::scoped_lock lock { poolLock };
+	if (idleConnections.empty()) {
+		return false;
+	}
+
+	leasedConnection = idleConnections.back();
+	idleConnections.pop_back();
+	return true;
+}
+
+void Database::releaseConnection() {
+	if (!leasedConnection) {
+		return;
+	}
+
+	{
+		std::scoped_lock lock { poolLock };
+		idleConnections.emplace_back(leasedConnection);
+	}
+	leasedConnection = nullptr;
+	poolCondition.notify_one();
+}
+
+uint64_t Database::getLastInsertId() const {
+	const auto* connection = getConnection();
+	return connection ? static_cast<uint64_t>(mysql_insert_id(connection->handle)) : 0;
+}
+
 void Database::createDatabaseBackup(bool compress) const {
 	if (!g_configManager().getBoolean(MYSQL_DB_BACKUP)) {
 		return;
@@ -164,45 +253,65 @@ void Database::createDatabaseBackup(bool compress) const {
 	}
 }
 
+bool Database::pinTransaction(bool &leased) {
+	if (!g_configManager().getBoolean(MYSQL_PIN_TRANSACTIONS)) {
+		return false;
+	}
+
+	// The caller may be the dispatcher holding a player lock that a pool job waits for, so it never waits for the pool
+	leased = tryLeaseConnection();
+	return true;
+}
+
 bool Database::beginTransaction() {
-	if (!executeQuery("BEGIN")) {
+	auto* connection = getConnection();
+	if (!connection) {
+		g_logger().error("Database not initialized!");
 		return false;
 	}
+
+	// Held until commit or rollback, no other thread may slip a query in after BEGIN
 	metrics::lock_latency measureLock("database");
-	databaseLock.lock();
+	connection->lock.lock();
 	measureLock.stop();
 
+	if (!executeQuery("BEGIN")) {
+		connection->lock.unlock();
+		return false;
+	}
 	return true;
 }
 
 bool Database::rollback() {
-	if (!handle) {
+	auto* connection = getConnection();
+	if (!connection || !connection->handle) {
 		g_logger().error("Database not initialized!");
 		return false;
 	}
 
-	if (mysql_rollback(handle) != 0) {
-		g_logger().error("Message: {}", mysql_error(handle));
-		databaseLock.unlock();
+	if (mysql_rollback(connection->handle) != 0) {
+		g_logger().error("Message: {}", mysql_error(connection->handle));
+		connection->lock.unlock();
 		return false;
 	}
 
-	databaseLock.unlock();
+	connection->lock.unlock();
 	return true;
 }
 
 bool Database::commit() {
-	if (!handle) {
+	auto* connection = getConnection();
+	if (!connection || !connection->handle) {
 		g_logger().error("Database not initialized!");
 		return false;
 	}
-	if (mysql_commit(handle) != 0) {
-		g_logger().error("Message: {}", mysql_error(handle));
-		databaseLock.unlock();
+	if (mysql_commit(connection->handle) != 0) {
+		g_logger().error("Message: {}", mysql_error(connection->handle));
+		connection->lock.unlock();
 		return false;
 	}
 
-	databaseLock.unlock();
+	connection->lock.unlock();
 	return true;
 }
 
@@ -211,6 +320,7 @@ bool Database::isRecoverableError(unsigned int error) {
 }
 
 bool Database::retryQuery(std::string_view query, int retries) {
+	auto* handle = getConnection()->handle;
 	while (retries > 0 && mysql_query(handle, query.data()) != 0) {
 		g_logger().error("Query: {}", query.substr(0, 256));
 		g_logger().error("MySQL error [{}]: {}", mysql_errno(handle), mysql_error(handle));
@@ -229,7 +339,8 @@ bool Database::retryQuery(std::string_view query, int retries) {
 }
 
 bool Database::executeQuery(std::string_view query) {
-	if (!handle) {
+	auto* connection = getConnection();
+	if (!connection || !connection->handle) {
 		g_logger().error("Database not initialized!");
 		return false;
 	}
@@ -237,28 +348,184 @@ bool Database::executeQuery(std::string_view query) {
 	g_logger().trace("Executing Query: {}", query);
 
 	metrics::lock_latency measureLock("database");
-	std::scoped_lock lock { databaseLock };
+	std::scoped_lock lock { connection->lock };
 	measureLock.stop();
 
 	metrics::query_latency measure(query.substr(0, 50));
 	bool success = retryQuery(query, 10);
-	mysql_free_result(mysql_store_result(handle));
+	mysql_free_result(mysql_store_result(connection->handle));
+	g_metrics().addCounter("database_bytes_sent", static_cast<double>(query.size()), { { "protocol", "text" } });
 
 	return success;
 }
 
+namespace {
+	// Narrows the number to the width it is bound with, the same bits serve signed and unsigned columns
+	template <typename Narrow, typename T>
+	void storeNumber(int64_t &slot, T value) {
+		const auto narrowed = static_cast<Narrow>(value);
+		std::memcpy(&slot, &narrowed, sizeof(Narrow));
+	}
+}
+
+bool Database::executePrepared(std::string_view query, std::span<const DBParam> params) {
+	auto* connection = getConnection();
+	if (!connection || !connection->handle) {
+		g_logger().error("Database not initialized!");
+		return false;
+	}
+
+	g_logger().trace("Executing prepared query: {}", query);
+
+	std::vector<MYSQL_BIND> binds(params.size());
+	std::vector<unsigned long> lengths(params.size());
+	std::vector<int64_t> numbers(params.size());
+	// Every execute also carries two type bytes per parameter
+	size_t bytes = params.size() * 2;
+	for (size_t i = 0; i < params.size(); ++i) {
+		auto &bind = binds[i];
+		const auto &param = params[i];
+		bytes += param.size();
+		std::visit(
+			[&](const auto &value) {
+				using T = std::decay_t<decltype(value)>;
+				if constexpr (std::is_same_v<T, std::nullptr_t>) {
+					bind.buffer_type = MYSQL_TYPE_NULL;
+				} else if constexpr (std::is_same_v<T, std::string>) {
+					bind.buffer_type = param.binary ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING;
+					bind.buffer = const_cast<char*>(value.data());
+					bind.buffer_length = lengths[i] = static_cast<unsigned long>(value.size());
+					bind.length = &lengths[i];
+				} else {
+					bind.buffer = &numbers[i];
+					bind.is_unsigned = std::is_same_v<T, uint64_t>;
+					switch (param.width) {
+						case 1:
+							bind.buffer_type = MYSQL_TYPE_TINY;
+							storeNumber<int8_t>(numbers[i], value);
+							break;
+						case 2:
+							bind.buffer_type = MYSQL_TYPE_SHORT;
+							storeNumber<int16_t>(numbers[i], value);
+							break;
+						case 4:
+							bind.buffer_type = MYSQL_TYPE_LONG;
+							storeNumber<int32_t>(numbers[i], value);
+							break;
+						default:
+							bind.buffer_type = MYSQL_TYPE_LONGLONG;
+							storeNumber<int64_t>(numbers[i], value);
+							break;
+					}
+				}
+			},
+			param.value
+		);
+	}
+
+	metrics::lock_latency measureLock("database");
+	std::scoped_lock lock { connection->lock };
+	measureLock.stop();
+
+	metrics::query_latency measure(query.substr(0, 50));
+	bool reprepared = false;
+	for (int retries = 10; retries > 0; --retries) {
+		unsigned int error = 0;
+		bool cached = false;
+		auto* statement = prepareStatement(*connection, query, error, cached);
+		if (statement) {
+			if (mysql_stmt_bind_param(statement, binds.data()) == 0 && mysql_stmt_execute(statement) == 0) {
+				mysql_stmt_free_result(statement);
+				g_metrics().addCounter("database_bytes_sent", static_cast<double>(bytes), { { "protocol", "binary" } });
+				return true;
+			}
+
+			error = mysql_stmt_errno(statement);
+			g_logger().error("Query: {}", query.substr(0, 256));
+			g_logger().error("MySQL error [{}]: {}", error, mysql_stmt_error(statement));
+			closeStatement(*connection, query);
+
+			// A cached handle may predate an auto reconnect made by a text query (CR_STMT_CLOSED and alike),
+			// whatever the error it gets prepared again once before giving up
+			if (cached && !reprepared) {
+				reprepared = true;
+				continue;
+			}
+		}
+
+		if (isRecoverableError(error)) {
+			// Statements do not survive a reconnect
+			closeStatements(*connection);
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+		} else if (error != 1243 /*ER_UNKNOWN_STMT_HANDLER*/ && error != 1615 /*ER_NEED_REPREPARE*/ && error != 2056 /*CR_STMT_CLOSED*/) {
+			return false;
+		}
+	}
+
+	g_logger().error("Prepared query {} failed after {} retries.", query.substr(0, 256), 10);
+	return false;
+}
+
+MYSQL_STMT* Database::prepareStatement(Connection &connection, std::string_view query, unsigned int &error, bool &cached) {
+	if (const auto it = connection.statements.find(query); it != connection.statements.end()) {
+		cached = true;
+		return it->second;
+	}
+
+	auto* statement = mysql_stmt_init(connection.handle);
+	if (!statement) {
+		error = mysql_errno(connection.handle);
+		g_logger().error("Failed to initialize MySQL statement: {}", mysql_error(connection.handle));
+		return nullptr;
+	}
+
+	if (mysql_stmt_prepare(statement, query.data(), static_cast<unsigned long>(query.size())) != 0) {
+		error = mysql_stmt_errno(statement);
+		g_logger().error("Query: {}", query.substr(0, 256));
+		g_logger().error("MySQL error [{}]: {}", error, mysql_stmt_error(statement));
+		mysql_stmt_close(statement);
+		return nullptr;
+	}
+
+	// Queries with literals inlined never repeat, start over rather than grow without bound
+	if (connection.statements.size() >= MAX_PREPARED_STATEMENTS) {
+		closeStatements(connection);
+	}
+
+	connection.statements.emplace(query, statement);
+	g_metrics().addCounter("database_bytes_sent", static_cast<double>(query.size()), { { "protocol", "prepare" } });
+	return statement;
+}
+
+void Database::closeStatement(Connection &connection, std::string_view query) {
+	if (const auto it = connection.statements.find(query); it != connection.statements.end()) {
+		mysql_stmt_close(it->second);
+		connection.statements.erase(it);
+	}
+}
+
+void Database::closeStatements(Connection &connection) {
+	for (const auto &[query, statement] : connection.statements) {
+		mysql_stmt_close(statement);
+	}
+	connection.statements.clear();
+}
+
 DBResult_ptr Database::storeQuery(std::string_view query) {
-	if (!handle) {
+	auto* connection = getConnection();
+	if (!connection || !connection->handle) {
 		g_logger().error("Database not initialized!");
 		return nullptr;
 	}
 	g_logger().trace("Storing Query: {}", query);
 
+	auto* handle = connection->handle;
 	metrics::lock_latency measureLock("database");
-	std::scoped_lock lock { databaseLock };
+	std::scoped_lock lock { connection->lock };
 	measureLock.stop();
 
 	metrics::query_latency measure(query.substr(0, 50));
+	g_metrics().addCounter("database_bytes_sent", static_cast<double>(query.size()), { { "protocol", "text" } });
 retry:
 	if (mysql_query(handle, query.data()) != 0) {
 		g_logger().error("Query: {}", query);
@@ -301,7 +568,7 @@ std::string Database::escapeBlob(const char* s, uint32_t length) const {
 
 	if (length != 0) {
 		std::string output(maxLength, '\0');
-		size_t escapedLength = mysql_real_escape_string(handle, &output[0], s, length);
+		size_t escapedLength = mysql_real_escape_string(getConnection()->handle, &output[0], s, length);
 		output.resize(escapedLength);
 		escaped.append(output);
 	}
@@ -326,33 +593,31 @@ DBResult::~DBResult() {
 	mysql_free_result(handle);
 }
 
-std::string DBResult::getString(const std::string &s) const {
-	auto it = listNames.find(s);
+DBResult::Column DBResult::getColumn(std::string_view name) const {
+	const auto it = listNames.find(name);
 	if (it == listNames.end()) {
-		g_logger().error("Column '{}' does not exist in result set", s);
+		g_logger().error("[DBResult::getColumn] - Column '{}' doesn't exist in the result set", name);
 		return {};
 	}
-	if (row[it->second] == nullptr) {
-		return {};
-	}
-	return std::string(row[it->second]);
+	return Column(it->second);
 }
 
-const char* DBResult::getStream(const std::string &s, unsigned long &size) const {
-	auto it = listNames.find(s);
-	if (it == listNames.end()) {
-		g_logger().error("Column '{}' doesn't exist in the result set", s);
-		size = 0;
-		return nullptr;
-	}
+std::string DBResult::getString(std::string_view name) const {
+	return getString(getColumn(name));
+}
 
-	if (row[it->second] == nullptr) {
+const char* DBResult::getStream(Column column, unsigned long &size) const {
+	if (!column.isValid() || row[column.index] == nullptr) {
 		size = 0;
 		return nullptr;
 	}
 
-	size = mysql_fetch_lengths(handle)[it->second];
-	return row[it->second];
+	size = mysql_fetch_lengths(handle)[column.index];
+	return row[column.index];
+}
+
+const char* DBResult::getStream(std::string_view name, unsigned long &size) const {
+	return getStream(getColumn(name), size);
 }
 
 uint8_t DBResult::getU8FromString(const std::string &string, const std::string &function) {
@@ -479,3 +744,54 @@ bool DBInsert::execute() {
 
 	return true;
 }
+
+DBPreparedInsert::DBPreparedInsert(std::string insertQuery, size_t columns) :
+	query(std::move(insertQuery)), columns(columns) { }
+
+void DBPreparedInsert::upsert(const std::vector<std::string> &upsertColumns) {
+	upsertQuery = fmt::format(" ON DUPLICATE KEY UPDATE {}", fmt::join(upsertColumns | std::views::transform([](const std::string &column) { return fmt::format("`{}` = VALUES(`{}`)", column, column); }), ", "));
+}
+
+bool DBPreparedInsert::addRow(std::vector<DBParam> &&row) {
+	if (row.size() != columns) {
+		g_logger().error("[DBPreparedInsert::addRow] - Row has {} values for {} columns", row.size(), columns);
+		return false;
+	}
+
+	params.insert(params.end(), std::make_move_iterator(row.begin()), std::make_move_iterator(row.end()));
+	return true;
+}
+
+bool DBPreparedInsert::execute() {
+	auto &db = Database::getInstance();
+	const auto maxBatchSize = std::min<uint64_t>(db.getMaxPacketSize(), static_cast<uint64_t>(Database::MAX_QUERY_SIZE)) / 2;
+	const auto rowCount = getRowCount();
+
+	size_t row = 0;
+	while (row < rowCount) {
+		auto batchRows = std::bit_floor(std::min(rowCount - row, MAX_BATCH_ROWS));
+		const auto batchSize = [&](size_t rows) {
+			size_t size = 0;
+			for (size_t i = row * columns; i < (row + rows) * columns; ++i) {
+				size += params[i].size();
+			}
+			return size;
+		};
+		while (batchRows > 1 && batchSize(batchRows) > maxBatchSize) {
+			batchRows /= 2;
+		}
+
+		if (!db.executePrepared(getBatchQuery(batchRows), std::span(params).subspan(row * columns, batchRows * columns))) {
+			return false;
+		}
+		row += batchRows;
+	}
+
+	params.clear();
+	return true;
+}
+
+std::string DBPreparedInsert::getBatchQuery(size_t rows) const {
+	const auto placeholders = fmt::format("({})", fmt::join(std::vector<std::string_view>(columns, "?"), ","));
+	return fmt::format("{}{}{}", query, fmt::join(std::vector<std::string_view>(rows, placeholders), ","), upsertQuery);
+}
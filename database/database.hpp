@@ -21,6 +21,7 @@
 
 #ifndef USE_PRECOMPILED_HEADERS
 	#include <mysql/mysql.h>
+	#include <condition_variable>
 	#include <mutex>
 	#include <utility>
 #endif
@@ -28,6 +29,55 @@
 class DBResult;
 using DBResult_ptr = std::shared_ptr<DBResult>;
 
+/**
+ * Value bound to a "?" of a prepared statement, sent in binary form instead of escaped into the SQL text.
+ */
+class DBParam {
+public:
+	DBParam(std::nullptr_t) { }
+
+	template <typename T>
+		requires std::is_integral_v<T> || std::is_enum_v<T>
+	DBParam(T number) :
+		width(sizeof(T)) {
+		if constexpr (std::is_enum_v<T>) {
+			*this = DBParam(static_cast<std::underlying_type_t<T>>(number));
+		} else if constexpr (std::is_signed_v<T>) {
+			value = static_cast<int64_t>(number);
+		} else {
+			value = static_cast<uint64_t>(number);
+		}
+	}
+
+	DBParam(std::string text) :
+		value(std::move(text)) { }
+
+	static DBParam blob(std::string data) {
+		DBParam param(std::move(data));
+		param.binary = true;
+		return param;
+	}
+
+	static DBParam blob(const char* data, size_t size) {
+		return blob(std::string(data, size));
+	}
+
+	// Bytes the value takes on the wire, integers go out at the width of their C++ type
+	size_t size() const {
+		if (const auto* text = std::get_if<std::string>(&value)) {
+			return text->size();
+		}
+		return width;
+	}
+
+private:
+	std::variant<std::nullptr_t, int64_t, uint64_t, std::string> value;
+	uint8_t width = 0;
+	bool binary = false;
+
+	friend class Database;
+};
+
 class Database {
 public:
 	static const size_t MAX_QUERY_SIZE = 8 * 1024 * 1024; // 8 Mb -- half the default MySQL max_allowed_packet size
@@ -67,13 +117,23 @@ public:
 
 	DBResult_ptr storeQuery(std::string_view query);
 
+	/**
+	 * @brief Runs a statement without result set through the binary protocol, one param per "?".
+	 *
+	 * Each connection prepares a query text once and keeps the statement, later calls only send the
+	 * params, so blobs are neither escaped nor parsed again by the server.
+	 */
+	bool executePrepared(std::string_view query, std::span<const DBParam> params);
+
+	bool executePrepared(std::string_view query, std::initializer_list<DBParam> params) {
+		return executePrepared(query, std::span(params.begin(), params.size()));
+	}
+
 	std::string escapeString(const std::string &s) const;
 
 	std::string escapeBlob(const char* s, uint32_t length) const;
 
-	uint64_t getLastInsertId() const {
-		return static_cast<uint64_t>(mysql_insert_id(handle));
-	}
+	uint64_t getLastInsertId() const;
 
 	static const char* getClientVersion() {
 		return mysql_get_client_info();
@@ -83,15 +143,64 @@ public:
 		return maxPacketSize;
 	}
 
+	/**
+	 * @brief Binds a pooled connection to the calling thread, its queries stop sharing the primary one.
+	 *
+	 * Waits while every pooled connection is leased. Returns false when the thread already holds one
+	 * or when the pool has no connections besides the primary (mysqlConnectionPoolSize = 1),
+	 * only a successful lease has to be given back through releaseConnection.
+	 */
+	bool leaseConnection();
+	// Same as leaseConnection, but returns false instead of waiting when no pooled connection is idle
+	bool tryLeaseConnection();
+	void releaseConnection();
+
+	bool hasLeasedConnection() const {
+		return leasedConnection != nullptr;
+	}
+
+	size_t getConnectionCount() const {
+		return connections.size();
+	}
+
 private:
+	struct Connection {
+		MYSQL* handle = nullptr;
+		std::recursive_mutex lock;
+		// Prepared statements keyed by their query text
+		phmap::flat_hash_map<std::string, MYSQL_STMT*> statements;
+	};
+
+	static constexpr size_t MAX_PREPARED_STATEMENTS = 128;
+
+	bool openConnection(Connection &connection, const std::string* host, const std::string* user, const std::string* password, const std::string* database, uint32_t port, const std::string* sock);
+
+	// The leased connection of this thread, otherwise the primary one
+	Connection* getConnection() const;
+
+	/**
+	 * True when mysqlPinTransactions is enabled, the transaction then runs either on an idle pooled
+	 * connection (leased is set and it has to be released) or on the primary one held under its lock.
+	 */
+	bool pinTransaction(bool &leased);
 	bool beginTransaction();
 	bool rollback();
 	bool commit();
 
 	static bool isRecoverableError(unsigned int error);
 
-	MYSQL* handle = nullptr;
-	std::recursive_mutex databaseLock;
+	// Cached statement of the connection, nullptr with error set when the server refuses it
+	static MYSQL_STMT* prepareStatement(Connection &connection, std::string_view query, unsigned int &error, bool &cached);
+	static void closeStatement(Connection &connection, std::string_view query);
+	static void closeStatements(Connection &connection);
+
+	// The first connection is the shared primary one, the others are leased from idleConnections
+	std::vector<std::unique_ptr<Connection>> connections;
+	std::vector<Connection*> idleConnections;
+	std::mutex poolLock;
+	std::condition_variable poolCondition;
+	static thread_local Connection* leasedConnection;
+
 	uint64_t maxPacketSize = 1048576;
 
 	friend class DBTransaction;
@@ -108,83 +217,66 @@ public:
 	DBResult(const DBResult &) = delete;
 	DBResult &operator=(const DBResult &) = delete;
 
+	/**
+	 * Column of the result set, resolved once by name and then read on every row without a lookup.
+	 * Handles of columns the query did not select read as null.
+	 */
+	class Column {
+	public:
+		Column() = default;
+
+		[[nodiscard]] bool isValid() const {
+			return index != INVALID;
+		}
+
+	private:
+		static constexpr size_t INVALID = std::numeric_limits<size_t>::max();
+
+		explicit Column(size_t index) :
+			index(index) { }
+
+		size_t index = INVALID;
+
+		friend class DBResult;
+	};
+
+	Column getColumn(std::string_view name) const;
+
 	template <typename T>
-	T getNumber(const std::string &s) const {
-		auto it = listNames.find(s);
-		if (it == listNames.end()) {
-			g_logger().error("[DBResult::getNumber] - Column '{}' doesn't exist in the result set", s);
+	T getNumber(Column column) const {
+		const auto value = getStringView(column);
+		if (value.empty()) {
 			return T();
 		}
 
-		if (row[it->second] == nullptr) {
-			return T();
+		if constexpr (std::is_enum_v<T>) {
+			return static_cast<T>(parseNumber<std::underlying_type_t<T>>(value));
+		} else {
+			return parseNumber<T>(value);
 		}
+	}
 
-		T data {};
-		try {
-			// Check if the type T is a enum
-			if constexpr (std::is_enum_v<T>) {
-				using underlying_type = std::underlying_type_t<T>;
-				underlying_type value = 0;
-				if constexpr (std::is_signed_v<underlying_type>) {
-					value = static_cast<underlying_type>(std::stoll(row[it->second]));
-				} else {
-					value = static_cast<underlying_type>(std::stoull(row[it->second]));
-				}
-				return static_cast<T>(value);
-			}
-			// Check if the type T is signed or unsigned
-			if constexpr (std::is_signed_v<T>) {
-				// Check if the type T is int8_t or int16_t
-				if constexpr (std::is_same_v<T, int8_t> || std::is_same_v<T, int16_t>) {
-					// Use std::stoi to convert string to int8_t
-					data = static_cast<T>(std::stoi(row[it->second]));
-				}
-				// Check if the type T is int32_t
-				else if constexpr (std::is_same_v<T, int32_t>) {
-					// Use std::stol to convert string to int32_t
-					data = static_cast<T>(std::stol(row[it->second]));
-				}
-				// Check if the type T is int64_t
-				else if constexpr (std::is_same_v<T, int64_t>) {
-					// Use std::stoll to convert string to int64_t
-					data = static_cast<T>(std::stoll(row[it->second]));
-				} else {
-					// Throws exception indicating that type T is invalid
-					g_logger().error("Invalid signed type T");
-				}
-			} else if (std::is_same<T, bool>::value) {
-				data = static_cast<T>(std::stoi(row[it->second]));
-			} else {
-				// Check if the type T is uint8_t or uint16_t or uint32_t
-				if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> || std::is_same_v<T, uint32_t>) {
-					// Use std::stoul to convert string to uint8_t
-					data = static_cast<T>(std::stoul(row[it->second]));
-				}
-				// Check if the type T is uint64_t
-				else if constexpr (std::is_same_v<T, uint64_t>) {
-					// Use std::stoull to convert string to uint64_t
-					data = static_cast<T>(std::stoull(row[it->second]));
-				} else {
-					// Send log indicating that type T is invalid
-					g_logger().error("Column '{}' has an invalid unsigned T is invalid", s);
-				}
-			}
-		} catch (std::invalid_argument &e) {
-			// Value of string is invalid
-			g_logger().error("Column '{}' has an invalid value set, error code: {}", s, e.what());
-			data = T();
-		} catch (std::out_of_range &e) {
-			// Value of string is too large to fit the range allowed by type T
-			g_logger().error("Column '{}' has a value out of range, error code: {}", s, e.what());
-			data = T();
+	template <typename T>
+	T getNumber(std::string_view name) const {
+		const auto column = getColumn(name);
+		return column.isValid() ? getNumber<T>(column) : T();
+	}
+
+	// Views stay valid until the next row is fetched
+	std::string_view getStringView(Column column) const {
+		if (!column.isValid() || row[column.index] == nullptr) {
+			return {};
 		}
+		return row[column.index];
+	}
 
-		return data;
+	std::string getString(Column column) const {
+		return std::string(getStringView(column));
 	}
 
-	std::string getString(const std::string &s) const;
-	const char* getStream(const std::string &s, unsigned long &size) const;
+	std::string getString(std::string_view name) const;
+	const char* getStream(Column column, unsigned long &size) const;
+	const char* getStream(std::string_view name, unsigned long &size) const;
 	static uint8_t getU8FromString(const std::string &string, const std::string &function);
 	static int8_t getInt8FromString(const std::string &string, const std::string &function);
 
@@ -192,11 +284,59 @@ public:
 	bool hasNext() const;
 	bool next();
 
+	// Calls the function for the current row and every row after it, stops early once it returns false
+	template <typename F>
+	void forEachRow(F &&function) {
+		do {
+			if constexpr (std::is_same_v<std::invoke_result_t<F, const DBResult &>, bool>) {
+				if (!function(std::as_const(*this))) {
+					return;
+				}
+			} else {
+				function(std::as_const(*this));
+			}
+		} while (next());
+	}
+
 private:
+	// Integral columns wrap into T like the C conversions did, "1.5" reads as 1
+	template <typename T>
+	static T parseNumber(std::string_view value) {
+		const auto* begin = value.data();
+		const auto* end = begin + value.size();
+		std::from_chars_result parsed {};
+		T data {};
+		if constexpr (std::is_same_v<T, bool>) {
+			int32_t number = 0;
+			parsed = std::from_chars(begin, end, number);
+			data = number != 0;
+		} else if constexpr (std::is_floating_point_v<T>) {
+			parsed = std::from_chars(begin, end, data);
+		} else if constexpr (std::is_signed_v<T>) {
+			int64_t number = 0;
+			parsed = std::from_chars(begin, end, number);
+			data = static_cast<T>(number);
+		} else if (value.front() == '-') {
+			int64_t number = 0;
+			parsed = std::from_chars(begin, end, number);
+			data = static_cast<T>(number);
+		} else {
+			uint64_t number = 0;
+			parsed = std::from_chars(begin, end, number);
+			data = static_cast<T>(number);
+		}
+
+		if (parsed.ec != std::errc()) {
+			g_logger().error("[DBResult::getNumber] - Value '{}' is {}", value, parsed.ec == std::errc::result_out_of_range ? "out of range" : "not a number");
+			return T();
+		}
+		return data;
+	}
+
 	MYSQL_RES* handle;
 	MYSQL_ROW row;
 
-	std::map<std::string_view, size_t> listNames;
+	std::map<std::string_view, size_t, std::less<>> listNames;
 
 	friend class Database;
 };
@@ -219,11 +359,42 @@ private:
 	size_t length;
 };
 
+/**
+ * INSERT statement sent as prepared statements. Rows go out in batches of a power of two rows,
+ * which keeps the number of distinct statement texts per table (and so the cache) small.
+ */
+class DBPreparedInsert {
+public:
+	// insertQuery stops right before the values, e.g. "INSERT INTO `table` (`a`, `b`) VALUES "
+	DBPreparedInsert(std::string insertQuery, size_t columns);
+	void upsert(const std::vector<std::string> &columns);
+	bool addRow(std::vector<DBParam> &&row);
+	bool execute();
+
+	size_t getRowCount() const {
+		return params.size() / columns;
+	}
+
+private:
+	static constexpr size_t MAX_BATCH_ROWS = 64;
+
+	std::string getBatchQuery(size_t rows) const;
+
+	std::string query;
+	std::string upsertQuery;
+	std::vector<DBParam> params;
+	size_t columns;
+};
+
 class DBTransaction {
 public:
 	explicit DBTransaction() = default;
 
-	~DBTransaction() = default;
+	~DBTransaction() {
+		if (leased) {
+			Database::getInstance().releaseConnection();
+		}
+	}
 
 	// non-copyable
 	DBTransaction(const DBTransaction &) = delete;
@@ -235,9 +406,29 @@ public:
 
 	template <typename Func>
 	static bool executeWithinTransaction(const Func &toBeExecuted) {
+		DBTransaction transaction;
+		if (transaction.pin()) {
+			// No other thread can use the connection until commit, so the changes can run inside the transaction
+			if (!transaction.begin()) {
+				return false;
+			}
+
+			try {
+				if (!toBeExecuted()) {
+					transaction.rollback();
+					return false;
+				}
+			} catch (...) {
+				transaction.rollback();
+				throw;
+			}
+
+			transaction.commit();
+			return transaction.isCommitted();
+		}
+
 		bool changesExpected = toBeExecuted();
 		if (changesExpected) {
-			DBTransaction transaction;
 			try {
 				transaction.begin();
 				transaction.commit();
@@ -253,6 +444,11 @@ public:
 	}
 
 private:
+	// True when the whole transaction runs on a connection held by this thread
+	bool pin() {
+		return Database::getInstance().pinTransaction(leased);
+	}
+
 	bool begin() {
 		// Ensure that the transaction has not already been started
 		if (state != STATE_NO_START) {
@@ -262,7 +458,11 @@ private:
 		try {
 			// Start the transaction
 			state = STATE_START;
-			return Database::getInstance().beginTransaction();
+			if (!Database::getInstance().beginTransaction()) {
+				state = STATE_NO_START;
+				return false;
+			}
+			return true;
 		} catch (const std::exception &exception) {
 			// An error occurred while starting the transaction
 			state = STATE_NO_START;
@@ -297,7 +497,9 @@ private:
 		try {
 			// Commit the transaction
 			state = STATE_COMMIT;
-			Database::getInstance().commit();
+			if (!Database::getInstance().commit()) {
+				state = STATE_NO_START;
+			}
 		} catch (const std::exception &exception) {
 			// An error occurred while committing the transaction
 			state = STATE_NO_START;
@@ -316,6 +518,7 @@ private:
 	}
 
 	TransactionStates_t state = STATE_NO_START;
+	bool leased = false;
 };
 
 class DatabaseException : public std::exception {
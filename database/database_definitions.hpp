@@ -23,3 +23,11 @@ enum TransactionStates_t {
 	STATE_START,
 	STATE_COMMIT,
 };
+
+// Order in which queued database work is served, lower values first
+enum class DatabasePriority : uint8_t {
+	Login,
+	Save,
+	Default,
+	Highscores,
+};
@@ -18,31 +18,137 @@
 #include "database/databasetasks.hpp"
 
 #include "game/scheduling/dispatcher.hpp"
-#include "lib/thread/thread_pool.hpp"
 #include "lib/di/container.hpp"
+#include "lib/metrics/metrics.hpp"
 
-DatabaseTasks::DatabaseTasks(ThreadPool &threadPool, Database &db) :
-	db(db), threadPool(threadPool) {
+DatabaseTasks::DatabaseTasks(Database &db) :
+	db(db) {
+}
+
+DatabaseTasks::~DatabaseTasks() {
+	shutdown();
 }
 
 DatabaseTasks &DatabaseTasks::getInstance() {
 	return inject<DatabaseTasks>();
 }
 
-void DatabaseTasks::execute(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback /* nullptr */) {
-	threadPool.detach_task([this, query, callback]() {
-		bool success = db.executeQuery(query);
-		if (callback != nullptr) {
-			g_dispatcher().addEvent([callback, success]() { callback(nullptr, success); }, __FUNCTION__);
+void DatabaseTasks::start() {
+	std::scoped_lock lock { queueLock };
+	if (started || stopped) {
+		return;
+	}
+
+	started = true;
+	const auto connectionCount = db.getConnectionCount();
+	const auto threadCount = connectionCount > 1 ? connectionCount - 1 : 1;
+	for (size_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back([this] { work(); });
+	}
+	g_logger().debug("Started {} database threads", threadCount);
+}
+
+void DatabaseTasks::shutdown() {
+	{
+		std::scoped_lock lock { queueLock };
+		if (stopped) {
+			return;
+		}
+		stopped = true;
+	}
+	queueCondition.notify_all();
+
+	for (auto &thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+	threads.clear();
+
+	// Never started, nothing else will pick these up
+	while (!queue.empty()) {
+		std::pop_heap(queue.begin(), queue.end());
+		Job job = std::move(queue.back());
+		queue.pop_back();
+		runJob(job);
+	}
+}
+
+void DatabaseTasks::execute(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback /* nullptr */, DatabasePriority priority /* Default */) {
+	run(
+		[this, query, callback]() {
+			bool success = db.executeQuery(query);
+			if (callback != nullptr) {
+				g_dispatcher().addEvent([callback, success]() { callback(nullptr, success); }, __FUNCTION__);
+			}
+		},
+		priority
+	);
+}
+
+void DatabaseTasks::store(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback /* nullptr */, DatabasePriority priority /* Default */) {
+	run(
+		[this, query, callback]() {
+			DBResult_ptr result = db.storeQuery(query);
+			if (callback != nullptr) {
+				g_dispatcher().addEvent([callback, result]() { callback(result, true); }, __FUNCTION__);
+			}
+		},
+		priority
+	);
+}
+
+void DatabaseTasks::run(std::function<void()> function, DatabasePriority priority /* Default */) {
+	Job job { std::move(function), nullptr, 0, priority };
+	{
+		std::scoped_lock lock { queueLock };
+		if (!stopped) {
+			const auto priorityName = std::string(magic_enum::enum_name(priority));
+			job.queueLatency = std::make_shared<metrics::database_queue_latency>(priorityName);
+			job.sequence = nextSequence++;
+			queue.emplace_back(std::move(job));
+			std::push_heap(queue.begin(), queue.end());
+			g_metrics().addUpDownCounter("database_queue_depth", 1, { { "priority", priorityName } });
+			queueCondition.notify_one();
+			return;
 		}
-	});
+	}
+
+	runJob(job);
 }
 
-void DatabaseTasks::store(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback /* nullptr */) {
-	threadPool.detach_task([this, query, callback]() {
-		DBResult_ptr result = db.storeQuery(query);
-		if (callback != nullptr) {
-			g_dispatcher().addEvent([callback, result]() { callback(result, true); }, __FUNCTION__);
+void DatabaseTasks::work() {
+	std::unique_lock lock { queueLock };
+	while (true) {
+		queueCondition.wait(lock, [this] { return stopped || !queue.empty(); });
+		if (queue.empty()) {
+			return;
 		}
-	});
+
+		std::pop_heap(queue.begin(), queue.end());
+		Job job = std::move(queue.back());
+		queue.pop_back();
+		lock.unlock();
+
+		runJob(job);
+
+		lock.lock();
+	}
+}
+
+void DatabaseTasks::runJob(Job &job) {
+	if (job.queueLatency) {
+		job.queueLatency->stop();
+		g_metrics().addUpDownCounter("database_queue_depth", -1, { { "priority", std::string(magic_enum::enum_name(job.priority)) } });
+	}
+
+	const bool leased = db.leaseConnection();
+	try {
+		job.function();
+	} catch (const std::exception &exception) {
+		g_logger().error("[{}] Database job failed, error: {}", __FUNCTION__, exception.what());
+	}
+	if (leased) {
+		db.releaseConnection();
+	}
 }
@@ -18,11 +18,19 @@
 #pragma once
 
 #include "database/database.hpp"
-#include "lib/thread/thread_pool.hpp"
 
+namespace metrics {
+	class database_queue_latency;
+}
+
+/**
+ * Runs queries away from the game threads, on its own threads that each lease a pooled connection
+ * per job. Queued jobs are served by priority and then in submission order.
+ */
 class DatabaseTasks {
 public:
-	DatabaseTasks(ThreadPool &threadPool, Database &db);
+	explicit DatabaseTasks(Database &db);
+	~DatabaseTasks();
 
 	// Ensures that we don't accidentally copy it
 	DatabaseTasks(const DatabaseTasks &) = delete;
@@ -30,12 +38,43 @@ public:
 
 	static DatabaseTasks &getInstance();
 
-	void execute(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback = nullptr);
-	void store(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback = nullptr);
+	// One thread per pooled connection, jobs submitted earlier wait for it
+	void start();
+	// Runs what is still queued and joins the threads, later jobs run on the caller thread
+	void shutdown();
+
+	void execute(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback = nullptr, DatabasePriority priority = DatabasePriority::Default);
+	void store(const std::string &query, const std::function<void(DBResult_ptr, bool)> &callback = nullptr, DatabasePriority priority = DatabasePriority::Default);
+	void run(std::function<void()> function, DatabasePriority priority = DatabasePriority::Default);
 
 private:
+	struct Job {
+		std::function<void()> function;
+		std::shared_ptr<metrics::database_queue_latency> queueLatency;
+		uint64_t sequence = 0;
+		DatabasePriority priority = DatabasePriority::Default;
+
+		// Heap order, the top is the most urgent and oldest job
+		bool operator<(const Job &other) const {
+			if (priority != other.priority) {
+				return priority > other.priority;
+			}
+			return sequence > other.sequence;
+		}
+	};
+
+	void work();
+	void runJob(Job &job);
+
 	Database &db;
-	ThreadPool &threadPool;
+
+	std::mutex queueLock;
+	std::condition_variable queueCondition;
+	std::vector<Job> queue;
+	std::vector<std::thread> threads;
+	uint64_t nextSequence = 0;
+	bool started = false;
+	bool stopped = false;
 };
 
 constexpr auto g_databaseTasks = DatabaseTasks::getInstance;
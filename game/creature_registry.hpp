@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/**
+ * Slot map of the creatures of one kind, keyed by their existing creature ids.
+ *
+ * Creatures live in a dense vector (iteration is a linear sweep, removal swaps with the last one)
+ * and a paged table maps "id - firstId" straight to the slot, so a lookup is two indexed loads.
+ * Every slot keeps the id it belongs to and lookups compare it, an id whose creature is gone
+ * resolves to nothing instead of to whoever took the slot. Monster and npc ids are never reused,
+ * pages left empty by old ids are released.
+ */
+template <typename T>
+class CreatureRegistry {
+public:
+	using Entry = std::pair<uint32_t, std::shared_ptr<T>>;
+
+	explicit CreatureRegistry(uint32_t initFirstId) :
+		firstId(initFirstId) { }
+
+	void add(uint32_t id, const std::shared_ptr<T> &creature) {
+		if (id < firstId) {
+			g_logger().error("[CreatureRegistry::add] - Creature id {} is below the first id {} of its registry, it cannot be found by id", id, firstId);
+			assert(false && "Creature id below the registry range");
+			return;
+		}
+
+		const auto offset = id - firstId;
+		const auto pageId = offset >> PAGE_BITS;
+		if (pageId >= pages.size()) {
+			pages.resize(pageId + 1);
+		}
+
+		auto &page = pages[pageId];
+		if (page.slots.empty()) {
+			page.slots.resize(PAGE_SIZE, FREE_SLOT);
+		}
+
+		auto &slot = page.slots[offset & PAGE_MASK];
+		if (slot != FREE_SLOT) {
+			entries[slot].second = creature;
+			return;
+		}
+
+		slot = static_cast<uint32_t>(entries.size());
+		++page.used;
+		entries.emplace_back(id, creature);
+	}
+
+	void remove(uint32_t id) {
+		auto* slot = findSlot(id);
+		if (!slot) {
+			return;
+		}
+
+		const auto position = *slot;
+		if (position != entries.size() - 1) {
+			*findSlot(entries.back().first) = position;
+			entries[position] = std::move(entries.back());
+		}
+		entries.pop_back();
+
+		*slot = FREE_SLOT;
+		releasePage(id);
+	}
+
+	// Returns a null pointer for unknown or stale ids
+	const std::shared_ptr<T> &find(uint32_t id) const {
+		static const std::shared_ptr<T> none;
+		const auto* slot = findSlot(id);
+		return slot ? entries[*slot].second : none;
+	}
+
+	[[nodiscard]] bool contains(uint32_t id) const {
+		return find(id) != nullptr;
+	}
+
+	[[nodiscard]] size_t size() const {
+		return entries.size();
+	}
+
+	[[nodiscard]] bool empty() const {
+		return entries.empty();
+	}
+
+	auto begin() const {
+		return entries.begin();
+	}
+
+	auto end() const {
+		return entries.end();
+	}
+
+private:
+	static constexpr uint32_t PAGE_BITS = 12;
+	static constexpr uint32_t PAGE_SIZE = 1 << PAGE_BITS;
+	static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+	static constexpr uint32_t FREE_SLOT = std::numeric_limits<uint32_t>::max();
+
+	struct Page {
+		std::vector<uint32_t> slots;
+		uint32_t used = 0;
+	};
+
+	uint32_t* findSlot(uint32_t id) {
+		return const_cast<uint32_t*>(std::as_const(*this).findSlot(id));
+	}
+
+	const uint32_t* findSlot(uint32_t id) const {
+		if (id < firstId) {
+			return nullptr;
+		}
+
+		const auto offset = id - firstId;
+		const auto pageId = offset >> PAGE_BITS;
+		if (pageId >= pages.size() || pages[pageId].slots.empty()) {
+			return nullptr;
+		}
+
+		const auto &slot = pages[pageId].slots[offset & PAGE_MASK];
+		if (slot == FREE_SLOT || entries[slot].first != id) {
+			return nullptr;
+		}
+		return &slot;
+	}
+
+	void releasePage(uint32_t id) {
+		auto &page = pages[(id - firstId) >> PAGE_BITS];
+		if (--page.used == 0) {
+			page.slots = {};
+		}
+	}
+
+	uint32_t firstId;
+	std::vector<Entry> entries;
+	std::vector<Page> pages;
+};
@@ -24,6 +24,7 @@
 #include "creatures/npcs/npcs.hpp"
 #include "creatures/players/imbuements/imbuements.hpp"
 #include "game/game.hpp"
+#include "game/scheduling/dispatcher_profiler.hpp"
 #include "game/zones/zone.hpp"
 #include "lib/di/container.hpp"
 #include "lua/creature/events.hpp"
@@ -122,6 +123,9 @@ bool GameReload::reloadChat() {
 
 bool GameReload::reloadConfig() {
 	const bool result = g_configManager().reload();
+	if (result) {
+		DispatcherProfiler::configure(g_configManager().getBoolean(DISPATCHER_PROFILER), static_cast<uint32_t>(std::max(0, g_configManager().getNumber(DISPATCHER_SLOW_CYCLE_BUDGET))));
+	}
 	logReloadStatus("Config", result);
 	return result;
 }
@@ -66,6 +66,7 @@
 #include "lua/global/globalevent.hpp"
 #include "lua/scripts/lua_environment.hpp"
 #include "map/spectators.hpp"
+#include "server/network/message/broadcastmessage.hpp"
 #include "server/network/protocol/protocollogin.hpp"
 #include "server/network/protocol/protocolstatus.hpp"
 #include "server/network/protocol/protocolgame.hpp"
@@ -217,7 +218,10 @@ namespace InternalGame {
 	}
 } // Namespace InternalGame
 
-Game::Game() {
+Game::Game() :
+	players(Player::getFirstID()),
+	npcs(Npc::FIRST_ID),
+	monsters(Monster::FIRST_ID) {
 	offlineTrainingWindow.choices.emplace_back("Sword Fighting and Shielding", SKILL_SWORD);
 	offlineTrainingWindow.choices.emplace_back("Axe Fighting and Shielding", SKILL_AXE);
 	offlineTrainingWindow.choices.emplace_back("Club Fighting and Shielding", SKILL_CLUB);
@@ -568,6 +572,9 @@ void Game::start(ServiceManager* manager) {
 	g_dispatcher().cycleEvent(
 		EVENT_LUA_GARBAGE_COLLECTION, [this] { g_luaEnvironment().collectGarbage(); }, "Calling GC"
 	);
+	g_dispatcher().cycleEvent(
+		MapSector::TILE_RECLAIM_INTERVAL, [] { MapSector::reclaimRetiredTiles(); }, "MapSector::reclaimRetiredTiles"
+	);
 	auto marketItemsPriceIntervalMinutes = g_configManager().getNumber(MARKET_REFRESH_PRICES);
 	if (marketItemsPriceIntervalMinutes > 0) {
 		auto marketItemsPriceIntervalMS = marketItemsPriceIntervalMinutes * 60000;
@@ -975,33 +982,16 @@ std::shared_ptr<Creature> Game::getCreatureByID(uint32_t id) {
 }
 
 std::shared_ptr<Monster> Game::getMonsterByID(uint32_t id) {
-	if (id == 0) {
-		return nullptr;
-	}
-
-	auto it = monsters.find(id);
-	if (it == monsters.end()) {
-		return nullptr;
-	}
-	return it->second;
+	return monsters.find(id);
 }
 
 std::shared_ptr<Npc> Game::getNpcByID(uint32_t id) {
-	if (id == 0) {
-		return nullptr;
-	}
-
-	auto it = npcs.find(id);
-	if (it == npcs.end()) {
-		return nullptr;
-	}
-	return it->second;
+	return npcs.find(id);
 }
 
 std::shared_ptr<Player> Game::getPlayerByID(uint32_t id, bool allowOffline /* = false */) {
-	auto playerMap = players.find(id);
-	if (playerMap != players.end()) {
-		return playerMap->second;
+	if (const auto &player = players.find(id)) {
+		return player;
 	}
 
 	if (!allowOffline) {
@@ -4497,6 +4487,8 @@ void Game::playerSetShowOffSocket(uint32_t playerId, Outfit_t &outfit, const Pos
 	}
 
 	// Send to client
+	// The podium changed in place, without going through the tile
+	tile->invalidateItemsEncoding();
 	for (const auto &spectator : Spectators().find<Player>(pos, true)) {
 		spectator->getPlayer()->sendUpdateTileItem(tile, pos, item);
 	}
@@ -6474,7 +6466,7 @@ void Game::playerSpeakToNpc(const std::shared_ptr<Player> &player, const std::st
 	player->setNextExAction(OTSYS_TIME() + g_configManager().getNumber(UI_ACTIONS_DELAY_INTERVAL) - 10);
 }
 
-std::shared_ptr<Task> Game::createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) const {
+std::shared_ptr<Task> Game::createPlayerTask(uint32_t delay, TaskFunction &&f, std::string_view context) const {
 	return Player::createPlayerTask(delay, std::move(f), context);
 }
 
@@ -6531,11 +6523,12 @@ bool Game::internalCreatureSay(const std::shared_ptr<Creature> &creature, SpeakC
 		spectators = (*spectatorsPtr);
 	}
 
-	// Send to client
+	// Send to client, every viewer gets the same encoded message
+	BroadcastMessage broadcast;
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
 			if (!ghostMode || tmpPlayer->canSeeCreature(creature)) {
-				tmpPlayer->sendCreatureSay(creature, type, text, pos);
+				tmpPlayer->sendCreatureSay(broadcast, creature, type, text, pos);
 			}
 		}
 	}
@@ -7063,6 +7056,10 @@ void Game::handleHazardSystemAttack(CombatDamage &damage, const std::shared_ptr<
 
 void Game::notifySpectators(const CreatureVector &spectators, const Position &targetPos, const std::shared_ptr<Player> &attackerPlayer, const std::shared_ptr<Monster> &targetMonster) {
 	if (!spectators.empty()) {
+		const auto dodged = fmt::format("{} has dodged", ucfirst(targetMonster->getNameDescription()));
+		// Everyone but the attacker reads the same line, it is encoded once
+		const auto othersMessage = fmt::format("{} an attack by {}. (Hazard)", dodged, attackerPlayer->getName());
+		BroadcastMessage broadcast;
 		for (const auto &spectator : spectators) {
 			if (!spectator) {
 				continue;
@@ -7073,16 +7070,12 @@ void Game::notifySpectators(const CreatureVector &spectators, const Position &ta
 				continue;
 			}
 
-			std::stringstream ss;
-			ss << ucfirst(targetMonster->getNameDescription()) << " has dodged";
 			if (tmpPlayer == attackerPlayer) {
-				ss << " your attack.";
-				attackerPlayer->sendCancelMessage(ss.str());
-				ss << " (Hazard)";
-				attackerPlayer->sendTextMessage(MESSAGE_DAMAGE_OTHERS, ss.str());
+				const auto attackerMessage = fmt::format("{} your attack.", dodged);
+				attackerPlayer->sendCancelMessage(attackerMessage);
+				attackerPlayer->sendTextMessage(MESSAGE_DAMAGE_OTHERS, fmt::format("{} (Hazard)", attackerMessage));
 			} else {
-				ss << " an attack by " << attackerPlayer->getName() << ". (Hazard)";
-				tmpPlayer->sendTextMessage(MESSAGE_DAMAGE_OTHERS, ss.str());
+				tmpPlayer->sendTextMessage(broadcast, MESSAGE_DAMAGE_OTHERS, othersMessage);
 			}
 		}
 		addMagicEffect(targetPos, CONST_ME_DODGE);
@@ -8254,9 +8247,10 @@ void Game::addMagicEffect(const Position &pos, uint16_t effect) {
 }
 
 void Game::addMagicEffect(const CreatureVector &spectators, const Position &pos, uint16_t effect) {
+	BroadcastMessage broadcast;
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendMagicEffect(pos, effect);
+			tmpPlayer->sendMagicEffect(broadcast, pos, effect);
 		}
 	}
 }
@@ -8267,9 +8261,10 @@ void Game::removeMagicEffect(const Position &pos, uint16_t effect) {
 }
 
 void Game::removeMagicEffect(const CreatureVector &spectators, const Position &pos, uint16_t effect) {
+	BroadcastMessage broadcast;
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->removeMagicEffect(pos, effect);
+			tmpPlayer->removeMagicEffect(broadcast, pos, effect);
 		}
 	}
 }
@@ -8280,9 +8275,10 @@ void Game::addDistanceEffect(const Position &fromPos, const Position &toPos, uin
 }
 
 void Game::addDistanceEffect(const CreatureVector &spectators, const Position &fromPos, const Position &toPos, uint16_t effect) {
+	BroadcastMessage broadcast;
 	for (const auto &spectator : spectators) {
 		if (const auto &tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendDistanceShoot(fromPos, toPos, effect);
+			tmpPlayer->sendDistanceShoot(broadcast, fromPos, toPos, effect);
 		}
 	}
 }
@@ -8423,6 +8419,9 @@ void Game::shutdown() {
 
 	ConnectionManager::getInstance().closeAll();
 
+	// Writes still queued (market, bans, scripts) must reach the database before exit
+	g_databaseTasks().shutdown();
+
 	g_luaEnvironment().collectGarbage();
 
 	g_logger().info("Done!");
@@ -8961,7 +8960,7 @@ void Game::playerHighscores(const std::shared_ptr<Player> &player, HighscoreType
 		processHighscoreResults(result, playerID, category, vocation, entriesPerPage);
 	};
 
-	g_databaseTasks().store(query, callback);
+	g_databaseTasks().store(query, callback, DatabasePriority::Highscores);
 	player->addAsyncOngoingTask(PlayerAsyncTask_Highscore);
 }
 
@@ -9131,6 +9130,52 @@ void Game::playerBrowseMarketOwnHistory(uint32_t playerId) {
 }
 
 namespace {
+	// Gives back the goods of a sell offer that never made it to the market, or was cancelled
+	void returnOfferItems(const std::shared_ptr<Player> &player, const ItemType &it, uint16_t amount, uint8_t tier) {
+		if (it.id == ITEM_STORE_COIN) {
+			// Do not register a transaction for coins upon cancellation
+			player->getAccount()->addCoins(CoinType::Transferable, amount, "");
+			return;
+		}
+
+		const auto &playerInbox = player->getInbox();
+		if (it.stackable) {
+			uint16_t tmpAmount = amount;
+
+			while (tmpAmount > 0) {
+				int32_t stackCount = std::min<int32_t>(it.stackSize, tmpAmount);
+				const auto &item = Item::CreateItem(it.id, stackCount);
+				if (g_game().internalAddItem(playerInbox, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+					break;
+				}
+
+				if (tier > 0) {
+					item->setAttribute(ItemAttribute_t::TIER, tier);
+				}
+
+				tmpAmount -= stackCount;
+			}
+		} else {
+			int32_t subType;
+			if (it.charges != 0) {
+				subType = it.charges;
+			} else {
+				subType = -1;
+			}
+
+			for (uint16_t i = 0; i < amount; ++i) {
+				const auto &item = Item::CreateItem(it.id, subType);
+				if (g_game().internalAddItem(playerInbox, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
+					break;
+				}
+
+				if (tier > 0) {
+					item->setAttribute(ItemAttribute_t::TIER, tier);
+				}
+			}
+		}
+	}
+
 	bool removeOfferItems(const std::shared_ptr<Player> &player, const std::shared_ptr<DepotLocker> &depotLocker, const ItemType &itemType, uint16_t amount, uint8_t tier, std::ostringstream &offerStatus) {
 		uint16_t removeAmount = amount;
 		if (tier == 0) {
@@ -9328,7 +9373,19 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t ite
 		return;
 	}
 
-	IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t>(type), it.id, amount, price, tier, anonymous);
+	if (!IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t>(type), it.id, amount, price, tier, anonymous)) {
+		// The offer was not stored, everything it took goes back to the player
+		if (type == MARKETACTION_SELL) {
+			returnOfferItems(player, it, amount, tier);
+			player->setBankBalance(player->getBankBalance() + fee);
+		} else {
+			player->setBankBalance(player->getBankBalance() + totalPrice + fee);
+		}
+		player->sendMarketEnter(player->getLastDepotId());
+		player->sendTextMessage(MESSAGE_MARKET, "There was an error processing your offer, please try again later.");
+		g_logger().error("{} - Failed to store the market offer of player {}, item {} amount {}, its goods were returned", __FUNCTION__, player->getName(), it.id, amount);
+		return;
+	}
 
 	const MarketOfferList &buyOffers = IOMarket::getActiveOffers(MARKETACTION_BUY, it.id, tier);
 	const MarketOfferList &sellOffers = IOMarket::getActiveOffers(MARKETACTION_SELL, it.id, tier);
@@ -9359,7 +9416,6 @@ void Game::playerCancelMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 		return;
 	}
 
-	const auto &playerInbox = player->getInbox();
 	if (offer.type == MARKETACTION_BUY) {
 		player->setBankBalance(player->getBankBalance() + offer.price * offer.amount);
 		g_metrics().addCounter("balance_decrease", offer.price * offer.amount, { { "player", player->getName() }, { "context", "market_purchase" } });
@@ -9371,44 +9427,7 @@ void Game::playerCancelMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 			return;
 		}
 
-		if (it.id == ITEM_STORE_COIN) {
-			// Do not register a transaction for coins upon cancellation
-			player->getAccount()->addCoins(CoinType::Transferable, offer.amount, "");
-		} else if (it.stackable) {
-			uint16_t tmpAmount = offer.amount;
-
-			while (tmpAmount > 0) {
-				int32_t stackCount = std::min<int32_t>(it.stackSize, tmpAmount);
-				const auto &item = Item::CreateItem(it.id, stackCount);
-				if (internalAddItem(playerInbox, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-					break;
-				}
-
-				if (offer.tier > 0) {
-					item->setAttribute(ItemAttribute_t::TIER, offer.tier);
-				}
-
-				tmpAmount -= stackCount;
-			}
-		} else {
-			int32_t subType;
-			if (it.charges != 0) {
-				subType = it.charges;
-			} else {
-				subType = -1;
-			}
-
-			for (uint16_t i = 0; i < offer.amount; ++i) {
-				const auto &item = Item::CreateItem(it.id, subType);
-				if (internalAddItem(playerInbox, item, INDEX_WHEREEVER, FLAG_NOLIMIT) != RETURNVALUE_NOERROR) {
-					break;
-				}
-
-				if (offer.tier > 0) {
-					item->setAttribute(ItemAttribute_t::TIER, offer.tier);
-				}
-			}
-		}
+		returnOfferItems(player, it, offer.amount, offer.tier);
 	}
 
 	IOMarket::moveOfferToHistory(offer.id, OFFERSTATE_CANCELLED);
@@ -9687,10 +9706,10 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 
 	offer.amount -= amount;
 
-	if (offer.amount == 0) {
-		IOMarket::deleteOffer(offer.id);
-	} else {
-		IOMarket::acceptOffer(offer.id, amount);
+	const bool offerUpdated = offer.amount == 0 ? IOMarket::deleteOffer(offer.id) : IOMarket::acceptOffer(offer.id, amount);
+	if (!offerUpdated) {
+		// The goods already changed hands, the row still offers them and has to be fixed by hand
+		g_logger().error("{} - Failed to take {} from market offer {} after player {} accepted it, the offer still lists {}", __FUNCTION__, amount, offer.id, player->getName(), offer.amount + amount);
 	}
 
 	offer.timestamp += marketOfferDuration;
@@ -9965,6 +9984,8 @@ void Game::playerSetMonsterPodium(uint32_t playerId, uint32_t monsterRaceId, con
 		item->removeAttribute(ItemAttribute_t::NAME);
 	}
 
+	// The podium changed in place, without going through the tile
+	tile->invalidateItemsEncoding();
 	for (const auto &spectator : Spectators().find<Player>(pos, true)) {
 		spectator->getPlayer()->sendUpdateTileItem(tile, pos, item);
 	}
@@ -10203,30 +10224,30 @@ void Game::addPlayer(const std::shared_ptr<Player> &player) {
 	const std::string &lowercase_name = asLowerCaseString(player->getName());
 	mappedPlayerNames[lowercase_name] = player;
 	wildcardTree->insert(lowercase_name);
-	players[player->getID()] = player;
+	players.add(player->getID(), player);
 }
 
 void Game::removePlayer(const std::shared_ptr<Player> &player) {
 	const std::string &lowercase_name = asLowerCaseString(player->getName());
 	mappedPlayerNames.erase(lowercase_name);
 	wildcardTree->remove(lowercase_name);
-	players.erase(player->getID());
+	players.remove(player->getID());
 }
 
 void Game::addNpc(const std::shared_ptr<Npc> &npc) {
-	npcs[npc->getID()] = npc;
+	npcs.add(npc->getID(), npc);
 }
 
 void Game::removeNpc(const std::shared_ptr<Npc> &npc) {
-	npcs.erase(npc->getID());
+	npcs.remove(npc->getID());
 }
 
 void Game::addMonster(const std::shared_ptr<Monster> &monster) {
-	monsters[monster->getID()] = monster;
+	monsters.add(monster->getID(), monster);
 }
 
 void Game::removeMonster(const std::shared_ptr<Monster> &monster) {
-	monsters.erase(monster->getID());
+	monsters.remove(monster->getID());
 }
 
 std::shared_ptr<Guild> Game::getGuild(uint32_t id, bool allowOffline /* = flase */) const {
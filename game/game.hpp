@@ -22,6 +22,8 @@
 #include "creatures/players/cyclopedia/player_title.hpp"
 #include "creatures/players/grouping/familiars.hpp"
 #include "creatures/players/grouping/groups.hpp"
+#include "game/creature_registry.hpp"
+#include "game/scheduling/task.hpp"
 #include "lua/creature/raids.hpp"
 #include "map/map.hpp"
 #include "modal_window/modal_window.hpp"
@@ -548,13 +550,13 @@ public:
 	const phmap::parallel_flat_hash_map<uint32_t, std::shared_ptr<Guild>> &getGuilds() const {
 		return guilds;
 	}
-	const phmap::parallel_flat_hash_map<uint32_t, std::shared_ptr<Player>> &getPlayers() const {
+	const CreatureRegistry<Player> &getPlayers() const {
 		return players;
 	}
-	const std::map<uint32_t, std::shared_ptr<Monster>> &getMonsters() const {
+	const CreatureRegistry<Monster> &getMonsters() const {
 		return monsters;
 	}
-	const std::map<uint32_t, std::shared_ptr<Npc>> &getNpcs() const {
+	const CreatureRegistry<Npc> &getNpcs() const {
 		return npcs;
 	}
 
@@ -754,7 +756,7 @@ private:
 	bool playerYell(const std::shared_ptr<Player> &player, const std::string &text);
 	bool playerSpeakTo(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &receiver, const std::string &text);
 	void playerSpeakToNpc(const std::shared_ptr<Player> &player, const std::string &text);
-	std::shared_ptr<Task> createPlayerTask(uint32_t delay, std::function<void(void)> f, const std::string &context) const;
+	std::shared_ptr<Task> createPlayerTask(uint32_t delay, TaskFunction &&f, std::string_view context) const;
 
 	/**
 	 * @brief Finds the next available sub-container within a container.
@@ -822,7 +824,7 @@ private:
 	phmap::flat_hash_map<std::string, HighscoreCacheEntry> highscoreCache;
 
 	std::unordered_map<std::string, std::weak_ptr<Player>> m_deadPlayers;
-	phmap::parallel_flat_hash_map<uint32_t, std::shared_ptr<Player>> players;
+	CreatureRegistry<Player> players;
 	phmap::flat_hash_map<std::string, std::weak_ptr<Player>> mappedPlayerNames;
 	phmap::parallel_flat_hash_map<uint32_t, std::shared_ptr<Guild>> guilds;
 	phmap::flat_hash_map<uint16_t, std::shared_ptr<Item>> uniqueItems;
@@ -848,8 +850,8 @@ private:
 
 	std::shared_ptr<WildcardTreeNode> wildcardTree = nullptr;
 
-	std::map<uint32_t, std::shared_ptr<Npc>> npcs;
-	std::map<uint32_t, std::shared_ptr<Monster>> monsters;
+	CreatureRegistry<Npc> npcs;
+	CreatureRegistry<Monster> monsters;
 	std::vector<uint32_t> forgeableMonsters;
 
 	std::map<uint32_t, std::unique_ptr<TeamFinder>> teamFinderMap; // [leaderGUID] = TeamFinder*
@@ -875,7 +877,8 @@ private:
 	bool isDay = false;
 	bool browseField = false;
 
-	GameState_t gameState = GAME_STATE_NORMAL;
+	// Read by the network threads while accepting logins
+	std::atomic<GameState_t> gameState = GAME_STATE_NORMAL;
 	WorldType_t worldType = WORLDTYPE_OPEN;
 
 	LightState_t lightState = LIGHT_STATE_DAY;
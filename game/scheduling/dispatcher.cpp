@@ -19,6 +19,7 @@
 
 #include "lib/thread/thread_pool.hpp"
 #include "lib/di/container.hpp"
+#include "lib/metrics/metrics.hpp"
 #include "utils/tools.hpp"
 
 thread_local DispatcherContext Dispatcher::dispacherContext;
@@ -30,15 +31,21 @@ Dispatcher &Dispatcher::getInstance() {
 void Dispatcher::init() {
 	UPDATE_OTSYS_TIME();
 
+	scheduleEvent(
+		ALLOCATION_REPORT_INTERVAL, [this] { reportAllocations(); }, "Dispatcher::reportAllocations", true, false
+	);
+
 	threadPool.detach_task([this] {
 		std::unique_lock asyncLock(dummyMutex);
 
 		while (!threadPool.isStopped()) {
 			UPDATE_OTSYS_TIME();
 
+			profiler.beginCycle();
 			executeEvents();
 			executeScheduledEvents();
 			mergeEvents();
+			profiler.endCycle();
 
 			if (!hasPendingTasks) {
 				signalSchedule.wait_for(asyncLock, timeUntilNextScheduledTask());
@@ -73,7 +80,7 @@ void Dispatcher::executeParallelEvents(const uint8_t groupId) {
 		return;
 	}
 
-	asyncWait(tasks.size(), [groupId, &tasks](size_t i) {
+	const auto stats = WorkStealingGroup::run(threadPool, tasks.size(), [groupId, &tasks](size_t i) {
 		dispacherContext.type = DispatcherType::AsyncEvent;
 		dispacherContext.group = static_cast<TaskGroup>(groupId);
 		tasks[i].execute();
@@ -82,6 +89,8 @@ void Dispatcher::executeParallelEvents(const uint8_t groupId) {
 	});
 
 	tasks.clear();
+
+	reportParallelStats(stats, magic_enum::enum_name(static_cast<TaskGroup>(groupId)));
 }
 
 void Dispatcher::asyncWait(size_t requestSize, std::function<void(size_t i)> &&f) {
@@ -89,48 +98,43 @@ void Dispatcher::asyncWait(size_t requestSize, std::function<void(size_t i)> &&f
 		return;
 	}
 
-	// This prevents an async call from running inside another async call.
-	if (asyncWaitDisabled) {
-		for (uint_fast64_t i = 0; i < requestSize; ++i) {
-			f(i);
-		}
-		return;
-	}
-
-	const auto &partitions = generatePartition(requestSize);
-	const auto pSize = partitions.size();
-
-	BS::multi_future<void> retFuture;
-
-	if (pSize > 1) {
-		asyncWaitDisabled = true;
-		const auto min = partitions[1].first;
-		const auto max = partitions[partitions.size() - 1].second;
-		retFuture = threadPool.submit_loop(min, max, [&f](const unsigned int i) { f(i); });
-	}
+	// Nested calls are fine, the caller only waits for chunks that are already running
+	const auto stats = WorkStealingGroup::run(threadPool, requestSize, f);
+	reportParallelStats(stats, dispacherContext.getName());
+}
 
-	const auto &[min, max] = partitions[0];
-	for (uint_fast64_t i = min; i < max; ++i) {
-		f(i);
+void Dispatcher::reportParallelStats(const WorkStealingGroup::Stats &stats, std::string_view name) {
+	if (stats.workers <= 1) {
+		return;
 	}
 
-	if (pSize > 1) {
-		retFuture.wait();
-		asyncWaitDisabled = false;
-	}
+	// idle / (busy + idle) over a period is the load imbalance of the parallel groups
+	const std::map<std::string, std::string> attrs = { { "group", std::string(name) } };
+	g_metrics().addCounter("parallel_busy_us", static_cast<double>(stats.busyUs), attrs);
+	g_metrics().addCounter("parallel_idle_us", static_cast<double>(stats.idleUs), attrs);
+	g_metrics().addCounter("parallel_steals", stats.steals, attrs);
 }
 
 void Dispatcher::executeEvents(const TaskGroup startGroup) {
 	for (uint_fast8_t groupId = static_cast<uint8_t>(startGroup); groupId < static_cast<uint8_t>(TaskGroup::Last); ++groupId) {
 		const auto isWalk = groupId == static_cast<uint8_t>(TaskGroup::Walk);
+		const auto profile = DispatcherProfiler::isEnabled();
+		const auto start = profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point {};
 
+		size_t queueDepth;
 		if (groupId == static_cast<uint8_t>(TaskGroup::Serial) || isWalk) {
 			mergeEvents();
+			queueDepth = m_tasks[groupId].size();
 			executeSerialEvents(groupId);
 			mergeAsyncEvents();
 		} else {
+			queueDepth = m_tasks[groupId].size();
 			executeParallelEvents(groupId);
 		}
+
+		if (profile && queueDepth > 0) {
+			profiler.recordGroup(groupId, queueDepth, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+		}
 	}
 }
 
@@ -150,7 +154,7 @@ void Dispatcher::executeScheduledEvents() {
 
 		if (task->execute() && task->isCycle()) {
 			task->updateTime();
-			threadScheduledTasks.emplace_back(task);
+			threadScheduledTasks.push(std::shared_ptr<Task>(task));
 		} else {
 			scheduledTasksRef.erase(task->getId());
 		}
@@ -162,34 +166,46 @@ void Dispatcher::executeScheduledEvents() {
 		scheduledTasks.erase(scheduledTasks.begin(), it);
 	}
 
+	executeTimingWheelEvents();
+
 	dispacherContext.reset();
 
 	mergeAsyncEvents(); // merge async events requested by scheduled events
 	executeEvents(TaskGroup::GenericParallel); // execute async events requested by scheduled events
 }
 
+void Dispatcher::executeTimingWheelEvents() {
+	timingWheel.advance(OTSYS_TIME(), [](Task &task) {
+		dispacherContext.type = task.isCycle() ? DispatcherType::CycleEvent : DispatcherType::ScheduledEvent;
+		dispacherContext.group = TaskGroup::Serial;
+		dispacherContext.taskName = task.getContext();
+
+		if (task.execute() && task.isCycle()) {
+			task.updateTime();
+			return true;
+		}
+		return false;
+	});
+}
+
 void Dispatcher::__mergeEvents(const std::array<uint8_t, 2> &groups, const bool mergeScheduledEvents) {
 	for (const auto &thread : threads) {
-		std::scoped_lock lock(thread->mutex);
 		for (const auto group : groups) {
-			auto &threadTasks = thread->tasks[group];
-			auto &tasks = m_tasks[group];
-
-			if (threadTasks.size() > tasks.size()) {
-				tasks.swap(threadTasks);
-			}
-
-			if (!threadTasks.empty()) {
-				tasks.insert(tasks.end(), make_move_iterator(threadTasks.begin()), make_move_iterator(threadTasks.end()));
-				threadTasks.clear();
-			}
+			thread->tasks[group].drain([&tasks = m_tasks[group]](Task &&task) {
+				tasks.emplace_back(std::move(task));
+			});
 		}
 
-		if (mergeScheduledEvents && !thread->scheduledTasks.empty()) {
-			scheduledTasks.insert(make_move_iterator(thread->scheduledTasks.begin()), make_move_iterator(thread->scheduledTasks.end()));
-			thread->scheduledTasks.clear();
+		if (mergeScheduledEvents) {
+			thread->scheduledTasks.drain([this](std::shared_ptr<Task> &&task) {
+				scheduledTasks.emplace(std::move(task));
+			});
 		}
 	}
+
+	if (mergeScheduledEvents) {
+		timingWheel.merge(OTSYS_TIME());
+	}
 }
 
 // Merge only async thread events with main dispatch events
@@ -209,49 +225,69 @@ std::chrono::milliseconds Dispatcher::timeUntilNextScheduledTask() const {
 	constexpr auto CHRONO_0 = std::chrono::milliseconds(0);
 	constexpr auto CHRONO_MILI_MAX = std::chrono::milliseconds::max();
 
-	if (scheduledTasks.empty()) {
+	auto nextTime = timingWheel.nextExpiration();
+	if (!scheduledTasks.empty()) {
+		nextTime = std::min<int64_t>(nextTime, (*scheduledTasks.begin())->getTime());
+	}
+
+	if (nextTime == std::numeric_limits<int64_t>::max()) {
 		return CHRONO_MILI_MAX;
 	}
 
-	const auto &task = *scheduledTasks.begin();
-	const auto timeRemaining = std::chrono::milliseconds(task->getTime() - OTSYS_TIME());
+	const auto timeRemaining = std::chrono::milliseconds(nextTime - OTSYS_TIME());
 	return std::max<std::chrono::milliseconds>(timeRemaining, CHRONO_0);
 }
 
-void Dispatcher::addEvent(std::function<void(void)> &&f, std::string_view context, uint32_t expiresAfterMs) {
-	const auto &thread = getThreadTask();
-	std::scoped_lock lock(thread->mutex);
-	thread->tasks[static_cast<uint8_t>(TaskGroup::Serial)].emplace_back(expiresAfterMs, std::move(f), context);
+void Dispatcher::addEvent(TaskFunction &&f, std::string_view context, uint32_t expiresAfterMs) {
+	getThreadTask()->tasks[static_cast<uint8_t>(TaskGroup::Serial)].push(Task(expiresAfterMs, std::move(f), context));
 	notify();
 }
 
-void Dispatcher::addWalkEvent(std::function<void(void)> &&f, uint32_t expiresAfterMs) {
-	const auto &thread = getThreadTask();
-	std::scoped_lock lock(thread->mutex);
-	thread->tasks[static_cast<uint8_t>(TaskGroup::Walk)].emplace_back(expiresAfterMs, std::move(f), this->context().taskName);
+void Dispatcher::addWalkEvent(TaskFunction &&f, uint32_t expiresAfterMs) {
+	getThreadTask()->tasks[static_cast<uint8_t>(TaskGroup::Walk)].push(Task(expiresAfterMs, std::move(f), this->context().taskName));
 	notify();
 }
 
+uint64_t Dispatcher::scheduleEvent(uint32_t delay, TaskFunction &&f, std::string_view context, bool cycle, bool log) {
+	Task task(std::move(f), context, delay, cycle, log);
+	if (timingWheelEnabled) {
+		// The task is only consumed on success, otherwise we fall back to the btree
+		if (const auto eventId = timingWheel.schedule(std::move(task))) {
+			notify();
+			return eventId;
+		}
+	}
+
+	return scheduleEvent(std::make_shared<Task>(std::move(task)));
+}
+
 uint64_t Dispatcher::scheduleEvent(const std::shared_ptr<Task> &task) {
-	const auto &thread = getThreadTask();
-	std::scoped_lock lock(thread->mutex);
+	if (timingWheelEnabled) {
+		// Task handles are single use, so the wheel can take ownership of its content
+		if (const auto eventId = timingWheel.schedule(std::move(*task))) {
+			notify();
+			return eventId;
+		}
+	}
 
-	auto eventId = scheduledTasksRef
-					   .emplace(task->getId(), thread->scheduledTasks.emplace_back(task))
-					   .first->first;
+	const auto eventId = scheduledTasksRef.emplace(task->getId(), task).first->first;
+	getThreadTask()->scheduledTasks.push(std::shared_ptr<Task>(task));
 
 	notify();
 	return eventId;
 }
 
-void Dispatcher::asyncEvent(std::function<void(void)> &&f, TaskGroup group) {
-	const auto &thread = getThreadTask();
-	std::scoped_lock lock(thread->mutex);
-	thread->tasks[static_cast<uint8_t>(group)].emplace_back(0, std::move(f), dispacherContext.taskName);
+void Dispatcher::asyncEvent(TaskFunction &&f, TaskGroup group) {
+	getThreadTask()->tasks[static_cast<uint8_t>(group)].push(Task(0, std::move(f), dispacherContext.taskName));
 	notify();
 }
 
 void Dispatcher::stopEvent(uint64_t eventId) {
+	if (TimingWheel::isEvent(eventId)) {
+		timingWheel.cancel(eventId);
+		return;
+	}
+
 	auto it = scheduledTasksRef.find(eventId);
 	if (it != scheduledTasksRef.end()) {
 		it->second->cancel();
@@ -259,7 +295,7 @@ void Dispatcher::stopEvent(uint64_t eventId) {
 	}
 }
 
-void Dispatcher::safeCall(std::function<void(void)> &&f) {
+void Dispatcher::safeCall(TaskFunction &&f) {
 	if (dispacherContext.isAsync()) {
 		addEvent(std::move(f), dispacherContext.taskName);
 	} else {
@@ -267,6 +303,15 @@ void Dispatcher::safeCall(std::function<void(void)> &&f) {
 	}
 }
 
+void Dispatcher::reportAllocations() {
+	const auto heapAllocations = Task::getHeapAllocations();
+	g_metrics().addCounter("task_heap_allocations", static_cast<double>(heapAllocations - lastHeapAllocations));
+	lastHeapAllocations = heapAllocations;
+
+	g_metrics().addUpDownCounter("task_contexts", static_cast<int>(TaskContext::count() - lastTaskContexts));
+	lastTaskContexts = TaskContext::count();
+}
+
 bool DispatcherContext::isOn() {
 	return OTSYS_TIME() != 0;
 }
@@ -17,12 +17,19 @@
 
 #pragma once
 
+#include "dispatcher_profiler.hpp"
 #include "task.hpp"
+#include "timing_wheel.hpp"
+#include "work_stealing.hpp"
 #include "lib/thread/thread_pool.hpp"
+#include "utils/lockfree.hpp"
 
 static constexpr uint16_t DISPATCHER_TASK_EXPIRATION = 2000;
 static constexpr uint16_t SCHEDULER_MINTICKS = 50;
 static constexpr uint16_t NPC_SELL_TICKS = 150;
+static constexpr uint16_t ALLOCATION_REPORT_INTERVAL = 10000;
+// Ring slots per thread and task group, a Task is 128 bytes. Bursts past it go to the queue overflow
+static constexpr size_t THREAD_TASK_CAPACITY = 256;
 
 enum class TaskGroup : int8_t {
 	ThreadPool = -1,
@@ -101,19 +108,19 @@ public:
 
 	static Dispatcher &getInstance();
 
-	void addEvent(std::function<void(void)> &&f, std::string_view context, uint32_t expiresAfterMs = 0);
-	void addWalkEvent(std::function<void(void)> &&f, uint32_t expiresAfterMs = 0); // No need context name
+	void addEvent(TaskFunction &&f, std::string_view context, uint32_t expiresAfterMs = 0);
+	void addWalkEvent(TaskFunction &&f, uint32_t expiresAfterMs = 0); // No need context name
 
-	uint64_t cycleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context) {
+	uint64_t cycleEvent(uint32_t delay, TaskFunction &&f, std::string_view context) {
 		return scheduleEvent(delay, std::move(f), context, true);
 	}
 
 	uint64_t scheduleEvent(const std::shared_ptr<Task> &task);
-	uint64_t scheduleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context) {
+	uint64_t scheduleEvent(uint32_t delay, TaskFunction &&f, std::string_view context) {
 		return scheduleEvent(delay, std::move(f), context, false);
 	}
 
-	void asyncEvent(std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel);
+	void asyncEvent(TaskFunction &&f, TaskGroup group = TaskGroup::GenericParallel);
 	void asyncWait(size_t size, std::function<void(size_t i)> &&f);
 
 	uint64_t asyncCycleEvent(uint32_t delay, std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel) {
@@ -122,9 +129,9 @@ public:
 		);
 	}
 
-	uint64_t asyncScheduleEvent(uint32_t delay, std::function<void(void)> &&f, TaskGroup group = TaskGroup::GenericParallel) {
+	uint64_t asyncScheduleEvent(uint32_t delay, TaskFunction &&f, TaskGroup group = TaskGroup::GenericParallel) {
 		return scheduleEvent(
-			delay, [this, f = std::move(f), group] { asyncEvent([f] { f(); }, group); }, dispacherContext.taskName, false, false
+			delay, [this, f = std::move(f), group]() mutable { asyncEvent(std::move(f), group); }, dispacherContext.taskName, false, false
 		);
 	}
 
@@ -136,11 +143,11 @@ public:
 	 * using appropriate mechanisms (such as message queues or event loops).
 	 * If called directly from the dispatcher thread, it will execute the function immediately.
 	 *
-	 * @param action The function wrapped in a std::function<void(void)> that should be executed.
+	 * @param action The function wrapped in a TaskFunction that should be executed.
 	 *
 	 * @note This method is useful in multi-threaded applications to avoid race conditions or thread context violations.
 	 */
-	void safeCall(std::function<void(void)> &&f);
+	void safeCall(TaskFunction &&f);
 
 	[[nodiscard]] uint64_t getDispatcherCycle() const {
 		return dispatcherCycle;
@@ -156,29 +163,39 @@ private:
 	thread_local static DispatcherContext dispacherContext;
 
 	const auto &getThreadTask() const {
-		return threads[ThreadPool::getThreadId()];
+		// The queues are multi-producer, so threads outside the pool can safely share a slot
+		return threads[ThreadPool::getThreadId() % threads.size()];
 	}
 
-	uint64_t scheduleEvent(uint32_t delay, std::function<void(void)> &&f, std::string_view context, bool cycle, bool log = true) {
-		return scheduleEvent(std::make_shared<Task>(std::move(f), context, delay, cycle, log));
-	}
+	uint64_t scheduleEvent(uint32_t delay, TaskFunction &&f, std::string_view context, bool cycle, bool log = true);
 
 	void init();
 	void shutdown() {
 		signalSchedule.notify_all();
 	}
 
+	// Selects the backend for new scheduled/cycle events, both are always drained
+	void useTimingWheel(bool enabled) {
+		timingWheelEnabled = enabled;
+	}
+
 	inline void mergeAsyncEvents();
 	inline void mergeEvents();
 	inline void __mergeEvents(const std::array<uint8_t, 2> &groups, const bool mergeScheduledEvents);
 
 	inline void executeEvents(const TaskGroup startGroup = TaskGroup::Walk);
 	inline void executeScheduledEvents();
+	inline void executeTimingWheelEvents();
 
 	inline void executeSerialEvents(const uint8_t groupId);
 	inline void executeParallelEvents(const uint8_t groupId);
 	inline std::chrono::milliseconds timeUntilNextScheduledTask() const;
 
+	void reportParallelStats(const WorkStealingGroup::Stats &stats, std::string_view name);
+
+	// Publishes the task allocation counters to the metrics
+	void reportAllocations();
+
 	inline void checkPendingTasks() {
 		hasPendingTasks = false;
 		for (uint_fast8_t i = 0; i < static_cast<uint8_t>(TaskGroup::Last); ++i) {
@@ -196,22 +213,6 @@ private:
 		}
 	}
 
-	std::vector<std::pair<uint64_t, uint64_t>> generatePartition(size_t size) const {
-		if (size == 0) {
-			return {};
-		}
-
-		std::vector<std::pair<uint64_t, uint64_t>> list;
-		list.reserve(threadPool.get_thread_count());
-
-		const auto size_per_block = std::ceil(size / static_cast<float>(threadPool.get_thread_count()));
-		for (uint_fast64_t i = 0; i < size; i += size_per_block) {
-			list.emplace_back(i, std::min<uint64_t>(size, i + size_per_block));
-		}
-
-		return list;
-	}
-
 	uint_fast64_t dispatcherCycle = 0;
 
 	ThreadPool &threadPool;
@@ -220,17 +221,10 @@ private:
 	std::mutex dummyMutex; // This is only used for signaling the condition variable and not as an actual lock.
 
 	// Thread Events
+	// Any thread may push to any slot (MPSC), only the dispatcher drains them
 	struct ThreadTask {
-		ThreadTask() {
-			for (auto &task : tasks) {
-				task.reserve(2000);
-			}
-			scheduledTasks.reserve(2000);
-		}
-
-		std::array<std::vector<Task>, static_cast<uint8_t>(TaskGroup::Last)> tasks;
-		std::vector<std::shared_ptr<Task>> scheduledTasks;
-		std::mutex mutex;
+		std::array<LockfreeOverflowQueue<Task, THREAD_TASK_CAPACITY>, static_cast<uint8_t>(TaskGroup::Last)> tasks;
+		LockfreeOverflowQueue<std::shared_ptr<Task>, THREAD_TASK_CAPACITY> scheduledTasks;
 	};
 
 	std::vector<std::unique_ptr<ThreadTask>> threads;
@@ -239,8 +233,12 @@ private:
 	std::array<std::vector<Task>, static_cast<uint8_t>(TaskGroup::Last)> m_tasks;
 	phmap::btree_multiset<std::shared_ptr<Task>, Task::Compare> scheduledTasks {};
 	phmap::parallel_flat_hash_map_m<uint64_t, std::shared_ptr<Task>> scheduledTasksRef {};
+	TimingWheel timingWheel;
+	DispatcherProfiler profiler;
+	std::atomic_bool timingWheelEnabled = false;
 
-	bool asyncWaitDisabled = false;
+	uint64_t lastHeapAllocations = 0;
+	size_t lastTaskContexts = 0;
 
 	friend class CrystalServer;
 };
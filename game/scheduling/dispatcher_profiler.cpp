@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "game/scheduling/dispatcher_profiler.hpp"
+
+#include "game/scheduling/dispatcher.hpp"
+
+std::atomic_bool DispatcherProfiler::enabled = false;
+std::atomic_uint32_t DispatcherProfiler::slowCycleBudgetMs = 50;
+std::atomic_uint64_t DispatcherProfiler::currentCycle = 0;
+
+namespace {
+	constexpr uint16_t PAGE_SIZE = 64;
+	constexpr uint16_t MAX_PAGES = (std::numeric_limits<uint16_t>::max() + 1) / PAGE_SIZE;
+
+	// Written only by the owner thread, read by the dispatcher when dumping
+	struct ContextStats {
+		std::array<std::atomic_uint32_t, DispatcherProfiler::HISTOGRAM_BUCKETS> histogram {};
+		std::atomic_uint64_t count = 0;
+		std::atomic_uint64_t totalNs = 0;
+		std::atomic_uint64_t maxNs = 0;
+
+		// Accumulated only for the cycle in cycleId
+		std::atomic_uint64_t cycleId = 0;
+		std::atomic_uint64_t cycleCount = 0;
+		std::atomic_uint64_t cycleNs = 0;
+		std::atomic_uint64_t cycleMaxNs = 0;
+	};
+
+	using Page = std::array<ContextStats, PAGE_SIZE>;
+
+	struct ThreadStats {
+		std::array<std::atomic<Page*>, MAX_PAGES> pages {};
+	};
+
+	// Pool threads live as long as the process, so the per-thread stats are never freed
+	struct Registry {
+		std::mutex mutex;
+		std::vector<ThreadStats*> threads;
+	};
+
+	Registry &registry() {
+		static Registry instance;
+		return instance;
+	}
+
+	ThreadStats &localStats() {
+		thread_local ThreadStats* stats = [] {
+			auto* created = new ThreadStats();
+			auto &reg = registry();
+			std::scoped_lock lock(reg.mutex);
+			reg.threads.emplace_back(created);
+			return created;
+		}();
+		return *stats;
+	}
+
+	template <typename T>
+	void add(std::atomic<T> &value, T delta) {
+		value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+	}
+
+	template <typename T>
+	void max(std::atomic<T> &value, T candidate) {
+		if (candidate > value.load(std::memory_order_relaxed)) {
+			value.store(candidate, std::memory_order_relaxed);
+		}
+	}
+
+	uint8_t histogramBucket(uint64_t elapsedNs) {
+		const auto elapsedUs = elapsedNs / 1000;
+		if (elapsedUs == 0) {
+			return 0;
+		}
+		return static_cast<uint8_t>(std::min<int>(std::bit_width(elapsedUs) - 1, DispatcherProfiler::HISTOGRAM_BUCKETS - 1));
+	}
+
+	// Upper bound (in us) of the bucket where the given percentile falls
+	uint64_t percentile(const std::array<uint64_t, DispatcherProfiler::HISTOGRAM_BUCKETS> &histogram, uint64_t count, double percent) {
+		const auto target = static_cast<uint64_t>(std::ceil(static_cast<double>(count) * percent));
+		uint64_t seen = 0;
+		for (uint8_t bucket = 0; bucket < histogram.size(); ++bucket) {
+			seen += histogram[bucket];
+			if (seen >= target) {
+				return 1ULL << (bucket + 1);
+			}
+		}
+		return 1ULL << histogram.size();
+	}
+}
+
+void DispatcherProfiler::configure(bool enable, uint32_t budgetMs) {
+	enabled.store(enable, std::memory_order_relaxed);
+	slowCycleBudgetMs.store(budgetMs, std::memory_order_relaxed);
+}
+
+void DispatcherProfiler::record(uint16_t contextId, uint64_t elapsedNs) {
+	auto &pageRef = localStats().pages[contextId / PAGE_SIZE];
+	auto* page = pageRef.load(std::memory_order_relaxed);
+	if (!page) {
+		page = new Page();
+		pageRef.store(page, std::memory_order_release);
+	}
+
+	auto &stats = (*page)[contextId % PAGE_SIZE];
+	add(stats.histogram[histogramBucket(elapsedNs)], 1U);
+	add(stats.count, uint64_t { 1 });
+	add(stats.totalNs, elapsedNs);
+	max(stats.maxNs, elapsedNs);
+
+	const auto cycle = currentCycle.load(std::memory_order_relaxed);
+	if (stats.cycleId.load(std::memory_order_relaxed) != cycle) {
+		stats.cycleCount.store(1, std::memory_order_relaxed);
+		stats.cycleNs.store(elapsedNs, std::memory_order_relaxed);
+		stats.cycleMaxNs.store(elapsedNs, std::memory_order_relaxed);
+		stats.cycleId.store(cycle, std::memory_order_release);
+	} else {
+		add(stats.cycleCount, uint64_t { 1 });
+		add(stats.cycleNs, elapsedNs);
+		max(stats.cycleMaxNs, elapsedNs);
+	}
+}
+
+void DispatcherProfiler::beginCycle() {
+	inCycle = isEnabled();
+	if (!inCycle) {
+		return;
+	}
+
+	currentCycle.fetch_add(1, std::memory_order_relaxed);
+	groups.fill({});
+	cycleStart = std::chrono::steady_clock::now();
+}
+
+void DispatcherProfiler::recordGroup(uint8_t groupId, size_t queueDepth, uint64_t elapsedNs) {
+	if (!inCycle || groupId >= MAX_GROUPS) {
+		return;
+	}
+
+	auto &group = groups[groupId];
+	group.tasks += queueDepth;
+	group.elapsedNs += elapsedNs;
+	group.maxDepth = std::max(group.maxDepth, queueDepth);
+}
+
+void DispatcherProfiler::endCycle() {
+	if (!inCycle) {
+		return;
+	}
+	inCycle = false;
+
+	const auto cycleNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - cycleStart).count());
+	if (cycleNs >= static_cast<uint64_t>(slowCycleBudgetMs.load(std::memory_order_relaxed)) * 1000000) {
+		dumpSlowCycle(cycleNs);
+	}
+}
+
+void DispatcherProfiler::dumpSlowCycle(uint64_t cycleNs) const {
+	struct Offender {
+		uint16_t contextId = 0;
+		uint64_t count = 0;
+		uint64_t elapsedNs = 0;
+		uint64_t maxNs = 0;
+		uint64_t totalCount = 0;
+		std::array<uint64_t, HISTOGRAM_BUCKETS> histogram {};
+	};
+
+	const auto cycle = currentCycle.load(std::memory_order_relaxed);
+	phmap::flat_hash_map<uint16_t, Offender> offenders;
+
+	std::vector<ThreadStats*> threads;
+	{
+		auto &reg = registry();
+		std::scoped_lock lock(reg.mutex);
+		threads = reg.threads;
+	}
+
+	for (const auto* thread : threads) {
+		for (uint16_t pageId = 0; pageId < MAX_PAGES; ++pageId) {
+			const auto* page = thread->pages[pageId].load(std::memory_order_acquire);
+			if (!page) {
+				continue;
+			}
+
+			for (uint16_t i = 0; i < PAGE_SIZE; ++i) {
+				const auto &stats = (*page)[i];
+				if (stats.cycleId.load(std::memory_order_acquire) != cycle) {
+					continue;
+				}
+
+				auto &offender = offenders[static_cast<uint16_t>(pageId * PAGE_SIZE + i)];
+				offender.contextId = static_cast<uint16_t>(pageId * PAGE_SIZE + i);
+				offender.count += stats.cycleCount.load(std::memory_order_relaxed);
+				offender.elapsedNs += stats.cycleNs.load(std::memory_order_relaxed);
+				offender.maxNs = std::max(offender.maxNs, stats.cycleMaxNs.load(std::memory_order_relaxed));
+				offender.totalCount += stats.count.load(std::memory_order_relaxed);
+				for (uint8_t bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket) {
+					offender.histogram[bucket] += stats.histogram[bucket].load(std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+
+	std::vector<Offender> ranking;
+	ranking.reserve(offenders.size());
+	for (auto &[contextId, offender] : offenders) {
+		ranking.emplace_back(std::move(offender));
+	}
+
+	const auto top = std::min<size_t>(TOP_OFFENDERS, ranking.size());
+	std::partial_sort(ranking.begin(), ranking.begin() + top, ranking.end(), [](const Offender &a, const Offender &b) {
+		return a.elapsedNs > b.elapsedNs;
+	});
+
+	std::string groupsInfo;
+	for (uint8_t groupId = 0; groupId < static_cast<uint8_t>(TaskGroup::Last); ++groupId) {
+		const auto &group = groups[groupId];
+		groupsInfo += fmt::format(" | {}: {} tasks (max queue {}) {:.2f} ms", magic_enum::enum_name(static_cast<TaskGroup>(groupId)), group.tasks, group.maxDepth, group.elapsedNs / 1e6);
+	}
+
+	g_logger().warn("[DispatcherProfiler] Slow dispatcher cycle: {:.2f} ms (budget {} ms){}", cycleNs / 1e6, slowCycleBudgetMs.load(std::memory_order_relaxed), groupsInfo);
+	for (size_t rank = 0; rank < top; ++rank) {
+		const auto &offender = ranking[rank];
+		g_logger().warn(
+			"[DispatcherProfiler] #{} {}: {:.2f} ms in {} calls (max {:.2f} ms) | all time p50 <= {} us, p99 <= {} us",
+			rank + 1, TaskContext::getName(offender.contextId), offender.elapsedNs / 1e6, offender.count, offender.maxNs / 1e6,
+			percentile(offender.histogram, offender.totalCount, 0.5), percentile(offender.histogram, offender.totalCount, 0.99)
+		);
+	}
+}
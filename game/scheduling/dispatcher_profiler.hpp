@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/**
+ * Built-in dispatcher profiler.
+ *
+ * Every thread that executes tasks records their duration into its own per-context
+ * histograms (single writer, relaxed atomics, no locks). The dispatcher thread tracks
+ * the total cycle time plus the queue depth and time of each task group, and when a
+ * cycle exceeds the configured budget it logs the contexts that consumed the most time.
+ */
+class DispatcherProfiler {
+public:
+	static constexpr uint8_t HISTOGRAM_BUCKETS = 24; // log2(us), last bucket is >= ~8 s
+	static constexpr uint8_t MAX_GROUPS = 8;
+	static constexpr uint8_t TOP_OFFENDERS = 10;
+
+	static void configure(bool enabled, uint32_t slowCycleBudgetMs);
+
+	static bool isEnabled() {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	// Any thread
+	static void record(uint16_t contextId, uint64_t elapsedNs);
+
+	// Dispatcher thread only
+	void beginCycle();
+	void recordGroup(uint8_t groupId, size_t queueDepth, uint64_t elapsedNs);
+	void endCycle();
+
+private:
+	struct GroupStats {
+		uint64_t tasks = 0;
+		uint64_t elapsedNs = 0;
+		size_t maxDepth = 0;
+	};
+
+	void dumpSlowCycle(uint64_t cycleNs) const;
+
+	static std::atomic_bool enabled;
+	static std::atomic_uint32_t slowCycleBudgetMs;
+	static std::atomic_uint64_t currentCycle;
+
+	std::array<GroupStats, MAX_GROUPS> groups {};
+	std::chrono::steady_clock::time_point cycleStart;
+	bool inCycle = false;
+};
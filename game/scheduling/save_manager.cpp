@@ -19,6 +19,7 @@
 
 #include "config/configmanager.hpp"
 #include "creatures/players/grouping/guild.hpp"
+#include "database/databasetasks.hpp"
 #include "game/game.hpp"
 #include "io/ioguild.hpp"
 #include "io/iologindata.hpp"
@@ -26,8 +27,8 @@
 #include "lib/di/container.hpp"
 #include "creatures/players/player.hpp"
 
-SaveManager::SaveManager(ThreadPool &threadPool, KVStore &kvStore, Logger &logger, Game &game) :
-	threadPool(threadPool), kv(kvStore), logger(logger), game(game) { }
+SaveManager::SaveManager(DatabaseTasks &databaseTasks, KVStore &kvStore, Logger &logger, Game &game) :
+	databaseTasks(databaseTasks), kv(kvStore), logger(logger), game(game) { }
 
 SaveManager &SaveManager::getInstance() {
 	return inject<SaveManager>();
@@ -63,13 +64,16 @@ void SaveManager::scheduleAll() {
 		return;
 	}
 
-	threadPool.detach_task([this, scheduledAt]() {
-		if (m_scheduledAt.load() != scheduledAt) {
-			logger.warn("Skipping save for server because another save has been scheduled.");
-			return;
-		}
-		saveAll();
-	});
+	databaseTasks.run(
+		[this, scheduledAt]() {
+			if (m_scheduledAt.load() != scheduledAt) {
+				logger.warn("Skipping save for server because another save has been scheduled.");
+				return;
+			}
+			saveAll();
+		},
+		DatabasePriority::Save
+	);
 }
 
 void SaveManager::schedulePlayer(std::weak_ptr<Player> playerPtr) {
@@ -90,19 +94,93 @@ void SaveManager::schedulePlayer(std::weak_ptr<Player> playerPtr) {
 
 	logger.debug("Scheduling player {} for saving.", playerToSave->getName());
 	auto scheduledAt = std::chrono::steady_clock::now();
-	m_playerMap[playerToSave->getGUID()] = scheduledAt;
-	threadPool.detach_task([this, playerPtr, scheduledAt]() {
-		auto player = playerPtr.lock();
-		if (!player) {
-			logger.debug("Skipping save for player because player is no longer online.");
+	const auto guid = playerToSave->getGUID();
+	m_playerMap[guid] = scheduledAt;
+	// A relog waits for this save from the moment it is queued, Login jobs would otherwise overtake it
+	beginSave(guid);
+	databaseTasks.run(
+		[this, playerPtr, scheduledAt, guid]() {
+			auto player = playerPtr.lock();
+			if (!player) {
+				logger.debug("Skipping save for player because player is no longer online.");
+			} else if (m_playerMap[guid] != scheduledAt) {
+				logger.warn("Skipping save for player because another save has been scheduled.");
+			} else {
+				doSavePlayer(player);
+			}
+			endSave(guid);
+		},
+		DatabasePriority::Save
+	);
+}
+
+void SaveManager::beginSave(uint32_t guid) {
+	std::scoped_lock lock { saveBarriersLock };
+	auto &barrier = saveBarriers[guid];
+	++barrier.saves;
+	++barrier.saveStarts;
+}
+
+void SaveManager::endSave(uint32_t guid) {
+	std::vector<std::function<void(uint64_t)>> waiters;
+	uint64_t saveStarts = 0;
+	{
+		std::scoped_lock lock { saveBarriersLock };
+		auto it = saveBarriers.find(guid);
+		if (it == saveBarriers.end()) {
 			return;
 		}
-		if (m_playerMap[player->getGUID()] != scheduledAt) {
-			logger.warn("Skipping save for player because another save has been scheduled.");
+
+		auto &barrier = it->second;
+		if (--barrier.saves > 0) {
 			return;
 		}
-		doSavePlayer(player);
-	});
+
+		waiters.swap(barrier.waiters);
+		barrier.loads += static_cast<uint32_t>(waiters.size());
+		saveStarts = barrier.saveStarts;
+		if (barrier.loads == 0) {
+			saveBarriers.erase(it);
+		}
+	}
+
+	for (auto &waiter : waiters) {
+		waiter(saveStarts);
+	}
+}
+
+void SaveManager::afterPendingSaves(uint32_t guid, std::function<void(uint64_t)> &&callback) {
+	uint64_t saveStarts = 0;
+	{
+		std::scoped_lock lock { saveBarriersLock };
+		auto &barrier = saveBarriers[guid];
+		if (barrier.saves > 0) {
+			barrier.waiters.emplace_back(std::move(callback));
+			return;
+		}
+
+		++barrier.loads;
+		saveStarts = barrier.saveStarts;
+	}
+	callback(saveStarts);
+}
+
+bool SaveManager::finishLoad(uint32_t guid, uint64_t saveStarts) {
+	std::scoped_lock lock { saveBarriersLock };
+	auto it = saveBarriers.find(guid);
+	if (it == saveBarriers.end()) {
+		return true;
+	}
+
+	auto &barrier = it->second;
+	const bool consistent = barrier.saveStarts == saveStarts;
+	if (barrier.loads > 0) {
+		--barrier.loads;
+	}
+	if (barrier.saves == 0 && barrier.loads == 0 && barrier.waiters.empty()) {
+		saveBarriers.erase(it);
+	}
+	return consistent;
 }
 
 bool SaveManager::doSavePlayer(std::shared_ptr<Player> player) {
@@ -118,13 +196,16 @@ bool SaveManager::doSavePlayer(std::shared_ptr<Player> player) {
 		logger.debug("Saving player {}.", player->getName());
 	}
 
+	// Loads of this player running meanwhile see the change and read again
+	beginSave(player->getGUID());
 	bool saveSuccess = IOLoginData::savePlayer(player);
+	endSave(player->getGUID());
 	if (!saveSuccess) {
 		logger.error("Failed to save player {}.", player->getName());
 	}
 
 	auto duration = bm_savePlayer.duration();
-	logger.debug("Saving player {} took {} milliseconds.", player->getName(), duration);
+	logger.debug("Saving player {} took {} milliseconds, {} rows written, {} unchanged sections skipped.", player->getName(), duration, player->saveState.getRowsWritten(), player->saveState.getSectionsSkipped());
 	return saveSuccess;
 }
 
@@ -17,8 +17,7 @@
 
 #pragma once
 
-#include "lib/thread/thread_pool.hpp"
-
+class DatabaseTasks;
 class KVStore;
 class Logger;
 class Game;
@@ -27,7 +26,7 @@ class Guild;
 
 class SaveManager {
 public:
-	explicit SaveManager(ThreadPool &threadPool, KVStore &kvStore, Logger &logger, Game &game);
+	explicit SaveManager(DatabaseTasks &databaseTasks, KVStore &kvStore, Logger &logger, Game &game);
 
 	SaveManager(const SaveManager &) = delete;
 	void operator=(const SaveManager &) = delete;
@@ -40,7 +39,26 @@ public:
 	bool savePlayer(std::shared_ptr<Player> player);
 	void saveGuild(std::shared_ptr<Guild> guild);
 
+	/**
+	 * Runs the callback once no save of the player is queued or running, right away when there is none,
+	 * otherwise on the database thread that finishes the last one. It gets the count of saves started so far,
+	 * finishLoad compares against it.
+	 */
+	void afterPendingSaves(uint32_t guid, std::function<void(uint64_t)> &&callback);
+	// False when a save of the player started while it was being loaded, the rows read may mix both states
+	bool finishLoad(uint32_t guid, uint64_t saveStarts);
+
 private:
+	struct SaveBarrier {
+		uint32_t saves = 0;
+		uint32_t loads = 0;
+		uint64_t saveStarts = 0;
+		std::vector<std::function<void(uint64_t)>> waiters;
+	};
+
+	void beginSave(uint32_t guid);
+	void endSave(uint32_t guid);
+
 	void saveMap();
 	void saveKV();
 
@@ -50,7 +68,11 @@ private:
 	std::atomic<std::chrono::steady_clock::time_point> m_scheduledAt;
 	phmap::parallel_flat_hash_map<uint32_t, std::chrono::steady_clock::time_point> m_playerMap;
 
-	ThreadPool &threadPool;
+	std::mutex saveBarriersLock;
+	// Players with saves in flight or loads watching for them
+	phmap::flat_hash_map<uint32_t, SaveBarrier> saveBarriers;
+
+	DatabaseTasks &databaseTasks;
 	KVStore &kv;
 	Logger &logger;
 	Game &game;
@@ -17,32 +17,136 @@
 
 #include "game/scheduling/task.hpp"
 
+#include "game/scheduling/dispatcher_profiler.hpp"
 #include "lib/metrics/metrics.hpp"
 
 #include "utils/tools.hpp"
 
 std::atomic_uint_fast64_t Task::LAST_EVENT_ID = 0;
 
-Task::Task(uint32_t expiresAfterMs, std::function<void(void)> &&f, std::string_view context) :
-	func(std::move(f)), context(context), utime(OTSYS_TIME()),
+namespace {
+	const std::unordered_set<std::string_view> traceableContexts = {
+		"Decay::checkDecay",
+		"Dispatcher::asyncEvent",
+		"Game::checkCreatureAttack",
+		"Game::checkCreatureWalk",
+		"Game::checkCreatures",
+		"Game::checkImbuementsAndSereneStatus",
+		"Game::checkLight",
+		"Game::createFiendishMonsters",
+		"Game::createInfluencedMonsters",
+		"Game::updateCreatureWalk",
+		"Game::updateForgeableMonsters",
+		"Game::addCreatureCheck",
+		"GlobalEvents::think",
+		"LuaEnvironment::executeTimerEvent",
+		"Modules::executeOnRecvbyte",
+		"OutputMessagePool::sendAll",
+		"ProtocolGame::addGameTask",
+		"ProtocolGame::parsePacketFromDispatcher",
+		"Raids::checkRaids",
+		"SpawnMonster::checkSpawnMonster",
+		"SpawnMonster::scheduleSpawn",
+		"SpawnMonster::startup",
+		"SpawnNpc::checkSpawnNpc",
+		"Webhook::run",
+		"Protocol::sendRecvMessageCallback",
+		"Player::addInFightTicks"
+	};
+
+	struct TaskContextTable {
+		// std::deque never moves its elements, entries can be referenced for the whole process
+		std::deque<TaskContext> entries;
+		phmap::flat_hash_map<std::string_view, const TaskContext*> index;
+		std::shared_mutex mutex;
+	};
+
+	TaskContextTable &contextTable() {
+		static TaskContextTable table;
+		return table;
+	}
+}
+
+const TaskContext &TaskContext::get(std::string_view name) {
+	// Each thread keeps its own view of the table, so the shared lock is only taken once per name
+	thread_local phmap::flat_hash_map<std::string_view, const TaskContext*> cache;
+	if (const auto it = cache.find(name); it != cache.end()) {
+		return *it->second;
+	}
+
+	auto &table = contextTable();
+	const TaskContext* context = nullptr;
+	{
+		std::shared_lock lock(table.mutex);
+		if (const auto it = table.index.find(name); it != table.index.end()) {
+			context = it->second;
+		}
+	}
+
+	if (!context) {
+		std::unique_lock lock(table.mutex);
+		if (const auto it = table.index.find(name); it != table.index.end()) {
+			context = it->second;
+		} else {
+			auto &entry = table.entries.emplace_back();
+			entry.name = name;
+			if (table.entries.size() - 1 <= TaskContext::MAX_ID) {
+				entry.id = static_cast<uint16_t>(table.entries.size() - 1);
+			} else {
+				// Still interned for the name, only the profiler loses track of it
+				entry.id = TaskContext::OVERFLOW_ID;
+				if (table.entries.size() - 1 == TaskContext::OVERFLOW_ID) {
+					g_logger().error("[TaskContext::get] - More than {} task contexts, further ones are profiled together. Last: {}", TaskContext::MAX_ID + 1, name);
+				}
+			}
+			entry.traceable = traceableContexts.contains(name);
+			table.index.emplace(entry.name, &entry);
+			context = &entry;
+		}
+	}
+
+	cache.emplace(context->name, context);
+	return *context;
+}
+
+std::string_view TaskContext::getName(uint16_t id) {
+	auto &table = contextTable();
+	std::shared_lock lock(table.mutex);
+	if (id == OVERFLOW_ID) {
+		return "(overflow)";
+	}
+	if (id >= table.entries.size()) {
+		return "unknown";
+	}
+	return table.entries[id].name;
+}
+
+size_t TaskContext::count() {
+	auto &table = contextTable();
+	std::shared_lock lock(table.mutex);
+	return table.entries.size();
+}
+
+Task::Task(uint32_t expiresAfterMs, TaskFunction &&f, std::string_view context) :
+	func(std::move(f)), context(&TaskContext::get(context)), utime(OTSYS_TIME()),
 	expiration(expiresAfterMs > 0 ? OTSYS_TIME() + expiresAfterMs : 0) {
-	if (this->context.empty()) {
+	if (context.empty()) {
 		g_logger().error("[{}]: task context cannot be empty!", __FUNCTION__);
 		return;
 	}
 
-	assert(!this->context.empty() && "Context cannot be empty!");
+	assert(!context.empty() && "Context cannot be empty!");
 }
 
-Task::Task(std::function<void(void)> &&f, std::string_view context, uint32_t delay, bool cycle /* = false*/, bool log /*= true*/) :
-	func(std::move(f)), context(context), utime(OTSYS_TIME() + delay), delay(delay),
+Task::Task(TaskFunction &&f, std::string_view context, uint32_t delay, bool cycle /* = false*/, bool log /*= true*/) :
+	func(std::move(f)), context(&TaskContext::get(context)), utime(OTSYS_TIME() + delay), delay(delay),
 	cycle(cycle), log(log) {
-	if (this->context.empty()) {
+	if (context.empty()) {
 		g_logger().error("[{}]: task context cannot be empty!", __FUNCTION__);
 		return;
 	}
 
-	assert(!this->context.empty() && "Context cannot be empty!");
+	assert(!context.empty() && "Context cannot be empty!");
 }
 
 [[nodiscard]] bool Task::hasExpired() const {
@@ -50,7 +154,7 @@ Task::Task(std::function<void(void)> &&f, std::string_view context, uint32_t del
 }
 
 bool Task::execute() const {
-	metrics::task_latency measure(context);
+	metrics::task_latency measure(getContext());
 	if (isCanceled()) {
 		return false;
 	}
@@ -61,14 +165,21 @@ bool Task::execute() const {
 	}
 
 	if (log) {
-		if (hasTraceableContext()) {
+		if (context->traceable) {
 			g_logger().trace("Executing task {}.", getContext());
 		} else {
 			g_logger().debug("Executing task {}.", getContext());
 		}
 	}
 
+	if (!DispatcherProfiler::isEnabled()) {
+		func();
+		return true;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
 	func();
+	DispatcherProfiler::record(context->id, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
 	return true;
 }
 
@@ -17,16 +17,44 @@
 
 #pragma once
 
+#include "utils/inplace_function.hpp"
+
 class Dispatcher;
 
+// Typical task lambdas (ids, a couple of shared_ptrs or a std::function) fit inline
+using TaskFunction = stdext::inplace_function<void(void), 64>;
+
+/**
+ * Task context names are interned once, tasks only keep a pointer to the entry.
+ * Ids index the profiler pages, names past MAX_ID all share OVERFLOW_ID.
+ */
+struct TaskContext {
+	static constexpr uint16_t OVERFLOW_ID = std::numeric_limits<uint16_t>::max();
+	static constexpr uint16_t MAX_ID = OVERFLOW_ID - 1;
+
+	std::string name;
+	uint16_t id = 0;
+	bool traceable = false;
+
+	static const TaskContext &get(std::string_view name);
+	static std::string_view getName(uint16_t id);
+	static size_t count();
+};
+
 class Task {
 public:
-	Task(uint32_t expiresAfterMs, std::function<void(void)> &&f, std::string_view context);
+	// Empty (canceled) task, only used as a placeholder slot by the dispatcher queues
+	Task() = default;
+
+	Task(uint32_t expiresAfterMs, TaskFunction &&f, std::string_view context);
 
-	Task(std::function<void(void)> &&f, std::string_view context, uint32_t delay, bool cycle = false, bool log = true);
+	Task(TaskFunction &&f, std::string_view context, uint32_t delay, bool cycle = false, bool log = true);
 
 	~Task() = default;
 
+	Task(Task &&) = default;
+	Task &operator=(Task &&) = default;
+
 	uint64_t getId() {
 		if (id == 0) {
 			if (++LAST_EVENT_ID == 0) {
@@ -41,8 +69,20 @@ public:
 		return delay;
 	}
 
+	// Default constructed placeholders have no context
 	[[nodiscard]] std::string_view getContext() const {
-		return context;
+		return context ? std::string_view(context->name) : std::string_view {};
+	}
+
+	[[nodiscard]] uint16_t getContextId() const {
+		return context ? context->id : TaskContext::OVERFLOW_ID;
+	}
+
+	/**
+	 * @brief Number of task callables that did not fit the inline buffer and were boxed on the heap.
+	 */
+	static uint64_t getHeapAllocations() {
+		return stdext::inplace_function_stats::heapAllocations().load(std::memory_order_relaxed);
 	}
 
 	[[nodiscard]] auto getTime() const {
@@ -70,47 +110,14 @@ private:
 
 	void updateTime();
 
-	bool hasTraceableContext() const {
-		const static std::unordered_set<std::string_view> tasksContext = {
-			"Decay::checkDecay",
-			"Dispatcher::asyncEvent",
-			"Game::checkCreatureAttack",
-			"Game::checkCreatureWalk",
-			"Game::checkCreatures",
-			"Game::checkImbuementsAndSereneStatus",
-			"Game::checkLight",
-			"Game::createFiendishMonsters",
-			"Game::createInfluencedMonsters",
-			"Game::updateCreatureWalk",
-			"Game::updateForgeableMonsters",
-			"Game::addCreatureCheck",
-			"GlobalEvents::think",
-			"LuaEnvironment::executeTimerEvent",
-			"Modules::executeOnRecvbyte",
-			"OutputMessagePool::sendAll",
-			"ProtocolGame::addGameTask",
-			"ProtocolGame::parsePacketFromDispatcher",
-			"Raids::checkRaids",
-			"SpawnMonster::checkSpawnMonster",
-			"SpawnMonster::scheduleSpawn",
-			"SpawnMonster::startup",
-			"SpawnNpc::checkSpawnNpc",
-			"Webhook::run",
-			"Protocol::sendRecvMessageCallback",
-			"Player::addInFightTicks"
-		};
-
-		return tasksContext.contains(context);
-	}
-
 	struct Compare {
 		bool operator()(const std::shared_ptr<Task> &a, const std::shared_ptr<Task> &b) const {
 			return a->getTime() < b->getTime();
 		}
 	};
 
-	std::function<void(void)> func;
-	std::string context;
+	TaskFunction func;
+	const TaskContext* context = nullptr;
 
 	int64_t utime = 0;
 	int64_t expiration = 0;
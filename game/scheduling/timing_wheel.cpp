@@ -0,0 +1,222 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "game/scheduling/timing_wheel.hpp"
+
+uint64_t TimingWheel::schedule(Task &&task) {
+	std::scoped_lock lock(mutex);
+
+	uint32_t index;
+	if (!freeSlots.empty()) {
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	} else {
+		if (allocatedSlots == PAGE_SIZE * MAX_PAGES) {
+			return 0;
+		}
+
+		index = allocatedSlots++;
+		if (index % PAGE_SIZE == 0) {
+			pages[index / PAGE_SIZE] = std::make_unique<Page>();
+		}
+	}
+
+	auto &entry = slot(index);
+	entry.expiration = task.getTime();
+	entry.task.emplace(std::move(task));
+	pending.emplace_back(index);
+
+	return makeId(index, entry.generation);
+}
+
+bool TimingWheel::cancel(uint64_t eventId) {
+	if (!isEvent(eventId)) {
+		return false;
+	}
+
+	const auto index = static_cast<uint32_t>(eventId);
+	const auto generation = static_cast<uint32_t>(eventId >> 32) & GENERATION_MASK;
+
+	std::scoped_lock lock(mutex);
+	if (index >= allocatedSlots) {
+		return false;
+	}
+
+	auto &entry = slot(index);
+	if ((entry.generation & GENERATION_MASK) != generation) {
+		return false;
+	}
+
+	if (!entry.canceled.exchange(true, std::memory_order_relaxed)) {
+		canceled.emplace_back(eventId);
+	}
+	return true;
+}
+
+void TimingWheel::merge(int64_t now) {
+	{
+		std::scoped_lock lock(mutex);
+		if (pending.empty() && canceled.empty()) {
+			return;
+		}
+
+		pendingBuffer.swap(pending);
+		canceledBuffer.swap(canceled);
+	}
+
+	if (count == 0) {
+		currentTick = std::max<int64_t>(currentTick, now);
+	}
+
+	for (const auto index : pendingBuffer) {
+		insert(index);
+		++count;
+	}
+	pendingBuffer.clear();
+
+	// Only this thread bumps the generation, so a mismatch means it has already been released
+	for (const auto eventId : canceledBuffer) {
+		const auto index = static_cast<uint32_t>(eventId);
+		const auto &entry = slot(index);
+		if ((entry.generation & GENERATION_MASK) != ((eventId >> 32) & GENERATION_MASK) || entry.level == NONE_LEVEL) {
+			continue;
+		}
+
+		unlink(index);
+		release(index);
+	}
+	canceledBuffer.clear();
+}
+
+int64_t TimingWheel::nextExpiration() const {
+	if (count == 0) {
+		return std::numeric_limits<int64_t>::max();
+	}
+
+	const auto bucket = static_cast<uint32_t>(currentTick & FIRST_LEVEL_MASK);
+	const auto next = nextFirstLevelBucket(bucket);
+
+	// Nothing left on this rotation, wake up for the next cascade
+	return (currentTick & ~FIRST_LEVEL_MASK) + next;
+}
+
+void TimingWheel::insert(uint32_t index) {
+	auto &entry = slot(index);
+	const auto expiration = std::max<int64_t>(entry.expiration, currentTick);
+	const auto delta = std::min<int64_t>(expiration - currentTick, MAX_RANGE - 1);
+	const auto when = currentTick + delta;
+
+	if (delta < FIRST_LEVEL_SIZE) {
+		link(index, 0, static_cast<uint16_t>(when & FIRST_LEVEL_MASK));
+		return;
+	}
+
+	for (uint8_t level = 1; level < LEVELS; ++level) {
+		if (delta < (1LL << (levelShift(level) + LEVEL_BITS)) || level == LEVELS - 1) {
+			link(index, level, static_cast<uint16_t>((when >> levelShift(level)) & LEVEL_MASK));
+			return;
+		}
+	}
+}
+
+void TimingWheel::link(uint32_t index, uint8_t level, uint16_t bucket) {
+	auto &entry = slot(index);
+	auto &head = heads[level][bucket];
+
+	entry.level = level;
+	entry.bucket = bucket;
+	entry.prev = NONE;
+	entry.next = head;
+	if (head != NONE) {
+		slot(head).prev = index;
+	}
+	head = index;
+
+	if (level == 0) {
+		firstLevelBits[bucket / 64] |= 1ULL << (bucket % 64);
+	}
+}
+
+void TimingWheel::unlink(uint32_t index) {
+	auto &entry = slot(index);
+	auto &head = heads[entry.level][entry.bucket];
+
+	if (entry.prev != NONE) {
+		slot(entry.prev).next = entry.next;
+	} else {
+		head = entry.next;
+	}
+
+	if (entry.next != NONE) {
+		slot(entry.next).prev = entry.prev;
+	}
+
+	if (entry.level == 0 && head == NONE) {
+		firstLevelBits[entry.bucket / 64] &= ~(1ULL << (entry.bucket % 64));
+	}
+
+	entry.level = NONE_LEVEL;
+	entry.prev = entry.next = NONE;
+}
+
+uint32_t TimingWheel::detach(uint8_t level, uint16_t bucket) {
+	const auto head = std::exchange(heads[level][bucket], NONE);
+	if (level == 0) {
+		firstLevelBits[bucket / 64] &= ~(1ULL << (bucket % 64));
+	}
+	return head;
+}
+
+void TimingWheel::cascade() {
+	for (uint8_t level = 1; level < LEVELS; ++level) {
+		const auto bucket = static_cast<uint16_t>((currentTick >> levelShift(level)) & LEVEL_MASK);
+		for (uint32_t index = detach(level, bucket); index != NONE;) {
+			const auto next = slot(index).next;
+			insert(index);
+			index = next;
+		}
+
+		if (bucket != 0) {
+			break;
+		}
+	}
+}
+
+void TimingWheel::release(uint32_t index) {
+	auto &entry = slot(index);
+	entry.task.reset();
+
+	std::scoped_lock lock(mutex);
+	entry.canceled.store(false, std::memory_order_relaxed);
+	++entry.generation;
+	freeSlots.emplace_back(index);
+	--count;
+}
+
+uint32_t TimingWheel::nextFirstLevelBucket(uint32_t from) const {
+	for (uint32_t word = from / 64; word < firstLevelBits.size(); ++word) {
+		auto bits = firstLevelBits[word];
+		if (word == from / 64) {
+			bits &= ~0ULL << (from % 64);
+		}
+
+		if (bits != 0) {
+			return word * 64 + static_cast<uint32_t>(std::countr_zero(bits));
+		}
+	}
+	return FIRST_LEVEL_SIZE;
+}
@@ -0,0 +1,218 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "task.hpp"
+
+/**
+ * Hierarchical timing wheel used by the Dispatcher for scheduled and cycle events.
+ *
+ * Tasks are stored by value in a paged slab (addresses never move), buckets are
+ * intrusive doubly linked lists of slot indexes, so insertion and cancellation are O(1).
+ * The first level has one bucket per millisecond (256 ms), every next level covers
+ * 64 buckets of the previous one, which gives ~49 days of range before clamping.
+ *
+ * schedule() and cancel() may be called from any thread, they only touch the slab
+ * under a mutex and leave the wheel itself to the dispatcher thread, which applies
+ * them in merge() and fires due tasks in advance().
+ */
+class TimingWheel {
+public:
+	TimingWheel() {
+		pending.reserve(2000);
+		pendingBuffer.reserve(2000);
+		canceled.reserve(256);
+		canceledBuffer.reserve(256);
+		ready.reserve(256);
+	}
+
+	// Ensures that we don't accidentally copy it
+	TimingWheel(const TimingWheel &) = delete;
+	TimingWheel &operator=(const TimingWheel &) = delete;
+
+	/**
+	 * @brief Stores the task in the slab and queues it for insertion.
+	 * @return The event id, or 0 if the slab is exhausted (caller should fall back).
+	 */
+	uint64_t schedule(Task &&task);
+
+	/**
+	 * @brief Cancels a scheduled task, it will not be executed anymore.
+	 * @return false if the id is not a live timing wheel event.
+	 */
+	bool cancel(uint64_t eventId);
+
+	static bool isEvent(uint64_t eventId) {
+		return (eventId & EVENT_TAG) != 0;
+	}
+
+	// Dispatcher thread only
+
+	void merge(int64_t now);
+
+	/**
+	 * @brief Fires every task due up to (and including) now.
+	 * @param onExpired Called with each due task, returns true if the task must be rescheduled.
+	 */
+	template <typename F>
+	void advance(int64_t now, F &&onExpired);
+
+	[[nodiscard]] int64_t nextExpiration() const;
+
+	[[nodiscard]] bool empty() const {
+		return count == 0;
+	}
+
+	[[nodiscard]] size_t size() const {
+		return count;
+	}
+
+private:
+	static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+	static constexpr uint64_t EVENT_TAG = 1ULL << 63;
+	static constexpr uint32_t GENERATION_MASK = 0x7FFFFFFF;
+
+	static constexpr uint8_t LEVELS = 5;
+	static constexpr uint8_t FIRST_LEVEL_BITS = 8;
+	static constexpr uint8_t LEVEL_BITS = 6;
+	static constexpr uint32_t FIRST_LEVEL_SIZE = 1 << FIRST_LEVEL_BITS;
+	static constexpr uint32_t LEVEL_SIZE = 1 << LEVEL_BITS;
+	static constexpr int64_t FIRST_LEVEL_MASK = FIRST_LEVEL_SIZE - 1;
+	static constexpr int64_t LEVEL_MASK = LEVEL_SIZE - 1;
+	static constexpr int64_t MAX_RANGE = 1LL << (FIRST_LEVEL_BITS + LEVEL_BITS * (LEVELS - 1));
+
+	static constexpr uint32_t PAGE_SIZE = 1024;
+	static constexpr uint32_t MAX_PAGES = 1024;
+
+	static constexpr uint8_t NONE_LEVEL = std::numeric_limits<uint8_t>::max();
+
+	struct Slot {
+		std::optional<Task> task;
+		int64_t expiration = 0;
+		uint32_t prev = NONE;
+		uint32_t next = NONE;
+		uint16_t bucket = 0;
+		uint8_t level = NONE_LEVEL;
+		std::atomic_bool canceled = false;
+		// Guarded by TimingWheel::mutex
+		uint32_t generation = 1;
+	};
+
+	using Page = std::array<Slot, PAGE_SIZE>;
+
+	Slot &slot(uint32_t index) const {
+		return (*pages[index / PAGE_SIZE])[index % PAGE_SIZE];
+	}
+
+	static uint64_t makeId(uint32_t index, uint32_t generation) {
+		return EVENT_TAG | (static_cast<uint64_t>(generation & GENERATION_MASK) << 32) | index;
+	}
+
+	static uint32_t bucketSize(uint8_t level) {
+		return level == 0 ? FIRST_LEVEL_SIZE : LEVEL_SIZE;
+	}
+
+	static uint8_t levelShift(uint8_t level) {
+		return level == 0 ? 0 : FIRST_LEVEL_BITS + LEVEL_BITS * (level - 1);
+	}
+
+	void insert(uint32_t index);
+	void link(uint32_t index, uint8_t level, uint16_t bucket);
+	void unlink(uint32_t index);
+	uint32_t detach(uint8_t level, uint16_t bucket);
+	void cascade();
+	void release(uint32_t index);
+
+	uint32_t nextFirstLevelBucket(uint32_t from) const;
+
+	// Slab
+	std::array<std::unique_ptr<Page>, MAX_PAGES> pages;
+	uint32_t allocatedSlots = 0;
+	std::vector<uint32_t> freeSlots;
+	std::vector<uint32_t> pending;
+	std::vector<uint64_t> canceled;
+	std::mutex mutex;
+
+	// Wheel
+	std::vector<uint32_t> pendingBuffer;
+	std::vector<uint64_t> canceledBuffer;
+	std::array<std::array<uint32_t, FIRST_LEVEL_SIZE>, LEVELS> heads = [] {
+		std::array<std::array<uint32_t, FIRST_LEVEL_SIZE>, LEVELS> arr {};
+		for (auto &level : arr) {
+			level.fill(NONE);
+		}
+		return arr;
+	}();
+	std::array<uint64_t, FIRST_LEVEL_SIZE / 64> firstLevelBits {};
+	std::vector<uint32_t> ready;
+	int64_t currentTick = 0;
+	size_t count = 0;
+};
+
+template <typename F>
+void TimingWheel::advance(int64_t now, F &&onExpired) {
+	if (count == 0) {
+		currentTick = std::max<int64_t>(currentTick, now + 1);
+		return;
+	}
+
+	while (currentTick <= now) {
+		const auto bucket = static_cast<uint16_t>(currentTick & FIRST_LEVEL_MASK);
+		if (bucket == 0) {
+			cascade();
+		}
+
+		const auto tick = currentTick++;
+		for (uint32_t index = detach(0, bucket); index != NONE;) {
+			ready.emplace_back(index);
+			index = slot(index).next;
+		}
+
+		for (const auto index : ready) {
+			auto &entry = slot(index);
+			entry.level = NONE_LEVEL;
+			entry.prev = entry.next = NONE;
+
+			if (entry.canceled.load(std::memory_order_relaxed)) {
+				release(index);
+				continue;
+			}
+
+			// Clamped beyond the last level, it is not due yet
+			if (entry.task->getTime() > tick) {
+				entry.expiration = entry.task->getTime();
+				insert(index);
+				continue;
+			}
+
+			if (onExpired(*entry.task) && !entry.canceled.load(std::memory_order_relaxed)) {
+				entry.expiration = entry.task->getTime();
+				insert(index);
+			} else {
+				release(index);
+			}
+		}
+		ready.clear();
+
+		// Skip empty buckets up to the next occupied one (or the next cascade)
+		if ((currentTick & FIRST_LEVEL_MASK) != 0) {
+			const auto next = nextFirstLevelBucket(static_cast<uint32_t>(currentTick & FIRST_LEVEL_MASK));
+			currentTick = std::min<int64_t>(now + 1, (currentTick & ~FIRST_LEVEL_MASK) + next);
+		}
+	}
+}
@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "game/scheduling/work_stealing.hpp"
+
+#include "lib/thread/thread_pool.hpp"
+
+// Each worker splits its range in about this many chunks, small enough to balance
+// slow tasks (e.g. a heavy monster think) and big enough to keep the atomics cold.
+static constexpr uint32_t CHUNKS_PER_WORKER = 8;
+
+WorkStealingGroup::State::State(size_t size, uint16_t workerCount, const std::function<void(size_t)> &f) :
+	workers(workerCount), f(f), size(size),
+	chunkSize(std::max<uint32_t>(1, static_cast<uint32_t>(size / (static_cast<size_t>(workerCount) * CHUNKS_PER_WORKER)))) {
+	for (uint16_t i = 0; i < workerCount; ++i) {
+		const auto begin = static_cast<uint32_t>(size * i / workerCount);
+		const auto end = static_cast<uint32_t>(size * (i + 1) / workerCount);
+		workers[i].range.store(pack(begin, end), std::memory_order_relaxed);
+	}
+}
+
+WorkStealingGroup::Stats WorkStealingGroup::run(ThreadPool &threadPool, size_t size, const std::function<void(size_t)> &f) {
+	Stats stats;
+	if (size == 0) {
+		return stats;
+	}
+
+	// The dispatcher itself occupies one thread of the pool
+	const auto helpers = std::min<size_t>(threadPool.get_thread_count() - 1, size - 1);
+	if (helpers == 0 || size > std::numeric_limits<uint32_t>::max()) {
+		for (size_t i = 0; i < size; ++i) {
+			f(i);
+		}
+		stats.workers = 1;
+		return stats;
+	}
+
+	const auto begin = std::chrono::steady_clock::now();
+	const auto state = std::make_shared<State>(size, static_cast<uint16_t>(helpers + 1), f);
+
+	// Helpers that start after everything is done just leave, they never touch f
+	for (size_t i = 0; i < helpers; ++i) {
+		threadPool.detach_task([state] { participate(*state); });
+	}
+
+	participate(*state);
+
+	for (auto done = state->done.load(std::memory_order_acquire); done < size; done = state->done.load(std::memory_order_acquire)) {
+		state->done.wait(done, std::memory_order_acquire);
+	}
+
+	const auto wallNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+
+	const auto busyNs = state->busyNs.load(std::memory_order_relaxed);
+	stats.workers = static_cast<uint16_t>(state->workers.size());
+	stats.steals = state->steals.load(std::memory_order_relaxed);
+	stats.busyUs = busyNs / 1000;
+	stats.idleUs = (wallNs * stats.workers > busyNs ? wallNs * stats.workers - busyNs : 0) / 1000;
+	return stats;
+}
+
+void WorkStealingGroup::participate(State &state) {
+	const auto id = state.joined.fetch_add(1, std::memory_order_relaxed);
+	if (id >= state.workers.size()) {
+		return;
+	}
+
+	auto &self = state.workers[id];
+	while (true) {
+		uint32_t begin;
+		uint32_t end;
+		if (!pop(self, state.chunkSize, begin, end)) {
+			if (!steal(state, id)) {
+				return;
+			}
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = begin; i < end; ++i) {
+			state.f(i);
+		}
+		state.busyNs.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+
+		// The release here publishes busyNs to the caller together with the completion
+		if (state.done.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == state.size) {
+			state.done.notify_all();
+			return;
+		}
+	}
+}
+
+bool WorkStealingGroup::pop(Worker &worker, uint32_t chunkSize, uint32_t &begin, uint32_t &end) {
+	auto range = worker.range.load(std::memory_order_acquire);
+	while (true) {
+		begin = static_cast<uint32_t>(range);
+		end = static_cast<uint32_t>(range >> 32);
+		if (begin >= end) {
+			return false;
+		}
+
+		const auto next = std::min(begin + chunkSize, end);
+		if (worker.range.compare_exchange_weak(range, pack(next, end), std::memory_order_acq_rel)) {
+			end = next;
+			return true;
+		}
+	}
+}
+
+bool WorkStealingGroup::steal(State &state, uint16_t thiefId) {
+	const auto count = static_cast<uint16_t>(state.workers.size());
+	for (uint16_t offset = 1; offset < count; ++offset) {
+		auto &victim = state.workers[(thiefId + offset) % count];
+		auto range = victim.range.load(std::memory_order_acquire);
+		while (true) {
+			const auto begin = static_cast<uint32_t>(range);
+			const auto end = static_cast<uint32_t>(range >> 32);
+			if (begin >= end) {
+				break;
+			}
+
+			// Take the back half, the victim keeps consuming its front
+			const auto middle = begin + (end - begin) / 2;
+			if (victim.range.compare_exchange_weak(range, pack(begin, middle), std::memory_order_acq_rel)) {
+				state.workers[thiefId].range.store(pack(middle, end), std::memory_order_release);
+				state.steals.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+	}
+	return false;
+}
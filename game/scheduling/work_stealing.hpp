@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class ThreadPool;
+
+/**
+ * Runs f(0) .. f(size - 1) on the calling thread plus the thread pool.
+ *
+ * Every worker owns a contiguous range of indexes (its deque) and takes small chunks
+ * from the front of it; when it runs dry it steals the back half of another worker's range.
+ * The calling thread only waits for chunks that are already being executed, so it is safe
+ * to start a group from inside another group (nested parallelism) without starving the pool.
+ */
+class WorkStealingGroup {
+public:
+	struct Stats {
+		uint64_t busyUs = 0; // Time spent executing f, summed over all workers
+		uint64_t idleUs = 0; // Worker time not spent executing f (waiting, stealing, late start)
+		uint32_t steals = 0;
+		uint16_t workers = 0;
+	};
+
+	static Stats run(ThreadPool &threadPool, size_t size, const std::function<void(size_t)> &f);
+
+private:
+	struct alignas(64) Worker {
+		// begin (low 32 bits) and end (high 32 bits) of the owned range
+		std::atomic_uint64_t range = 0;
+	};
+
+	struct State {
+		State(size_t size, uint16_t workerCount, const std::function<void(size_t)> &f);
+
+		std::vector<Worker> workers;
+		const std::function<void(size_t)> &f;
+		const size_t size;
+		const uint32_t chunkSize;
+
+		std::atomic_size_t done = 0;
+		std::atomic_uint16_t joined = 0;
+		std::atomic_uint32_t steals = 0;
+		std::atomic_uint64_t busyNs = 0;
+	};
+
+	static void participate(State &state);
+	static bool pop(Worker &worker, uint32_t chunkSize, uint32_t &begin, uint32_t &end);
+	static bool steal(State &state, uint16_t thiefId);
+
+	static uint64_t pack(uint32_t begin, uint32_t end) {
+		return static_cast<uint64_t>(end) << 32 | begin;
+	}
+};
@@ -45,13 +45,19 @@
 
 void IOLoginDataLoad::loadItems(ItemsMap &itemsMap, const DBResult_ptr &result, const std::shared_ptr<Player> &player) {
 	try {
-		do {
-			auto sid = result->getNumber<uint32_t>("sid");
-			auto pid = result->getNumber<uint32_t>("pid");
-			auto type = result->getNumber<uint16_t>("itemtype");
-			auto count = result->getNumber<uint16_t>("count");
+		const auto sidColumn = result->getColumn("sid");
+		const auto pidColumn = result->getColumn("pid");
+		const auto typeColumn = result->getColumn("itemtype");
+		const auto countColumn = result->getColumn("count");
+		const auto attributesColumn = result->getColumn("attributes");
+
+		result->forEachRow([&](const DBResult &row) {
+			auto sid = row.getNumber<uint32_t>(sidColumn);
+			auto pid = row.getNumber<uint32_t>(pidColumn);
+			auto type = row.getNumber<uint16_t>(typeColumn);
+			auto count = row.getNumber<uint16_t>(countColumn);
 			unsigned long attrSize;
-			const char* attr = result->getStream("attributes", attrSize);
+			const char* attr = row.getStream(attributesColumn, attrSize);
 			PropStream propStream;
 			propStream.init(attr, attrSize);
 
@@ -59,23 +65,100 @@ void IOLoginDataLoad::loadItems(ItemsMap &itemsMap, const DBResult_ptr &result,
 				const auto &item = Item::CreateItem(type, count);
 				if (item) {
 					if (!item->unserializeAttr(propStream)) {
-						g_logger().warn("[{}] - Failed to deserialize item attributes {}, from player {}, from account id {}", __FUNCTION__, item->getID(), player->getName(), player->getAccountId());
-						continue;
+						g_logger().warn("[IOLoginDataLoad::loadItems] - Failed to deserialize item attributes {}, from player {}, from account id {}", item->getID(), player->getName(), player->getAccountId());
+						return;
 					}
 					itemsMap[sid] = std::make_pair(item, pid);
 				} else {
-					g_logger().warn("[{}] - Failed to create item of type {} for player {}, from account id {}", __FUNCTION__, type, player->getName(), player->getAccountId());
+					g_logger().warn("[IOLoginDataLoad::loadItems] - Failed to create item of type {} for player {}, from account id {}", type, player->getName(), player->getAccountId());
 				}
 			} catch (const std::exception &e) {
-				g_logger().warn("[{}] - Exception during the creation or deserialization of the item: {}", __FUNCTION__, e.what());
-				continue;
+				g_logger().warn("[IOLoginDataLoad::loadItems] - Exception during the creation or deserialization of the item: {}", e.what());
 			}
-		} while (result->next());
+		});
 	} catch (const std::exception &e) {
 		g_logger().error("[{}] - General exception during item loading: {}", __FUNCTION__, e.what());
 	}
 }
 
+std::string IOLoginDataLoad::getLoadQuery(PlayerLoadQuery query, uint32_t guid, uint32_t accountId) {
+	switch (query) {
+		case PlayerLoadQuery::Player:
+			return fmt::format("SELECT * FROM `players` WHERE `id` = {}", guid);
+		case PlayerLoadQuery::Outfits:
+			return fmt::format("SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::Mounts:
+			return fmt::format("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::Kills:
+			return fmt::format("SELECT `player_id`, `time`, `target`, `unavenged` FROM `player_kills` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::Guild:
+			return fmt::format("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::GuildWars:
+			return fmt::format("SELECT `guild1`, `guild2` FROM `guild_wars` INNER JOIN `guild_membership` ON `guild_membership`.`player_id` = {} AND (`guild1` = `guild_membership`.`guild_id` OR `guild2` = `guild_membership`.`guild_id`) WHERE `status` = 1", guid);
+		case PlayerLoadQuery::GuildMembers:
+			return fmt::format("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = (SELECT `guild_id` FROM `guild_membership` WHERE `player_id` = {})", guid);
+		case PlayerLoadQuery::Stash:
+			return fmt::format("SELECT `item_count`, `item_id` FROM `player_stash` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::Charms:
+			return fmt::format("SELECT * FROM `player_charms` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::Spells:
+			return fmt::format("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::Inventory:
+			return fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_items WHERE player_id = {} ORDER BY sid DESC", guid);
+		case PlayerLoadQuery::RewardItems:
+			return fmt::format("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_rewards` WHERE `player_id` = {} ORDER BY `pid`, `sid` ASC", guid);
+		case PlayerLoadQuery::DepotItems:
+			return fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_depotitems WHERE player_id = {} ORDER BY sid DESC", guid);
+		case PlayerLoadQuery::InboxItems:
+			return fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_inboxitems WHERE player_id = {} ORDER BY sid DESC", guid);
+		case PlayerLoadQuery::Storage:
+			return fmt::format("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::VipList:
+			return fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {}", accountId);
+		case PlayerLoadQuery::VipGroups:
+			return fmt::format("SELECT `id`, `name`, `customizable` FROM `account_vipgroups` WHERE `account_id` = {}", accountId);
+		case PlayerLoadQuery::VipGroupList:
+			return fmt::format("SELECT `player_id`, `vipgroup_id` FROM `account_vipgrouplist` WHERE `account_id` = {}", accountId);
+		case PlayerLoadQuery::Prey:
+			return fmt::format("SELECT * FROM `player_prey` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::TaskHunting:
+			return fmt::format("SELECT * FROM `player_taskhunt` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::ForgeHistory:
+			return fmt::format("SELECT * FROM `forge_history` WHERE `player_id` = {}", guid);
+		case PlayerLoadQuery::Bosstiary:
+			return fmt::format("SELECT * FROM `player_bosstiary` WHERE `player_id` = {}", guid);
+	}
+	return {};
+}
+
+std::vector<PlayerLoadQuery> IOLoginDataLoad::getBatchQueries(bool disableIrrelevantInfo) {
+	std::vector<PlayerLoadQuery> queries;
+	queries.reserve(magic_enum::enum_count<PlayerLoadQuery>());
+	for (const auto query : magic_enum::enum_values<PlayerLoadQuery>()) {
+		if (query == PlayerLoadQuery::Prey && !g_configManager().getBoolean(PREY_ENABLED)) {
+			continue;
+		}
+		if (query == PlayerLoadQuery::TaskHunting && !g_configManager().getBoolean(TASK_HUNTING_ENABLED)) {
+			continue;
+		}
+		if (disableIrrelevantInfo && (query == PlayerLoadQuery::ForgeHistory || query == PlayerLoadQuery::Bosstiary)) {
+			continue;
+		}
+		queries.emplace_back(query);
+	}
+	return queries;
+}
+
+DBResult_ptr IOLoginDataLoad::storeLoadQuery(const std::shared_ptr<Player> &player, PlayerLoadQuery query) {
+	const auto* batch = PlayerLoadBatch::getActive();
+	if (batch && batch->getGuid() == player->getGUID()) {
+		if (const auto* result = batch->getResult(query)) {
+			return *result;
+		}
+	}
+	return g_database().storeQuery(getLoadQuery(query, player->getGUID(), player->getAccountId()));
+}
+
 bool IOLoginDataLoad::preLoadPlayer(const std::shared_ptr<Player> &player, const std::string &name) {
 	Database &db = Database::getInstance();
 
@@ -342,7 +425,7 @@ void IOLoginDataLoad::loadPlayerDefaultOutfit(const std::shared_ptr<Player> &pla
 	player->currentOutfit = player->defaultOutfit;
 
 	// load outfits & addons
-	auto result2 = g_database().storeQuery(fmt::format("SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID()));
+	auto result2 = storeLoadQuery(player, PlayerLoadQuery::Outfits);
 	if (result2) {
 		do {
 			player->outfitsMap.emplace_back(result2->getNumber<uint16_t>("outfit_id"), result2->getNumber<uint8_t>("addons"));
@@ -350,7 +433,7 @@ void IOLoginDataLoad::loadPlayerDefaultOutfit(const std::shared_ptr<Player> &pla
 	}
 
 	// load mounts
-	auto result3 = g_database().storeQuery(fmt::format("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID()));
+	auto result3 = storeLoadQuery(player, PlayerLoadQuery::Mounts);
 	if (result3) {
 		do {
 			player->mountsMap.emplace(result3->getNumber<uint16_t>("mount_id"));
@@ -412,10 +495,7 @@ void IOLoginDataLoad::loadPlayerKills(const std::shared_ptr<Player> &player, DBR
 		return;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "SELECT `player_id`, `time`, `target`, `unavenged` FROM `player_kills` WHERE `player_id` = " << player->getGUID();
-	if ((result = db.storeQuery(query.str()))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::Kills))) {
 		do {
 			auto killTime = result->getNumber<time_t>("time");
 			if ((time(nullptr) - killTime) <= g_configManager().getNumber(FRAG_TIME)) {
@@ -431,10 +511,7 @@ void IOLoginDataLoad::loadPlayerGuild(const std::shared_ptr<Player> &player, DBR
 		return;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = " << player->getGUID();
-	if ((result = db.storeQuery(query.str()))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::Guild))) {
 		auto guildId = result->getNumber<uint32_t>("guild_id");
 		auto playerRankId = result->getNumber<uint32_t>("rank_id");
 		player->guildNick = result->getString("nick");
@@ -449,10 +526,10 @@ void IOLoginDataLoad::loadPlayerGuild(const std::shared_ptr<Player> &player, DBR
 			player->guild = guild;
 			GuildRank_ptr rank = guild->getRankById(playerRankId);
 			if (!rank) {
-				query.str("");
+				std::ostringstream query;
 				query << "SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = " << playerRankId;
 
-				if ((result = db.storeQuery(query.str()))) {
+				if ((result = g_database().storeQuery(query.str()))) {
 					guild->addRank(result->getNumber<uint32_t>("id"), result->getString("name"), static_cast<uint8_t>(result->getNumber<uint16_t>("level")));
 				}
 
@@ -464,11 +541,9 @@ void IOLoginDataLoad::loadPlayerGuild(const std::shared_ptr<Player> &player, DBR
 
 			player->guildRank = rank;
 
-			IOGuild::getWarList(guildId, player->guildWarVector);
+			IOGuild::getWarList(guildId, player->guildWarVector, storeLoadQuery(player, PlayerLoadQuery::GuildWars));
 
-			query.str("");
-			query << "SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = " << guildId;
-			if ((result = db.storeQuery(query.str()))) {
+			if ((result = storeLoadQuery(player, PlayerLoadQuery::GuildMembers))) {
 				guild->setMemberCount(result->getNumber<uint32_t>("members"));
 			}
 		}
@@ -481,10 +556,7 @@ void IOLoginDataLoad::loadPlayerStashItems(const std::shared_ptr<Player> &player
 		return;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "SELECT `item_count`, `item_id`  FROM `player_stash` WHERE `player_id` = " << player->getGUID();
-	if ((result = db.storeQuery(query.str()))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::Stash))) {
 		do {
 			player->addItemOnStash(result->getNumber<uint16_t>("item_id"), result->getNumber<uint32_t>("item_count"));
 		} while (result->next());
@@ -497,10 +569,7 @@ void IOLoginDataLoad::loadPlayerBestiaryCharms(const std::shared_ptr<Player> &pl
 		return;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "SELECT * FROM `player_charms` WHERE `player_id` = " << player->getGUID();
-	if ((result = db.storeQuery(query.str()))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::Charms))) {
 		player->charmPoints = result->getNumber<uint32_t>("charm_points");
 		player->minorCharmEchoes = result->getNumber<uint32_t>("minor_charm_echoes");
 		player->maxCharmPoints = result->getNumber<uint32_t>("max_charm_points");
@@ -540,7 +609,7 @@ void IOLoginDataLoad::loadPlayerBestiaryCharms(const std::shared_ptr<Player> &pl
 			}
 		}
 	} else {
-		query.str("");
+		std::ostringstream query;
 		query << "INSERT INTO `player_charms` (`player_id`) VALUES (" << player->getGUID() << ')';
 		Database::getInstance().executeQuery(query.str());
 	}
@@ -552,10 +621,7 @@ void IOLoginDataLoad::loadPlayerInstantSpellList(const std::shared_ptr<Player> &
 		return;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = " << player->getGUID();
-	if ((result = db.storeQuery(query.str()))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::Spells))) {
 		do {
 			player->learnedInstantSpellList.emplace_back(result->getString("name"));
 		} while (result->next());
@@ -569,14 +635,13 @@ void IOLoginDataLoad::loadPlayerInventoryItems(const std::shared_ptr<Player> &pl
 	}
 
 	bool oldProtocol = g_configManager().getBoolean(OLD_PROTOCOL) && player->getProtocolVersion() < 1200;
-	auto query = fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_items WHERE player_id = {} ORDER BY sid DESC", player->getGUID());
 
 	ItemsMap inventoryItems;
 	std::vector<std::pair<uint8_t, std::shared_ptr<Container>>> openContainersList;
 	std::vector<std::shared_ptr<Item>> itemsToStartDecaying;
 
 	try {
-		if ((result = g_database().storeQuery(query))) {
+		if ((result = storeLoadQuery(player, PlayerLoadQuery::Inventory))) {
 			loadItems(inventoryItems, result, player);
 
 			for (auto it = inventoryItems.rbegin(), end = inventoryItems.rend(); it != end; ++it) {
@@ -667,11 +732,7 @@ void IOLoginDataLoad::loadRewardItems(const std::shared_ptr<Player> &player) {
 	}
 
 	ItemsMap rewardItems;
-	std::ostringstream query;
-	query.str(std::string());
-	query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_rewards` WHERE `player_id` = "
-		  << player->getGUID() << " ORDER BY `pid`, `sid` ASC";
-	if (auto result = Database::getInstance().storeQuery(query.str())) {
+	if (auto result = storeLoadQuery(player, PlayerLoadQuery::RewardItems)) {
 		loadItems(rewardItems, result, player);
 		bindRewardBag(player, rewardItems);
 		insertItemsIntoRewardBag(rewardItems);
@@ -686,8 +747,7 @@ void IOLoginDataLoad::loadPlayerDepotItems(const std::shared_ptr<Player> &player
 
 	ItemsMap depotItems;
 	std::vector<std::shared_ptr<Item>> itemsToStartDecaying;
-	auto query = fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_depotitems WHERE player_id = {} ORDER BY sid DESC", player->getGUID());
-	if ((result = g_database().storeQuery(query))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::DepotItems))) {
 		loadItems(depotItems, result, player);
 		for (auto it = depotItems.rbegin(), end = depotItems.rend(); it != end; ++it) {
 			const std::pair<std::shared_ptr<Item>, int32_t> &pair = it->second;
@@ -732,8 +792,7 @@ void IOLoginDataLoad::loadPlayerInboxItems(const std::shared_ptr<Player> &player
 	}
 
 	std::vector<std::shared_ptr<Item>> itemsToStartDecaying;
-	auto query = fmt::format("SELECT pid, sid, itemtype, count, attributes FROM player_inboxitems WHERE player_id = {} ORDER BY sid DESC", player->getGUID());
-	if ((result = g_database().storeQuery(query))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::InboxItems))) {
 		ItemsMap inboxItems;
 		loadItems(inboxItems, result, player);
 
@@ -781,10 +840,7 @@ void IOLoginDataLoad::loadPlayerStorageMap(const std::shared_ptr<Player> &player
 		return;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = " << player->getGUID();
-	if ((result = db.storeQuery(query.str()))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::Storage))) {
 		do {
 			player->addStorageValue(result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"), true);
 		} while (result->next());
@@ -797,18 +853,13 @@ void IOLoginDataLoad::loadPlayerVip(const std::shared_ptr<Player> &player, DBRes
 		return;
 	}
 
-	uint32_t accountId = player->getAccountId();
-
-	Database &db = Database::getInstance();
-	std::string query = fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {}", accountId);
-	if ((result = db.storeQuery(query))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::VipList))) {
 		do {
 			player->vip()->addInternal(result->getNumber<uint32_t>("player_id"));
 		} while (result->next());
 	}
 
-	query = fmt::format("SELECT `id`, `name`, `customizable` FROM `account_vipgroups` WHERE `account_id` = {}", accountId);
-	if ((result = db.storeQuery(query))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::VipGroups))) {
 		do {
 			player->vip()->addGroupInternal(
 				result->getNumber<uint8_t>("id"),
@@ -818,8 +869,7 @@ void IOLoginDataLoad::loadPlayerVip(const std::shared_ptr<Player> &player, DBRes
 		} while (result->next());
 	}
 
-	query = fmt::format("SELECT `player_id`, `vipgroup_id` FROM `account_vipgrouplist` WHERE `account_id` = {}", accountId);
-	if ((result = db.storeQuery(query))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::VipGroupList))) {
 		do {
 			player->vip()->addGuidToGroupInternal(
 				result->getNumber<uint8_t>("vipgroup_id"),
@@ -836,10 +886,7 @@ void IOLoginDataLoad::loadPlayerPreyClass(const std::shared_ptr<Player> &player,
 	}
 
 	if (g_configManager().getBoolean(PREY_ENABLED)) {
-		Database &db = Database::getInstance();
-		std::ostringstream query;
-		query << "SELECT * FROM `player_prey` WHERE `player_id` = " << player->getGUID();
-		if ((result = db.storeQuery(query.str()))) {
+		if ((result = storeLoadQuery(player, PlayerLoadQuery::Prey))) {
 			do {
 				auto slot = std::make_unique<PreySlot>(static_cast<PreySlot_t>(result->getNumber<uint16_t>("slot")));
 				auto state = static_cast<PreyDataState_t>(result->getNumber<uint16_t>("state"));
@@ -883,10 +930,7 @@ void IOLoginDataLoad::loadPlayerTaskHuntingClass(const std::shared_ptr<Player> &
 	}
 
 	if (g_configManager().getBoolean(TASK_HUNTING_ENABLED)) {
-		Database &db = Database::getInstance();
-		std::ostringstream query;
-		query << "SELECT * FROM `player_taskhunt` WHERE `player_id` = " << player->getGUID();
-		if ((result = db.storeQuery(query.str()))) {
+		if ((result = storeLoadQuery(player, PlayerLoadQuery::TaskHunting))) {
 			do {
 				auto slot = std::make_unique<TaskHuntingSlot>(static_cast<PreySlot_t>(result->getNumber<uint16_t>("slot")));
 				auto state = static_cast<PreyTaskDataState_t>(result->getNumber<uint16_t>("state"));
@@ -932,9 +976,7 @@ void IOLoginDataLoad::loadPlayerForgeHistory(const std::shared_ptr<Player> &play
 		return;
 	}
 
-	std::ostringstream query;
-	query << "SELECT * FROM `forge_history` WHERE `player_id` = " << player->getGUID();
-	if ((result = Database::getInstance().storeQuery(query.str()))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::ForgeHistory))) {
 		do {
 			auto actionEnum = magic_enum::enum_value<ForgeAction_t>(result->getNumber<uint16_t>("action_type"));
 			ForgeHistory history;
@@ -958,9 +1000,7 @@ void IOLoginDataLoad::loadPlayerBosstiary(const std::shared_ptr<Player> &player,
 		return;
 	}
 
-	std::ostringstream query;
-	query << "SELECT * FROM `player_bosstiary` WHERE `player_id` = " << player->getGUID();
-	if ((result = Database::getInstance().storeQuery(query.str()))) {
+	if ((result = storeLoadQuery(player, PlayerLoadQuery::Bosstiary))) {
 		do {
 			player->setSlotBossId(1, result->getNumber<uint16_t>("bossIdSlotOne"));
 			player->setSlotBossId(2, result->getNumber<uint16_t>("bossIdSlotTwo"));
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "io/iologindata.hpp"
+#include "io/functions/player_load_batch.hpp"
 
 class Player;
 class DBResult;
@@ -53,6 +54,12 @@ public:
 	static void loadPlayerInitializeSystem(const std::shared_ptr<Player> &player);
 	static void loadPlayerUpdateSystem(const std::shared_ptr<Player> &player);
 
+	static std::string getLoadQuery(PlayerLoadQuery query, uint32_t guid, uint32_t accountId);
+	// Queries a login can fetch ahead, the ones the load would skip are left out
+	static std::vector<PlayerLoadQuery> getBatchQueries(bool disableIrrelevantInfo);
+	// Takes the result from the active batch of the player, or runs the query now
+	static DBResult_ptr storeLoadQuery(const std::shared_ptr<Player> &player, PlayerLoadQuery query);
+
 private:
 	using ItemsMap = std::map<uint32_t, std::pair<std::shared_ptr<Item>, uint32_t>>;
 
@@ -29,15 +29,12 @@
 #include "items/containers/rewards/reward.hpp"
 #include "creatures/players/player.hpp"
 
-bool IOLoginDataSave::saveItems(const std::shared_ptr<Player> &player, const ItemBlockList &itemList, DBInsert &query_insert, PropWriteStream &propWriteStream) {
+bool IOLoginDataSave::saveItems(const std::shared_ptr<Player> &player, const ItemBlockList &itemList, ItemRows &rows, PropWriteStream &propWriteStream) {
 	if (!player) {
 		g_logger().warn("[IOLoginData::savePlayer] - Player nullptr: {}", __FUNCTION__);
 		return false;
 	}
 
-	const Database &db = Database::getInstance();
-	std::ostringstream ss;
-
 	// Initialize variables
 	using ContainerBlock = std::pair<std::shared_ptr<Container>, int32_t>;
 	std::vector<ContainerBlock> containers;
@@ -90,12 +87,7 @@ bool IOLoginDataSave::saveItems(const std::shared_ptr<Player> &player, const Ite
 		size_t attributesSize;
 		const char* attributes = propWriteStream.getStream(attributesSize);
 
-		// Build query string and add row
-		ss << player->getGUID() << ',' << pid << ',' << runningId << ',' << item->getID() << ',' << item->getSubType() << ',' << db.escapeBlob(attributes, static_cast<uint32_t>(attributesSize));
-		if (!query_insert.addRow(ss)) {
-			g_logger().error("Error adding row to query.");
-			return false;
-		}
+		rows.emplace_back(ItemRow { pid, runningId, item->getID(), item->getSubType(), std::string(attributes, attributesSize) });
 	}
 
 	// Loop through containers in queue
@@ -144,21 +136,129 @@ bool IOLoginDataSave::saveItems(const std::shared_ptr<Player> &player, const Ite
 			size_t attributesSize;
 			const char* attributes = propWriteStream.getStream(attributesSize);
 
-			// Build query string and add row
-			ss << player->getGUID() << ',' << parentId << ',' << runningId << ',' << item->getID() << ',' << item->getSubType() << ',' << db.escapeBlob(attributes, static_cast<uint32_t>(attributesSize));
-			if (!query_insert.addRow(ss)) {
-				g_logger().error("Error adding row to query for container item.");
-				return false;
+			rows.emplace_back(ItemRow { parentId, runningId, item->getID(), item->getSubType(), std::string(attributes, attributesSize) });
+		}
+	}
+
+	return true;
+}
+
+bool IOLoginDataSave::writeItemRows(const std::shared_ptr<Player> &player, PlayerSaveSection section, std::string_view table, const ItemRows &rows) {
+	Database &db = Database::getInstance();
+	auto &saveState = player->saveState;
+	const auto* committed = saveState.getCommitted(section);
+	auto &staged = saveState.stage(section);
+	staged.reserve(rows.size());
+
+	// Against a committed save only new or changed sids are rewritten and vanished ones deleted
+	std::vector<const ItemRow*> changedRows;
+	std::vector<int32_t> staleSids;
+	for (const auto &row : rows) {
+		const auto sid = row.sid;
+		const auto digest = row.digest();
+		staged[sid] = digest;
+		if (!committed) {
+			changedRows.emplace_back(&row);
+			continue;
+		}
+
+		const auto it = committed->find(sid);
+		if (it == committed->end() || it->second != digest) {
+			changedRows.emplace_back(&row);
+			if (it != committed->end()) {
+				staleSids.emplace_back(sid);
 			}
 		}
 	}
 
-	// Execute query
-	if (!query_insert.execute()) {
+	if (committed) {
+		for (const auto &[sid, digest] : *committed) {
+			if (!staged.contains(sid)) {
+				staleSids.emplace_back(static_cast<int32_t>(sid));
+			}
+		}
+
+		if (changedRows.empty() && staleSids.empty()) {
+			saveState.addSectionSkipped();
+			return true;
+		}
+
+		if (!staleSids.empty() && !db.executeQuery(fmt::format("DELETE FROM `{}` WHERE `player_id` = {} AND `sid` IN ({})", table, player->getGUID(), fmt::join(staleSids, ",")))) {
+			return false;
+		}
+	} else if (!db.executeQuery(fmt::format("DELETE FROM `{}` WHERE `player_id` = {}", table, player->getGUID()))) {
+		return false;
+	}
+
+	DBPreparedInsert itemsQuery(fmt::format("INSERT INTO `{}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ", table), 6);
+	for (const auto* row : changedRows) {
+		if (!itemsQuery.addRow({ player->getGUID(), row->pid, row->sid, row->itemType, row->count, DBParam::blob(row->attributes) })) {
+			g_logger().error("Error adding row to query.");
+			return false;
+		}
+	}
+
+	if (!itemsQuery.execute()) {
 		g_logger().error("Error executing query.");
 		return false;
 	}
 
+	saveState.addRowsWritten(changedRows.size());
+	return true;
+}
+
+bool IOLoginDataSave::replaceRows(const std::shared_ptr<Player> &player, PlayerSaveSection section, std::string_view insertQuery, std::string_view table, const std::vector<std::string> &rows) {
+	auto &saveState = player->saveState;
+	auto digest = rows.size();
+	for (const auto &row : rows) {
+		digest = digest * 31 + std::hash<std::string_view> {}(row);
+	}
+
+	saveState.stage(section)[0] = digest;
+	const auto* committed = saveState.getCommitted(section);
+	if (committed && committed->contains(0) && committed->at(0) == digest) {
+		saveState.addSectionSkipped();
+		return true;
+	}
+
+	if (!Database::getInstance().executeQuery(fmt::format("DELETE FROM `{}` WHERE `player_id` = {}", table, player->getGUID()))) {
+		return false;
+	}
+
+	DBInsert query { std::string(insertQuery) };
+	for (const auto &row : rows) {
+		if (!query.addRow(row)) {
+			return false;
+		}
+	}
+
+	if (!query.execute()) {
+		return false;
+	}
+
+	saveState.addRowsWritten(rows.size());
+	return true;
+}
+
+bool IOLoginDataSave::executeIfChanged(const std::shared_ptr<Player> &player, PlayerSaveSection section, int64_t key, const std::string &query) {
+	auto &saveState = player->saveState;
+	const auto digest = std::hash<std::string_view> {}(query);
+	saveState.stage(section)[key] = digest;
+
+	const auto* committed = saveState.getCommitted(section);
+	if (committed) {
+		const auto it = committed->find(key);
+		if (it != committed->end() && it->second == digest) {
+			saveState.addSectionSkipped();
+			return true;
+		}
+	}
+
+	if (!Database::getInstance().executeQuery(query)) {
+		return false;
+	}
+
+	saveState.addRowsWritten(1);
 	return true;
 }
 
@@ -338,6 +438,7 @@ bool IOLoginDataSave::savePlayerFirst(const std::shared_ptr<Player> &player) {
 	if (!db.executeQuery(query.str())) {
 		return false;
 	}
+	player->saveState.addRowsWritten(1);
 	return true;
 }
 
@@ -347,27 +448,12 @@ bool IOLoginDataSave::savePlayerStash(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "DELETE FROM `player_stash` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-
-	DBInsert stashQuery("INSERT INTO `player_stash` (`player_id`,`item_id`,`item_count`) VALUES ");
+	std::vector<std::string> rows;
 	for (const auto &[itemId, itemCount] : player->getStashItems()) {
-		query << player->getGUID() << ',' << itemId << ',' << itemCount;
-		if (!stashQuery.addRow(query)) {
-			return false;
-		}
+		rows.emplace_back(fmt::format("{},{},{}", player->getGUID(), itemId, itemCount));
 	}
 
-	if (!stashQuery.execute()) {
-		return false;
-	}
-	return true;
+	return replaceRows(player, PlayerSaveSection::Stash, "INSERT INTO `player_stash` (`player_id`,`item_id`,`item_count`) VALUES ", "player_stash", rows);
 }
 
 bool IOLoginDataSave::savePlayerSpells(const std::shared_ptr<Player> &player) {
@@ -376,27 +462,13 @@ bool IOLoginDataSave::savePlayerSpells(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "DELETE FROM `player_spells` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-
-	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name` ) VALUES ");
+	const Database &db = Database::getInstance();
+	std::vector<std::string> rows;
 	for (const std::string &spellName : player->learnedInstantSpellList) {
-		query << player->getGUID() << ',' << db.escapeString(spellName);
-		if (!spellsQuery.addRow(query)) {
-			return false;
-		}
+		rows.emplace_back(fmt::format("{},{}", player->getGUID(), db.escapeString(spellName)));
 	}
 
-	if (!spellsQuery.execute()) {
-		return false;
-	}
-	return true;
+	return replaceRows(player, PlayerSaveSection::Spells, "INSERT INTO `player_spells` (`player_id`, `name` ) VALUES ", "player_spells", rows);
 }
 
 bool IOLoginDataSave::savePlayerKills(const std::shared_ptr<Player> &player) {
@@ -405,27 +477,15 @@ bool IOLoginDataSave::savePlayerKills(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
 	std::ostringstream query;
-	query << "DELETE FROM `player_kills` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-
-	DBInsert killsQuery("INSERT INTO `player_kills` (`player_id`, `target`, `time`, `unavenged`) VALUES");
+	std::vector<std::string> rows;
 	for (const auto &kill : player->unjustifiedKills) {
 		query << player->getGUID() << ',' << kill.target << ',' << kill.time << ',' << kill.unavenged;
-		if (!killsQuery.addRow(query)) {
-			return false;
-		}
+		rows.emplace_back(query.str());
+		query.str("");
 	}
 
-	if (!killsQuery.execute()) {
-		return false;
-	}
-	return true;
+	return replaceRows(player, PlayerSaveSection::Kills, "INSERT INTO `player_kills` (`player_id`, `target`, `time`, `unavenged`) VALUES", "player_kills", rows);
 }
 
 bool IOLoginDataSave::savePlayerBestiarySystem(const std::shared_ptr<Player> &player) {
@@ -466,7 +526,7 @@ bool IOLoginDataSave::savePlayerBestiarySystem(const std::shared_ptr<Player> &pl
 	query << " `tracker list` = " << db.escapeBlob(trackerList, static_cast<uint32_t>(trackerSize));
 	query << " WHERE `player_id` = " << player->getGUID();
 
-	if (!db.executeQuery(query.str())) {
+	if (!executeIfChanged(player, PlayerSaveSection::Bestiary, 0, query.str())) {
 		g_logger().warn("[IOLoginData::savePlayer] - Error saving bestiary data from player: {}", player->getName());
 		return false;
 	}
@@ -479,17 +539,7 @@ bool IOLoginDataSave::savePlayerItem(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
 	PropWriteStream propWriteStream;
-	std::ostringstream query;
-	query << "DELETE FROM `player_items` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		g_logger().warn("[IOLoginData::savePlayer] - Error delete query 'player_items' from player: {}", player->getName());
-		return false;
-	}
-
-	DBInsert itemsQuery("INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
 	ItemBlockList itemList;
 	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
 		const auto &item = player->inventory[slotId];
@@ -498,7 +548,8 @@ bool IOLoginDataSave::savePlayerItem(const std::shared_ptr<Player> &player) {
 		}
 	}
 
-	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
+	ItemRows rows;
+	if (!saveItems(player, itemList, rows, propWriteStream) || !writeItemRows(player, PlayerSaveSection::Items, "player_items", rows)) {
 		g_logger().warn("[IOLoginData::savePlayer] - Failed for save items from player: {}", player->getName());
 		return false;
 	}
@@ -511,31 +562,17 @@ bool IOLoginDataSave::savePlayerDepotItems(const std::shared_ptr<Player> &player
 		return false;
 	}
 
-	Database &db = Database::getInstance();
 	PropWriteStream propWriteStream;
 	ItemDepotList depotList;
 	if (player->lastDepotId != -1) {
-		std::ostringstream query;
-		query << "DELETE FROM `player_depotitems` WHERE `player_id` = " << player->getGUID();
-
-		if (!db.executeQuery(query.str())) {
-			return false;
-		}
-
-		query.str("");
-
-		DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
 		for (const auto &[pid, depotChest] : player->depotChests) {
 			for (const std::shared_ptr<Item> &item : depotChest->getItemList()) {
 				depotList.emplace_back(pid, item);
 			}
 		}
 
-		if (!saveItems(player, depotList, depotQuery, propWriteStream)) {
-			return false;
-		}
-		return true;
+		ItemRows rows;
+		return saveItems(player, depotList, rows, propWriteStream) && writeItemRows(player, PlayerSaveSection::DepotItems, "player_depotitems", rows);
 	}
 	return true;
 }
@@ -546,32 +583,20 @@ bool IOLoginDataSave::saveRewardItems(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	std::ostringstream query;
-	query << "DELETE FROM `player_rewards` WHERE `player_id` = " << player->getGUID();
-
-	if (!Database::getInstance().executeQuery(query.str())) {
-		return false;
-	}
-
 	std::vector<uint64_t> rewardList;
 	player->getRewardList(rewardList);
 
 	ItemRewardList rewardListItems;
-	if (!rewardList.empty()) {
-		for (const auto &rewardId : rewardList) {
-			auto reward = player->getReward(rewardId, false);
-			if (!reward->empty() && (getTimeMsNow() - rewardId <= 1000 * 60 * 60 * 24 * 7)) {
-				rewardListItems.emplace_back(0, reward);
-			}
-		}
-
-		DBInsert rewardQuery("INSERT INTO `player_rewards` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-		PropWriteStream propWriteStream;
-		if (!saveItems(player, rewardListItems, rewardQuery, propWriteStream)) {
-			return false;
+	for (const auto &rewardId : rewardList) {
+		auto reward = player->getReward(rewardId, false);
+		if (!reward->empty() && (getTimeMsNow() - rewardId <= 1000 * 60 * 60 * 24 * 7)) {
+			rewardListItems.emplace_back(0, reward);
 		}
 	}
-	return true;
+
+	ItemRows rows;
+	PropWriteStream propWriteStream;
+	return saveItems(player, rewardListItems, rows, propWriteStream) && writeItemRows(player, PlayerSaveSection::RewardItems, "player_rewards", rows);
 }
 
 bool IOLoginDataSave::savePlayerInbox(const std::shared_ptr<Player> &player) {
@@ -580,26 +605,14 @@ bool IOLoginDataSave::savePlayerInbox(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
-	Database &db = Database::getInstance();
 	PropWriteStream propWriteStream;
 	ItemInboxList inboxList;
-	std::ostringstream query;
-	query << "DELETE FROM `player_inboxitems` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-	DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
 	for (const auto &item : player->getInbox()->getItemList()) {
 		inboxList.emplace_back(0, item);
 	}
 
-	if (!saveItems(player, inboxList, inboxQuery, propWriteStream)) {
-		return false;
-	}
-	return true;
+	ItemRows rows;
+	return saveItems(player, inboxList, rows, propWriteStream) && writeItemRows(player, PlayerSaveSection::InboxItems, "player_inboxitems", rows);
 }
 
 bool IOLoginDataSave::savePlayerPreyClass(const std::shared_ptr<Player> &player) {
@@ -646,7 +659,7 @@ bool IOLoginDataSave::savePlayerPreyClass(const std::shared_ptr<Player> &player)
 					  << "`free_reroll` = VALUES(`free_reroll`), "
 					  << "`monster_list` = VALUES(`monster_list`)";
 
-				if (!db.executeQuery(query.str())) {
+				if (!executeIfChanged(player, PlayerSaveSection::Prey, slotId, query.str())) {
 					g_logger().warn("[IOLoginData::savePlayer] - Error saving prey slot data from player: {}", player->getName());
 					return false;
 				}
@@ -698,7 +711,7 @@ bool IOLoginDataSave::savePlayerTaskHuntingClass(const std::shared_ptr<Player> &
 					  << "`free_reroll` = VALUES(`free_reroll`), "
 					  << "`monster_list` = VALUES(`monster_list`)";
 
-				if (!db.executeQuery(query.str())) {
+				if (!executeIfChanged(player, PlayerSaveSection::TaskHunting, slotId, query.str())) {
 					g_logger().warn("[IOLoginData::savePlayer] - Error saving task hunting slot data from player: {}", player->getName());
 					return false;
 				}
@@ -715,13 +728,7 @@ bool IOLoginDataSave::savePlayerForgeHistory(const std::shared_ptr<Player> &play
 	}
 
 	std::ostringstream query;
-	query << "DELETE FROM `forge_history` WHERE `player_id` = " << player->getGUID();
-	if (!Database::getInstance().executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-	DBInsert insertQuery("INSERT INTO `forge_history` (`player_id`, `action_type`, `description`, `done_at`, `is_success`) VALUES");
+	std::vector<std::string> rows;
 	for (const auto &history : player->getForgeHistory()) {
 		const auto stringDescription = Database::getInstance().escapeString(history.description);
 		auto actionString = magic_enum::enum_integer(history.actionType);
@@ -731,15 +738,11 @@ bool IOLoginDataSave::savePlayerForgeHistory(const std::shared_ptr<Player> &play
 			  << stringDescription << ','
 			  << history.createdAt << ','
 			  << history.success;
-
-		if (!insertQuery.addRow(query)) {
-			return false;
-		}
-	}
-	if (!insertQuery.execute()) {
-		return false;
+		rows.emplace_back(query.str());
+		query.str("");
 	}
-	return true;
+
+	return replaceRows(player, PlayerSaveSection::ForgeHistory, "INSERT INTO `forge_history` (`player_id`, `action_type`, `description`, `done_at`, `is_success`) VALUES", "forge_history", rows);
 }
 
 bool IOLoginDataSave::savePlayerBosstiary(const std::shared_ptr<Player> &player) {
@@ -749,13 +752,6 @@ bool IOLoginDataSave::savePlayerBosstiary(const std::shared_ptr<Player> &player)
 	}
 
 	std::ostringstream query;
-	query << "DELETE FROM `player_bosstiary` WHERE `player_id` = " << player->getGUID();
-	if (!Database::getInstance().executeQuery(query.str())) {
-		return false;
-	}
-
-	query.str("");
-	DBInsert insertQuery("INSERT INTO `player_bosstiary` (`player_id`, `bossIdSlotOne`, `bossIdSlotTwo`, `removeTimes`, `tracker`) VALUES");
 
 	// Bosstiary tracker
 	PropWriteStream stream;
@@ -775,15 +771,7 @@ bool IOLoginDataSave::savePlayerBosstiary(const std::shared_ptr<Player> &player)
 		  << std::to_string(player->getRemoveTimes()) << ','
 		  << Database::getInstance().escapeBlob(chars, static_cast<uint32_t>(size));
 
-	if (!insertQuery.addRow(query)) {
-		return false;
-	}
-
-	if (!insertQuery.execute()) {
-		return false;
-	}
-
-	return true;
+	return replaceRows(player, PlayerSaveSection::Bosstiary, "INSERT INTO `player_bosstiary` (`player_id`, `bossIdSlotOne`, `bossIdSlotTwo`, `removeTimes`, `tracker`) VALUES", "player_bosstiary", { query.str() });
 }
 
 bool IOLoginDataSave::savePlayerStorage(const std::shared_ptr<Player> &player) {
@@ -793,27 +781,60 @@ bool IOLoginDataSave::savePlayerStorage(const std::shared_ptr<Player> &player) {
 	}
 
 	Database &db = Database::getInstance();
-	std::ostringstream query;
-	query << "DELETE FROM `player_storage` WHERE `player_id` = " << player->getGUID();
-	if (!db.executeQuery(query.str())) {
+	auto &saveState = player->saveState;
+	player->genReservedStorageRange();
+
+	// Values are their own digests, a committed save is patched with an upsert of the changed keys
+	const auto* committed = saveState.getCommitted(PlayerSaveSection::Storage);
+	auto &staged = saveState.stage(PlayerSaveSection::Storage);
+	staged.reserve(player->storageMap.size());
+
+	std::vector<int64_t> removedKeys;
+	if (committed) {
+		for (const auto &[key, value] : *committed) {
+			if (!player->storageMap.contains(static_cast<uint32_t>(key))) {
+				removedKeys.emplace_back(key);
+			}
+		}
+	} else if (!db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {}", player->getGUID()))) {
 		return false;
 	}
 
-	query.str("");
+	if (!removedKeys.empty() && !db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {} AND `key` IN ({})", player->getGUID(), fmt::join(removedKeys, ",")))) {
+		return false;
+	}
 
+	std::ostringstream query;
 	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ");
-	player->genReservedStorageRange();
+	storageQuery.upsert({ "value" });
 
+	size_t changedKeys = 0;
 	for (const auto &[key, value] : player->storageMap) {
+		staged[key] = static_cast<uint64_t>(value);
+		if (committed) {
+			const auto it = committed->find(key);
+			if (it != committed->end() && it->second == static_cast<uint64_t>(value)) {
+				continue;
+			}
+		}
+
 		query << player->getGUID() << ',' << key << ',' << value;
 		if (!storageQuery.addRow(query)) {
 			return false;
 		}
+		++changedKeys;
+	}
+
+	if (committed && changedKeys == 0 && removedKeys.empty()) {
+		saveState.addSectionSkipped();
+		return true;
 	}
 
 	if (!storageQuery.execute()) {
 		return false;
 	}
+
+	saveState.addRowsWritten(changedKeys);
 	return true;
 }
 
@@ -894,6 +915,7 @@ bool IOLoginDataSave::savePlayerOutfits(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
+	player->saveState.addRowsWritten(player->outfitsMap.size());
 	player->setOutfitsModified(false);
 	return true;
 }
@@ -919,6 +941,7 @@ bool IOLoginDataSave::savePlayerMounts(const std::shared_ptr<Player> &player) {
 		return false;
 	}
 
+	player->saveState.addRowsWritten(player->mountsMap.size());
 	player->setMountsModified(false);
 	return true;
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "io/iologindata.hpp"
+#include "io/functions/player_save_state.hpp"
 
 class PropWriteStream;
 class DBInsert;
@@ -48,6 +49,29 @@ protected:
 	using ItemDepotList = std::list<std::pair<int32_t, std::shared_ptr<Item>>>;
 	using ItemRewardList = std::list<std::pair<int32_t, std::shared_ptr<Item>>>;
 	using ItemInboxList = std::list<std::pair<int32_t, std::shared_ptr<Item>>>;
+	// Row of an item table, the attributes are the serialized blob
+	struct ItemRow {
+		int32_t pid = 0;
+		int32_t sid = 0;
+		uint16_t itemType = 0;
+		uint16_t count = 0;
+		std::string attributes;
 
-	static bool saveItems(const std::shared_ptr<Player> &player, const ItemBlockList &itemList, DBInsert &query_insert, PropWriteStream &stream);
+		uint64_t digest() const {
+			auto digest = std::hash<std::string_view> {}(attributes);
+			digest = digest * 31 + static_cast<uint32_t>(pid);
+			digest = digest * 31 + itemType;
+			return digest * 31 + count;
+		}
+	};
+	using ItemRows = std::vector<ItemRow>;
+
+	static bool saveItems(const std::shared_ptr<Player> &player, const ItemBlockList &itemList, ItemRows &rows, PropWriteStream &stream);
+
+	// Rewrites only the sids that changed since the last committed save (all of them without one)
+	static bool writeItemRows(const std::shared_ptr<Player> &player, PlayerSaveSection section, std::string_view table, const ItemRows &rows);
+	// Deletes and reinserts every row of the player, unless the rows equal the last committed save
+	static bool replaceRows(const std::shared_ptr<Player> &player, PlayerSaveSection section, std::string_view insertQuery, std::string_view table, const std::vector<std::string> &rows);
+	// Runs a single row statement unless it equals the one the last committed save ran under that key
+	static bool executeIfChanged(const std::shared_ptr<Player> &player, PlayerSaveSection section, int64_t key, const std::string &query);
 };
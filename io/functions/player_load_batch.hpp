@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class DBResult;
+using DBResult_ptr = std::shared_ptr<DBResult>;
+
+enum class PlayerLoadQuery : uint8_t {
+	Player,
+	Outfits,
+	Mounts,
+	Kills,
+	Guild,
+	GuildWars,
+	GuildMembers,
+	Stash,
+	Charms,
+	Spells,
+	Inventory,
+	RewardItems,
+	DepotItems,
+	InboxItems,
+	Storage,
+	VipList,
+	VipGroups,
+	VipGroupList,
+	Prey,
+	TaskHunting,
+	ForgeHistory,
+	Bosstiary,
+};
+
+/**
+ * Results of the queries of one player load that only need its guid and account, fetched all at once
+ * on the database threads. While a batch is active on the loading thread the loaders take their rows
+ * from it, queries it does not hold still run in place.
+ */
+class PlayerLoadBatch {
+public:
+	PlayerLoadBatch(uint32_t guid, size_t expectedResults) :
+		guid(guid), pending(expectedResults) { }
+
+	// Makes the batch visible to the loaders running on this thread until the scope ends
+	class Scope {
+	public:
+		explicit Scope(const PlayerLoadBatch &batch) :
+			previous(active) {
+			active = &batch;
+		}
+
+		~Scope() {
+			active = previous;
+		}
+
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+
+	private:
+		const PlayerLoadBatch* previous;
+	};
+
+	static const PlayerLoadBatch* getActive() {
+		return active;
+	}
+
+	uint32_t getGuid() const {
+		return guid;
+	}
+
+	// Returns true for the last result the batch was waiting for
+	bool setResult(PlayerLoadQuery query, DBResult_ptr result) {
+		results[static_cast<size_t>(query)] = std::move(result);
+		return pending.fetch_sub(1, std::memory_order_acq_rel) == 1;
+	}
+
+	// Nullptr if the query was not fetched, a null result means it returned no rows
+	const DBResult_ptr* getResult(PlayerLoadQuery query) const {
+		const auto &result = results[static_cast<size_t>(query)];
+		return result ? &*result : nullptr;
+	}
+
+private:
+	inline static thread_local const PlayerLoadBatch* active = nullptr;
+
+	uint32_t guid;
+	std::atomic<size_t> pending;
+	std::array<std::optional<DBResult_ptr>, magic_enum::enum_count<PlayerLoadQuery>()> results;
+};
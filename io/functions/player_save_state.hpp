@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+enum class PlayerSaveSection : uint8_t {
+	Stash,
+	Spells,
+	Kills,
+	Bestiary,
+	Items,
+	DepotItems,
+	RewardItems,
+	InboxItems,
+	Prey,
+	TaskHunting,
+	ForgeHistory,
+	Bosstiary,
+	Storage,
+};
+
+/**
+ * Digests of the rows the last committed save wrote for every section of a player, keyed by row
+ * (item sid, storage key, prey slot, or 0 for sections saved as a whole). A save stages new digests
+ * while it runs and they only replace the committed ones once it succeeds. A failed save forgets
+ * everything, so the next one rewrites every section from scratch.
+ */
+class PlayerSaveState {
+public:
+	using RowDigests = phmap::flat_hash_map<int64_t, uint64_t>;
+
+	void begin() {
+		staged = {};
+		rowsWritten = 0;
+		sectionsSkipped = 0;
+	}
+
+	void commit() {
+		for (size_t i = 0; i < SECTIONS; ++i) {
+			if (staged[i]) {
+				committed[i] = std::move(staged[i]);
+			}
+		}
+		staged = {};
+	}
+
+	void invalidate() {
+		committed = {};
+		staged = {};
+	}
+
+	// Nullptr while the section has no committed save
+	const RowDigests* getCommitted(PlayerSaveSection section) const {
+		const auto &rows = committed[static_cast<size_t>(section)];
+		return rows ? &*rows : nullptr;
+	}
+
+	RowDigests &stage(PlayerSaveSection section) {
+		auto &rows = staged[static_cast<size_t>(section)];
+		if (!rows) {
+			rows.emplace();
+		}
+		return *rows;
+	}
+
+	void addRowsWritten(size_t rows) {
+		rowsWritten += static_cast<uint32_t>(rows);
+	}
+
+	void addSectionSkipped() {
+		++sectionsSkipped;
+	}
+
+	uint32_t getRowsWritten() const {
+		return rowsWritten;
+	}
+
+	uint32_t getSectionsSkipped() const {
+		return sectionsSkipped;
+	}
+
+private:
+	static constexpr size_t SECTIONS = magic_enum::enum_count<PlayerSaveSection>();
+
+	std::array<std::optional<RowDigests>, SECTIONS> committed;
+	std::array<std::optional<RowDigests>, SECTIONS> staged;
+	uint32_t rowsWritten = 0;
+	uint32_t sectionsSkipped = 0;
+};
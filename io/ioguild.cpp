@@ -69,7 +69,10 @@ void IOGuild::getWarList(uint32_t guildId, GuildWarVector &guildWarVector) {
 	std::ostringstream query;
 	query << "SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = " << guildId << " OR `guild2` = " << guildId << ") AND `status` = 1";
 
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
+	getWarList(guildId, guildWarVector, Database::getInstance().storeQuery(query.str()));
+}
+
+void IOGuild::getWarList(uint32_t guildId, GuildWarVector &guildWarVector, DBResult_ptr result) {
 	if (!result) {
 		return;
 	}
@@ -18,6 +18,8 @@
 #pragma once
 
 class Guild;
+class DBResult;
+using DBResult_ptr = std::shared_ptr<DBResult>;
 using GuildWarVector = std::vector<uint32_t>;
 
 class IOGuild {
@@ -26,4 +28,6 @@ public:
 	static void saveGuild(const std::shared_ptr<Guild> &guild);
 	static uint32_t getGuildIdByName(const std::string &name);
 	static void getWarList(uint32_t guildId, GuildWarVector &guildWarVector);
+	// Reads the `guild1`, `guild2` rows of active wars already fetched for the guild
+	static void getWarList(uint32_t guildId, GuildWarVector &guildWarVector, DBResult_ptr result);
 };
@@ -20,9 +20,12 @@
 #include "account/account.hpp"
 #include "config/configmanager.hpp"
 #include "database/database.hpp"
+#include "database/databasetasks.hpp"
 #include "io/functions/iologindata_load_player.hpp"
 #include "io/functions/iologindata_save_player.hpp"
 #include "game/game.hpp"
+#include "game/scheduling/dispatcher.hpp"
+#include "game/scheduling/save_manager.hpp"
 #include "creatures/monsters/monster.hpp"
 #include "creatures/players/wheel/player_wheel.hpp"
 #include "creatures/players/player.hpp"
@@ -101,6 +104,48 @@ bool IOLoginData::loadPlayerByName(const std::shared_ptr<Player> &player, const
 	return loadPlayer(player, db.storeQuery(query.str()), disableIrrelevantInfo);
 }
 
+void IOLoginData::loadPlayerAsync(const std::shared_ptr<Player> &player, bool disableIrrelevantInfo, std::function<void(bool)> &&callback) {
+	fetchPlayerAsync(player, disableIrrelevantInfo, std::move(callback), 0);
+}
+
+void IOLoginData::fetchPlayerAsync(const std::shared_ptr<Player> &player, bool disableIrrelevantInfo, std::function<void(bool)> &&callback, uint8_t attempt) {
+	// The rows come from several connections, a save committing in between would tear them
+	static constexpr uint8_t MAX_FETCH_ATTEMPTS = 3;
+
+	const auto guid = player->getGUID();
+	g_saveManager().afterPendingSaves(guid, [player, guid, disableIrrelevantInfo, callback = std::move(callback), attempt](uint64_t saveStarts) mutable {
+		const auto queries = IOLoginDataLoad::getBatchQueries(disableIrrelevantInfo);
+		auto batch = std::make_shared<PlayerLoadBatch>(guid, queries.size());
+		auto onFetched = std::make_shared<std::function<void()>>([player, guid, batch, disableIrrelevantInfo, callback = std::move(callback), attempt, saveStarts]() mutable {
+			if (!g_saveManager().finishLoad(guid, saveStarts)) {
+				if (attempt + 1 < MAX_FETCH_ATTEMPTS) {
+					g_logger().debug("[IOLoginData::loadPlayerAsync] - Player {} was saved while loading, reading again", guid);
+					fetchPlayerAsync(player, disableIrrelevantInfo, std::move(callback), attempt + 1);
+					return;
+				}
+
+				g_logger().warn("[IOLoginData::loadPlayerAsync] - Player {} kept being saved while loading, giving up", guid);
+				callback(false);
+				return;
+			}
+
+			PlayerLoadBatch::Scope scope(*batch);
+			callback(loadPlayer(player, IOLoginDataLoad::storeLoadQuery(player, PlayerLoadQuery::Player), disableIrrelevantInfo));
+		});
+
+		for (const auto query : queries) {
+			g_databaseTasks().run(
+				[batch, onFetched, query, statement = IOLoginDataLoad::getLoadQuery(query, guid, player->getAccountId())] {
+					if (batch->setResult(query, g_database().storeQuery(statement))) {
+						g_dispatcher().addEvent([onFetched] { (*onFetched)(); }, "IOLoginData::loadPlayerAsync");
+					}
+				},
+				DatabasePriority::Login
+			);
+		}
+	});
+}
+
 bool IOLoginData::loadPlayer(const std::shared_ptr<Player> &player, const DBResult_ptr &result, bool disableIrrelevantInfo /* = false*/) {
 	if (!result || !player) {
 		std::string nullptrType = !result ? "Result" : "Player";
@@ -199,20 +244,37 @@ bool IOLoginData::loadPlayer(const std::shared_ptr<Player> &player, const DBResu
 }
 
 bool IOLoginData::savePlayer(const std::shared_ptr<Player> &player) {
+	if (player) {
+		player->saveState.begin();
+	}
+
 	try {
-		bool success = DBTransaction::executeWithinTransaction([player]() {
-			return savePlayerGuard(player);
+		// Without pinned transactions a failing body still makes executeWithinTransaction return true,
+		// the digests may only be committed when every section was written
+		bool saved = false;
+		bool success = DBTransaction::executeWithinTransaction([player, &saved]() {
+			saved = savePlayerGuard(player);
+			return saved;
 		});
 
-		if (!success) {
+		if (!success || !saved) {
 			g_logger().error("[{}] Error occurred saving player", __FUNCTION__);
+			player->saveState.invalidate();
+			return false;
 		}
 
-		return success;
+		// Only now does the database hold what the staged digests describe
+		player->saveState.commit();
+		g_metrics().addCounter("player_save_rows_written", player->saveState.getRowsWritten());
+		g_metrics().addCounter("player_save_sections_skipped", player->saveState.getSectionsSkipped());
+		return true;
 	} catch (const DatabaseException &e) {
 		g_logger().error("[{}] Exception occurred: {}", __FUNCTION__, e.what());
 	}
 
+	if (player) {
+		player->saveState.invalidate();
+	}
 	return false;
 }
 
@@ -33,6 +33,12 @@ public:
 	static bool loadPlayerById(const std::shared_ptr<Player> &player, uint32_t id, bool disableIrrelevantInfo = true);
 	static bool loadPlayerByName(const std::shared_ptr<Player> &player, const std::string &name, bool disableIrrelevantInfo = true);
 	static bool loadPlayer(const std::shared_ptr<Player> &player, const std::shared_ptr<DBResult> &result, bool disableIrrelevantInfo = false);
+	/**
+	 * Fetches the player's rows concurrently on the database threads, then loads it on the dispatcher
+	 * and calls back there with whether it succeeded. The player must be preloaded (guid and account).
+	 * Waits for pending saves of the player first and reads again when one started meanwhile.
+	 */
+	static void loadPlayerAsync(const std::shared_ptr<Player> &player, bool disableIrrelevantInfo, std::function<void(bool)> &&callback);
 	static bool savePlayer(const std::shared_ptr<Player> &player);
 	static uint32_t getGuidByName(const std::string &name);
 	static bool getGuidByNameEx(uint32_t &guid, bool &specialVip, std::string &name);
@@ -55,4 +61,5 @@ public:
 
 private:
 	static bool savePlayerGuard(const std::shared_ptr<Player> &player);
+	static void fetchPlayerAsync(const std::shared_ptr<Player> &player, bool disableIrrelevantInfo, std::function<void(bool)> &&callback, uint8_t attempt);
 };
@@ -26,8 +26,10 @@
 #include "items/containers/inbox/inbox.hpp"
 #include "creatures/players/player.hpp"
 
-uint8_t IOMarket::getTierFromDatabaseTable(const std::string &string) {
-	auto tier = static_cast<uint8_t>(std::atoi(string.c_str()));
+uint8_t IOMarket::getTierFromDatabaseTable(std::string_view string) {
+	int32_t value = 0;
+	std::from_chars(string.data(), string.data() + string.size(), value);
+	auto tier = static_cast<uint8_t>(value);
 	if (tier > g_configManager().getNumber(FORGE_MAX_ITEM_TIER)) {
 		g_logger().error("{} - Failed to get number value {} for tier table result", __FUNCTION__, tier);
 		return 0;
@@ -52,22 +54,30 @@ MarketOfferList IOMarket::getActiveOffers(MarketAction_t action) {
 	}
 
 	const int32_t marketOfferDuration = g_configManager().getNumber(MARKET_OFFER_DURATION);
-
-	do {
+	const auto idColumn = result->getColumn("id");
+	const auto itemTypeColumn = result->getColumn("itemtype");
+	const auto amountColumn = result->getColumn("amount");
+	const auto priceColumn = result->getColumn("price");
+	const auto tierColumn = result->getColumn("tier");
+	const auto createdColumn = result->getColumn("created");
+	const auto anonymousColumn = result->getColumn("anonymous");
+	const auto playerNameColumn = result->getColumn("player_name");
+
+	result->forEachRow([&](const DBResult &row) {
 		MarketOffer offer;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
+		offer.itemId = row.getNumber<uint16_t>(itemTypeColumn);
+		offer.amount = row.getNumber<uint16_t>(amountColumn);
+		offer.price = row.getNumber<uint64_t>(priceColumn);
+		offer.timestamp = row.getNumber<uint32_t>(createdColumn) + marketOfferDuration;
+		offer.counter = row.getNumber<uint32_t>(idColumn) & 0xFFFF;
+		if (row.getNumber<uint16_t>(anonymousColumn) == 0) {
+			offer.playerName = row.getString(playerNameColumn);
 		} else {
 			offer.playerName = "Anonymous";
 		}
-		offer.tier = getTierFromDatabaseTable(result->getString("tier"));
+		offer.tier = getTierFromDatabaseTable(row.getStringView(tierColumn));
 		offerList.push_back(offer);
-	} while (result->next());
+	});
 	return offerList;
 }
 
@@ -83,22 +93,29 @@ MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId
 	}
 
 	const int32_t marketOfferDuration = g_configManager().getNumber(MARKET_OFFER_DURATION);
-
-	do {
+	const auto idColumn = result->getColumn("id");
+	const auto amountColumn = result->getColumn("amount");
+	const auto priceColumn = result->getColumn("price");
+	const auto tierColumn = result->getColumn("tier");
+	const auto createdColumn = result->getColumn("created");
+	const auto anonymousColumn = result->getColumn("anonymous");
+	const auto playerNameColumn = result->getColumn("player_name");
+
+	result->forEachRow([&](const DBResult &row) {
 		MarketOffer offer;
 		offer.itemId = itemId;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
+		offer.amount = row.getNumber<uint16_t>(amountColumn);
+		offer.price = row.getNumber<uint64_t>(priceColumn);
+		offer.timestamp = row.getNumber<uint32_t>(createdColumn) + marketOfferDuration;
+		offer.counter = row.getNumber<uint32_t>(idColumn) & 0xFFFF;
+		if (row.getNumber<uint16_t>(anonymousColumn) == 0) {
+			offer.playerName = row.getString(playerNameColumn);
 		} else {
 			offer.playerName = "Anonymous";
 		}
-		offer.tier = getTierFromDatabaseTable(result->getString("tier"));
+		offer.tier = getTierFromDatabaseTable(row.getStringView(tierColumn));
 		offerList.push_back(offer);
-	} while (result->next());
+	});
 	return offerList;
 }
 
@@ -115,16 +132,23 @@ MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId)
 		return offerList;
 	}
 
-	do {
+	const auto idColumn = result->getColumn("id");
+	const auto amountColumn = result->getColumn("amount");
+	const auto priceColumn = result->getColumn("price");
+	const auto createdColumn = result->getColumn("created");
+	const auto itemTypeColumn = result->getColumn("itemtype");
+	const auto tierColumn = result->getColumn("tier");
+
+	result->forEachRow([&](const DBResult &row) {
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.tier = getTierFromDatabaseTable(result->getString("tier"));
+		offer.amount = row.getNumber<uint16_t>(amountColumn);
+		offer.price = row.getNumber<uint64_t>(priceColumn);
+		offer.timestamp = row.getNumber<uint32_t>(createdColumn) + marketOfferDuration;
+		offer.counter = row.getNumber<uint32_t>(idColumn) & 0xFFFF;
+		offer.itemId = row.getNumber<uint16_t>(itemTypeColumn);
+		offer.tier = getTierFromDatabaseTable(row.getStringView(tierColumn));
 		offerList.push_back(offer);
-	} while (result->next());
+	});
 	return offerList;
 }
 
@@ -139,15 +163,22 @@ HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t p
 		return offerList;
 	}
 
-	do {
+	const auto itemTypeColumn = result->getColumn("itemtype");
+	const auto amountColumn = result->getColumn("amount");
+	const auto priceColumn = result->getColumn("price");
+	const auto expiresAtColumn = result->getColumn("expires_at");
+	const auto stateColumn = result->getColumn("state");
+	const auto tierColumn = result->getColumn("tier");
+
+	result->forEachRow([&](const DBResult &row) {
 		HistoryMarketOffer offer {};
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("expires_at");
-		offer.tier = getTierFromDatabaseTable(result->getString("tier"));
+		offer.itemId = row.getNumber<uint16_t>(itemTypeColumn);
+		offer.amount = row.getNumber<uint16_t>(amountColumn);
+		offer.price = row.getNumber<uint64_t>(priceColumn);
+		offer.timestamp = row.getNumber<uint32_t>(expiresAtColumn);
+		offer.tier = getTierFromDatabaseTable(row.getStringView(tierColumn));
 
-		MarketOfferState_t offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
+		MarketOfferState_t offerState = static_cast<MarketOfferState_t>(row.getNumber<uint16_t>(stateColumn));
 		if (offerState == OFFERSTATE_ACCEPTEDEX) {
 			offerState = OFFERSTATE_ACCEPTED;
 		}
@@ -155,7 +186,7 @@ HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t p
 		offer.state = offerState;
 
 		offerList.push_back(offer);
-	} while (result->next());
+	});
 	return offerList;
 }
 
@@ -295,30 +326,29 @@ MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter)
 	return offer;
 }
 
-void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price, uint8_t tier, bool anonymous) {
-	std::ostringstream query;
-	query << "INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `created`, `anonymous`, `price`, `tier`) VALUES (" << playerId << ',' << action << ',' << itemId << ',' << amount << ',' << getTimeNow() << ',' << anonymous << ',' << price << ',' << std::to_string(tier) << ')';
-	Database::getInstance().executeQuery(query.str());
+bool IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price, uint8_t tier, bool anonymous) {
+	return g_database().executePrepared(
+		"INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `created`, `anonymous`, `price`, `tier`) VALUES (?, ?, ?, ?, ?, ?, ?, ?)",
+		{ playerId, action, itemId, amount, getTimeNow(), anonymous, price, tier }
+	);
 }
 
-void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount) {
-	std::ostringstream query;
-	query << "UPDATE `market_offers` SET `amount` = `amount` - " << amount << " WHERE `id` = " << offerId;
-	Database::getInstance().executeQuery(query.str());
+bool IOMarket::acceptOffer(uint32_t offerId, uint16_t amount) {
+	return g_database().executePrepared("UPDATE `market_offers` SET `amount` = `amount` - ? WHERE `id` = ?", { amount, offerId });
 }
 
-void IOMarket::deleteOffer(uint32_t offerId) {
-	std::ostringstream query;
-	query << "DELETE FROM `market_offers` WHERE `id` = " << offerId;
-	Database::getInstance().executeQuery(query.str());
+bool IOMarket::deleteOffer(uint32_t offerId) {
+	return g_database().executePrepared("DELETE FROM `market_offers` WHERE `id` = ?", { offerId });
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint64_t price, time_t timestamp, uint8_t tier, MarketOfferState_t state) {
-	std::ostringstream query;
-	query << "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`, `tier`) VALUES ("
-		  << playerId << ',' << type << ',' << itemId << ',' << amount << ',' << price << ','
-		  << timestamp << ',' << getTimeNow() << ',' << state << ',' << std::to_string(tier) << ')';
-	g_databaseTasks().execute(query.str());
+	const auto inserted = getTimeNow();
+	g_databaseTasks().run([=] {
+		g_database().executePrepared(
+			"INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`, `tier`) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+			{ playerId, type, itemId, amount, price, timestamp, inserted, state, tier }
+		);
+	});
 }
 
 bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state) {
@@ -332,9 +362,7 @@ bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state) {
 		return false;
 	}
 
-	query.str(std::string());
-	query << "DELETE FROM `market_offers` WHERE `id` = " << offerId;
-	if (!db.executeQuery(query.str())) {
+	if (!db.executePrepared("DELETE FROM `market_offers` WHERE `id` = ?", { offerId })) {
 		return false;
 	}
 
@@ -40,9 +40,9 @@ public:
 	static uint32_t getPlayerOfferCount(uint32_t playerId);
 	static MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter);
 
-	static void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price, uint8_t tier, bool anonymous);
-	static void acceptOffer(uint32_t offerId, uint16_t amount);
-	static void deleteOffer(uint32_t offerId);
+	static bool createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price, uint8_t tier, bool anonymous);
+	static bool acceptOffer(uint32_t offerId, uint16_t amount);
+	static bool deleteOffer(uint32_t offerId);
 
 	static void appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint64_t price, time_t timestamp, uint8_t tier, MarketOfferState_t state);
 	static bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state);
@@ -57,7 +57,7 @@ public:
 		return saleStatistics;
 	}
 
-	static uint8_t getTierFromDatabaseTable(const std::string &string);
+	static uint8_t getTierFromDatabaseTable(std::string_view string);
 
 private:
 	// [uint16_t = item id, [uint8_t = item tier, MarketStatistics = structure of the statistics]]
@@ -350,9 +350,7 @@ Item::Item(const uint16_t itemId, uint16_t itemCount /*= 0*/) :
 
 Item::Item(const std::shared_ptr<Item> &i) :
 	Thing(), id(i->id), count(i->count), loadedFromMap(i->loadedFromMap) {
-	if (i->attributePtr) {
-		attributePtr = std::make_unique<ItemAttribute>(*i->attributePtr);
-	}
+	copyAttributes(*i);
 }
 
 std::shared_ptr<Item> Item::clone() const {
@@ -362,8 +360,8 @@ std::shared_ptr<Item> Item::clone() const {
 		return nullptr;
 	}
 
-	if (attributePtr) {
-		item->attributePtr = std::make_unique<ItemAttribute>(*attributePtr);
+	if (hasAttributeStorage()) {
+		item->copyAttributes(*this);
 	}
 
 	return item;
@@ -386,21 +384,25 @@ bool Item::equals(const std::shared_ptr<Item> &compareItem) const {
 		return false;
 	}
 
+	for (const auto type : { ItemAttribute_t::CHARGES, ItemAttribute_t::ACTIONID, ItemAttribute_t::DURATION, ItemAttribute_t::DECAYSTATE }) {
+		if (hasAttribute(type) && compareItem->hasAttribute(type) && getInteger(type) != compareItem->getInteger(type)) {
+			return false;
+		}
+	}
+
 	for (const auto &attribute : getAttributeVector()) {
-		if (attribute.getAttributeType() == ItemAttribute_t::STORE) {
+		const auto type = attribute.getAttributeType();
+		if (type == ItemAttribute_t::STORE || !compareItem->hasAttribute(type)) {
 			continue;
 		}
 
-		for (const auto &compareAttribute : compareItem->getAttributeVector()) {
-			if (attribute.getAttributeType() != compareAttribute.getAttributeType()) {
-				continue;
-			}
-
-			if (isAttributeInteger(attribute.getAttributeType()) && attribute.getInteger() != compareAttribute.getInteger()) {
-				return false;
-			}
+		if (isAttributeInteger(type) && attribute.getInteger() != compareItem->getInteger(type)) {
+			return false;
+		}
 
-			if (isAttributeString(attribute.getAttributeType()) && attribute.getString() != compareAttribute.getString()) {
+		if (isAttributeString(type)) {
+			const auto* compareAttribute = compareItem->attributePtr->getAttribute(type);
+			if (compareAttribute && attribute.getString() != compareAttribute->getString()) {
 				return false;
 			}
 		}
@@ -3481,22 +3483,20 @@ std::shared_ptr<Item> Item::transform(uint16_t itemId, uint16_t itemCount /*= -1
 }
 
 bool Item::hasMarketAttributes() const {
-	if (!isInitializedAttributePtr()) {
+	if (!hasAttributeStorage()) {
 		return true;
 	}
 
-	for (const auto &attribute : getAttributeVector()) {
-		if (attribute.getAttributeType() == ItemAttribute_t::CHARGES && static_cast<uint16_t>(attribute.getInteger()) != items[id].charges) {
-			return false;
-		}
+	if (hasAttribute(ItemAttribute_t::CHARGES) && static_cast<uint16_t>(getInteger(ItemAttribute_t::CHARGES)) != items[id].charges) {
+		return false;
+	}
 
-		if (attribute.getAttributeType() == ItemAttribute_t::DURATION && static_cast<uint32_t>(attribute.getInteger()) != getDefaultDuration()) {
-			return false;
-		}
+	if (hasAttribute(ItemAttribute_t::DURATION) && static_cast<uint32_t>(getInteger(ItemAttribute_t::DURATION)) != getDefaultDuration()) {
+		return false;
+	}
 
-		if (attribute.getAttributeType() == ItemAttribute_t::TIER && static_cast<uint8_t>(attribute.getInteger()) != getTier()) {
-			return false;
-		}
+	if (hasAttribute(ItemAttribute_t::TIER) && static_cast<uint8_t>(getInteger(ItemAttribute_t::TIER)) != getTier()) {
+		return false;
 	}
 
 	return !hasImbuements() && !isStoreItem() && !hasOwner();
@@ -3545,6 +3545,95 @@ const std::map<std::string, CustomAttribute, std::less<>> &ItemProperties::getCu
 	return attributePtr->getCustomAttributeMap();
 }
 
+void ItemProperties::removeAttribute(ItemAttribute_t type) {
+	if (!hasAttribute(type)) {
+		return;
+	}
+
+	attributeBits &= ~attributeBit(type);
+	const auto slot = getInlineSlot(type);
+	if (slot != NO_INLINE_SLOT && (attributeBits & inlineBit(slot)) != 0) {
+		attributeBits &= ~inlineBit(slot);
+		setInlineValue(slot, 0);
+		return;
+	}
+
+	attributePtr->removeAttribute(type);
+}
+
+void ItemProperties::setIntegerAttribute(ItemAttribute_t type, int64_t value) {
+	if (!isAttributeInteger(type)) {
+		return;
+	}
+
+	const auto slot = getInlineSlot(type);
+	if (slot != NO_INLINE_SLOT && setInlineValue(slot, value)) {
+		if ((attributeBits & inlineBit(slot)) == 0 && hasAttribute(type)) {
+			attributePtr->removeAttribute(type);
+		}
+		attributeBits |= attributeBit(type) | inlineBit(slot);
+		return;
+	}
+
+	// Does not fit the inline slot (or has none), the out of line copy becomes the live one
+	if (slot != NO_INLINE_SLOT) {
+		attributeBits &= ~inlineBit(slot);
+	}
+	initAttributePtr()->setAttribute(type, value);
+	attributeBits |= attributeBit(type);
+}
+
+void ItemProperties::setStringAttribute(ItemAttribute_t type, const std::string &value) {
+	if (!isAttributeString(type) || value.empty()) {
+		return;
+	}
+
+	initAttributePtr()->setAttribute(type, value);
+	attributeBits |= attributeBit(type);
+}
+
+int64_t ItemProperties::getInlineValue(int8_t slot) const {
+	switch (slot) {
+		case 0:
+			return inlineAttributes.charges;
+		case 1:
+			return inlineAttributes.actionId;
+		case 2:
+			return inlineAttributes.duration;
+		default:
+			return static_cast<int64_t>(attributeBits >> DECAY_SHIFT);
+	}
+}
+
+bool ItemProperties::setInlineValue(int8_t slot, int64_t value) {
+	switch (slot) {
+		case 0:
+			if (value < 0 || value > std::numeric_limits<uint16_t>::max()) {
+				return false;
+			}
+			inlineAttributes.charges = static_cast<uint16_t>(value);
+			return true;
+		case 1:
+			if (value < 0 || value > std::numeric_limits<uint16_t>::max()) {
+				return false;
+			}
+			inlineAttributes.actionId = static_cast<uint16_t>(value);
+			return true;
+		case 2:
+			if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max()) {
+				return false;
+			}
+			inlineAttributes.duration = static_cast<int32_t>(value);
+			return true;
+		default:
+			if (value < 0 || value > std::numeric_limits<uint8_t>::max()) {
+				return false;
+			}
+			attributeBits = (attributeBits & ~(uint64_t { 0xFF } << DECAY_SHIFT)) | (static_cast<uint64_t>(value) << DECAY_SHIFT);
+			return true;
+	}
+}
+
 int32_t ItemProperties::getDuration() const {
 	ItemDecayState_t decayState = getDecaying();
 	if (decayState == DECAYING_TRUE || decayState == DECAYING_STOPPING) {
@@ -37,7 +37,7 @@ class Imbuement;
 class Item;
 class Cylinder;
 
-// This class ItemProperties that serves as an interface to access and modify attributes of an item. The item's attributes are stored in an instance of ItemAttribute. The class ItemProperties has methods to get and set integer and string attributes, check if an attribute exists, remove an attribute, get the underlying attribute bits, and get a vector of attributes. It also has methods to get and set custom attributes, which are stored in a std::map<std::string, CustomAttribute, std::less<>>. The class has a data member attributePtr of type std::unique_ptr<ItemAttribute> that stores a pointer to the item's attributes methods.
+// This class ItemProperties that serves as an interface to access and modify attributes of an item. The item's attributes are stored in an instance of ItemAttribute. The class ItemProperties has methods to get and set integer and string attributes, check if an attribute exists, remove an attribute, get the underlying attribute bits, and get a vector of attributes. It also has methods to get and set custom attributes, which are stored in a std::map<std::string, CustomAttribute, std::less<>>. Presence of every attribute is a bit in attributeBits and the most common integers are stored inline, the data member attributePtr of type std::unique_ptr<ItemAttribute> is only allocated for the rest.
 class ItemProperties {
 public:
 	template <typename T>
@@ -56,29 +56,25 @@ public:
 	}
 
 	bool hasAttribute(ItemAttribute_t type) const {
-		if (!attributePtr) {
-			return false;
-		}
-
-		return attributePtr->hasAttribute(type);
-	}
-	void removeAttribute(ItemAttribute_t type) const {
-		if (attributePtr) {
-			attributePtr->removeAttribute(type);
-		}
+		return (attributeBits & attributeBit(type)) != 0;
 	}
+	void removeAttribute(ItemAttribute_t type);
 
 	template <typename GenericAttribute>
 	void setAttribute(ItemAttribute_t type, GenericAttribute genericAttribute) {
-		initAttributePtr()->setAttribute(type, genericAttribute);
+		if constexpr (std::is_convertible_v<GenericAttribute, std::string>) {
+			setStringAttribute(type, genericAttribute);
+		} else {
+			setIntegerAttribute(type, static_cast<int64_t>(genericAttribute));
+		}
 	}
 
 	bool isAttributeInteger(ItemAttribute_t type) const {
-		return initAttributePtr()->isAttributeInteger(type);
+		return ItemAttributeHelper::isAttributeInteger(type);
 	}
 
 	bool isAttributeString(ItemAttribute_t type) const {
-		return initAttributePtr()->isAttributeString(type);
+		return ItemAttributeHelper::isAttributeString(type);
 	}
 
 	// Custom Attributes
@@ -169,6 +165,7 @@ protected:
 		return attributePtr;
 	}
 
+	// Only the attributes stored out of line, the inline ones are not in it
 	const std::vector<Attributes> &getAttributeVector() const {
 		static std::vector<Attributes> emptyVector = {};
 		if (!attributePtr) {
@@ -178,33 +175,88 @@ protected:
 		return attributePtr->getAttributeVector();
 	}
 
-	const int64_t &getInteger(ItemAttribute_t type) const {
-		static int64_t emptyInt;
-		if (!attributePtr) {
-			return emptyInt;
+	int64_t getInteger(ItemAttribute_t type) const {
+		if (!hasAttribute(type)) {
+			return 0;
 		}
 
+		const auto slot = getInlineSlot(type);
+		if (slot != NO_INLINE_SLOT && (attributeBits & inlineBit(slot)) != 0) {
+			return getInlineValue(slot);
+		}
 		return attributePtr->getAttributeValue(type);
 	}
 	const std::string &getString(ItemAttribute_t type) const {
 		static std::string emptyString;
-		if (!attributePtr) {
+		if (!hasAttribute(type)) {
 			return emptyString;
 		}
 
 		return attributePtr->getAttributeString(type);
 	}
 
-	bool isInitializedAttributePtr() const {
-		if (!attributePtr) {
-			return false;
-		}
+	bool hasAttributeStorage() const {
+		return attributeBits != 0 || attributePtr;
+	}
 
-		return true;
+	void copyAttributes(const ItemProperties &other) {
+		attributeBits = other.attributeBits;
+		inlineAttributes = other.inlineAttributes;
+		attributePtr = other.attributePtr ? std::make_unique<ItemAttribute>(*other.attributePtr) : nullptr;
 	}
 
 private:
+	/**
+	 * Charges, action id, duration and decay state are set on most items that have attributes at
+	 * all, they live in the item itself when the value fits the slot. Everything else (strings,
+	 * custom attributes, rare or oversized integers) goes to the lazily allocated ItemAttribute.
+	 *
+	 * attributeBits layout: bit N is set when ItemAttribute_t N is present, bits INLINE_SHIFT + slot
+	 * tell that the value of that inline slot is the live one and bits DECAY_SHIFT.. hold the decay state.
+	 */
+	struct InlineAttributes {
+		int32_t duration = 0;
+		uint16_t charges = 0;
+		uint16_t actionId = 0;
+	};
+
+	static constexpr int8_t NO_INLINE_SLOT = -1;
+	static constexpr uint8_t INLINE_SHIFT = 48;
+	static constexpr uint8_t DECAY_SHIFT = 56;
+	static_assert(static_cast<uint64_t>(ItemAttribute_t::AUGMENTS) < INLINE_SHIFT, "Item attribute types must fit below the inline flags");
+
+	static uint64_t attributeBit(ItemAttribute_t type) {
+		return static_cast<uint64_t>(type) < INLINE_SHIFT ? uint64_t { 1 } << static_cast<uint64_t>(type) : 0;
+	}
+
+	static uint64_t inlineBit(int8_t slot) {
+		return uint64_t { 1 } << (INLINE_SHIFT + slot);
+	}
+
+	static int8_t getInlineSlot(ItemAttribute_t type) {
+		switch (type) {
+			case ItemAttribute_t::CHARGES:
+				return 0;
+			case ItemAttribute_t::ACTIONID:
+				return 1;
+			case ItemAttribute_t::DURATION:
+				return 2;
+			case ItemAttribute_t::DECAYSTATE:
+				return 3;
+			default:
+				return NO_INLINE_SLOT;
+		}
+	}
+
+	int64_t getInlineValue(int8_t slot) const;
+	bool setInlineValue(int8_t slot, int64_t value);
+
+	void setIntegerAttribute(ItemAttribute_t type, int64_t value);
+	void setStringAttribute(ItemAttribute_t type, const std::string &value);
+
 	std::unique_ptr<ItemAttribute> attributePtr;
+	uint64_t attributeBits = 0;
+	InlineAttributes inlineAttributes;
 
 	friend class Item;
 };
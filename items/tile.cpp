@@ -98,6 +98,10 @@ bool Tile::hasFlag(uint32_t flag) const {
 	return hasBitSet(flag, this->flags);
 }
 
+void Tile::invalidateWalkCache() const {
+	g_game().map.invalidateWalkCache(tilePos);
+}
+
 bool Tile::hasHeight(uint32_t n) const {
 	uint32_t height = 0;
 
@@ -377,6 +381,8 @@ std::shared_ptr<Thing> Tile::getTopVisibleThing(const std::shared_ptr<Creature>
 }
 
 void Tile::onAddTileItem(const std::shared_ptr<Item> &item) {
+	invalidateItemsEncoding();
+
 	if (!item) {
 		g_logger().error("Tile::onAddTileItem: item is nullptr");
 		return;
@@ -455,6 +461,8 @@ void Tile::onAddTileItem(const std::shared_ptr<Item> &item) {
 }
 
 void Tile::onUpdateTileItem(const std::shared_ptr<Item> &oldItem, const ItemType &oldType, const std::shared_ptr<Item> &newItem, const ItemType &newType) {
+	invalidateItemsEncoding();
+
 	if (!oldItem || !newItem) {
 		g_logger().error("Tile::onUpdateTileItem: oldItem or newItem is nullptr");
 		return;
@@ -502,6 +510,8 @@ void Tile::onUpdateTileItem(const std::shared_ptr<Item> &oldItem, const ItemType
 }
 
 void Tile::onRemoveTileItem(const CreatureVector &spectators, const std::vector<int32_t> &oldStackPosVector, const std::shared_ptr<Item> &item) {
+	invalidateItemsEncoding();
+
 	if (!item) {
 		g_logger().error("Tile::onRemoveTileItem: item is nullptr");
 		return;
@@ -590,6 +600,8 @@ void Tile::onRemoveTileItem(const CreatureVector &spectators, const std::vector<
 }
 
 void Tile::onUpdateTile(const CreatureVector &spectators) {
+	invalidateItemsEncoding();
+
 	const Position &cylinderMapPos = getPosition();
 
 	// send to clients
@@ -1033,7 +1045,6 @@ void Tile::addThing(int32_t, const std::shared_ptr<Thing> &thing) {
 
 	const auto &creature = thing->getCreature();
 	if (creature) {
-		Spectators::clearCache();
 		creature->setParent(static_self_cast<Tile>());
 
 		CreatureVector* creatures = makeCreatures();
@@ -1253,7 +1264,6 @@ void Tile::removeThing(const std::shared_ptr<Thing> &thing, uint32_t count) {
 		if (creatures) {
 			const auto it = std::ranges::find(*creatures, thing);
 			if (it != creatures->end()) {
-				Spectators::clearCache();
 				creatures->erase(it);
 			}
 		}
@@ -1651,6 +1661,8 @@ void Tile::internalAddThing(uint32_t, const std::shared_ptr<Thing> &thing) {
 	if (!thing) {
 		return;
 	}
+
+	invalidateItemsEncoding();
 	for (const auto &zone : getZones()) {
 		zone->thingAdded(thing);
 	}
@@ -1659,8 +1671,6 @@ void Tile::internalAddThing(uint32_t, const std::shared_ptr<Thing> &thing) {
 
 	const auto &creature = thing->getCreature();
 	if (creature) {
-		Spectators::clearCache();
-
 		CreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
 	} else {
@@ -107,6 +107,18 @@ private:
 	uint32_t downItemCount = 0;
 };
 
+/**
+ * Client encoding of the items of a tile, it is the same for every viewer so it is built once
+ * and copied into each map description (see ProtocolGame::GetTileDescription).
+ */
+struct TileItemsEncoding {
+	std::vector<uint8_t> bytes;
+	// Offset where each encoded item ends: ground and top items first, then down items
+	std::vector<uint16_t> ends;
+	uint8_t topItems = 0; // Including the ground
+	bool valid = false;
+};
+
 class Tile : public Cylinder, public SharedObject {
 public:
 	static const std::shared_ptr<Tile> &nullptr_tile;
@@ -177,12 +189,21 @@ public:
 	bool hasProperty(ItemProperty prop) const;
 	bool hasProperty(const std::shared_ptr<Item> &exclude, ItemProperty prop) const;
 
+	// Flags that the pathfinding walkability cache depends on (see Map::isWalkBlocked)
+	static constexpr uint32_t WALK_CACHE_FLAGS = TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT | TILESTATE_IMMOVABLEBLOCKSOLID | TILESTATE_IMMOVABLENOFIELDBLOCKPATH;
+
 	bool hasFlag(uint32_t flag) const;
 	void setFlag(uint32_t flag) {
 		this->flags |= flag;
+		if ((flag & WALK_CACHE_FLAGS) != 0) {
+			invalidateWalkCache();
+		}
 	}
 	void resetFlag(uint32_t flag) {
 		this->flags &= ~flag;
+		if ((flag & WALK_CACHE_FLAGS) != 0) {
+			invalidateWalkCache();
+		}
 	}
 	void addZone(const std::shared_ptr<Zone> &zone);
 	void clearZones();
@@ -265,6 +286,27 @@ public:
 		if ((ground = item)) {
 			setTileFlags(item);
 		}
+		invalidateItemsEncoding();
+	}
+
+	// Dispatcher thread only, nullptr when the items changed since the last encoding
+	const TileItemsEncoding* getItemsEncoding(bool oldProtocol) const {
+		if (!itemsEncoding || !(*itemsEncoding)[oldProtocol].valid) {
+			return nullptr;
+		}
+		return &(*itemsEncoding)[oldProtocol];
+	}
+	const TileItemsEncoding &setItemsEncoding(bool oldProtocol, TileItemsEncoding &&encoding) {
+		if (!itemsEncoding) {
+			itemsEncoding = std::make_unique<std::array<TileItemsEncoding, 2>>();
+		}
+		auto &cached = (*itemsEncoding)[oldProtocol];
+		cached = std::move(encoding);
+		cached.valid = true;
+		return cached;
+	}
+	void invalidateItemsEncoding() {
+		itemsEncoding.reset();
 	}
 
 	// This method maintains safety in asynchronous calls, avoiding competition between threads.
@@ -278,6 +320,7 @@ private:
 
 	void setTileFlags(const std::shared_ptr<Item> &item);
 	void resetTileFlags(const std::shared_ptr<Item> &item);
+	void invalidateWalkCache() const;
 	bool hasHarmfulField() const;
 	ReturnValue checkNpcCanWalkIntoTile() const;
 
@@ -286,6 +329,8 @@ protected:
 	Position tilePos;
 	uint32_t flags = 0;
 	std::unordered_set<std::shared_ptr<Zone>> zones {};
+	// Indexed by ProtocolGame::oldProtocol
+	std::unique_ptr<std::array<TileItemsEncoding, 2>> itemsEncoding;
 };
 
 // Used for walkable tiles, where there is high likeliness of
@@ -74,19 +74,17 @@ bool KVSQL::save(const std::string &key, const ValueWrapper &value) {
 	return update.execute();
 }
 
-bool KVSQL::prepareSave(const std::string &key, const ValueWrapper &value, DBInsert &update) const {
+bool KVSQL::prepareSave(const std::string &key, const ValueWrapper &value, DBPreparedInsert &update) const {
 	const auto protoValue = ProtoSerializable::toProto(value);
 	std::string data;
 	if (!protoValue.SerializeToString(&data)) {
 		return false;
 	}
 	if (value.isDeleted()) {
-		const auto query = fmt::format("DELETE FROM `kv_store` WHERE `key_name` = {}", db.escapeString(key));
-		return db.executeQuery(query);
+		return db.executePrepared("DELETE FROM `kv_store` WHERE `key_name` = ?", { key });
 	}
 
-	update.addRow(fmt::format("{}, {}, {}", db.escapeString(key), value.getTimestamp(), db.escapeString(data)));
-	return true;
+	return update.addRow({ key, value.getTimestamp(), DBParam::blob(std::move(data)) });
 }
 
 bool KVSQL::saveAll() {
@@ -109,8 +107,8 @@ bool KVSQL::saveAll() {
 	return success;
 }
 
-DBInsert KVSQL::dbUpdate() {
-	auto insert = DBInsert("INSERT INTO `kv_store` (`key_name`, `timestamp`, `value`) VALUES");
+DBPreparedInsert KVSQL::dbUpdate() {
+	auto insert = DBPreparedInsert("INSERT INTO `kv_store` (`key_name`, `timestamp`, `value`) VALUES ", 3);
 	insert.upsert({ "key_name", "timestamp", "value" });
 	return insert;
 }
@@ -21,7 +21,7 @@
 
 class Database;
 class Logger;
-class DBInsert;
+class DBPreparedInsert;
 class ValueWrapper;
 
 class KVSQL final : public KVStore {
@@ -34,9 +34,9 @@ private:
 	std::vector<std::string> loadPrefix(const std::string &prefix = "") override;
 	std::optional<ValueWrapper> load(const std::string &key) override;
 	bool save(const std::string &key, const ValueWrapper &value) override;
-	bool prepareSave(const std::string &key, const ValueWrapper &value, DBInsert &update) const;
+	bool prepareSave(const std::string &key, const ValueWrapper &value, DBPreparedInsert &update) const;
 
-	DBInsert dbUpdate();
+	DBPreparedInsert dbUpdate();
 
 	Database &db;
 };
@@ -91,6 +91,7 @@ namespace metrics {
 	DEFINE_LATENCY_CLASS(query, "query", "truncated_query");
 	DEFINE_LATENCY_CLASS(task, "task", "task");
 	DEFINE_LATENCY_CLASS(lock, "lock", "scope");
+	DEFINE_LATENCY_CLASS(database_queue, "database_queue", "priority");
 
 	const std::vector<std::string> latencyNames {
 		"method_latency",
@@ -98,6 +99,7 @@ namespace metrics {
 		"query_latency",
 		"task_latency",
 		"lock_latency",
+		"database_queue_latency",
 	};
 
 	class Metrics final {
@@ -197,6 +199,7 @@ namespace metrics {
 	DEFINE_LATENCY_CLASS(query, "query", "truncated_query");
 	DEFINE_LATENCY_CLASS(task, "task", "task");
 	DEFINE_LATENCY_CLASS(lock, "lock", "scope");
+	DEFINE_LATENCY_CLASS(database_queue, "database_queue", "priority");
 
 	const std::vector<std::string> latencyNames {
 		"method_latency",
@@ -204,6 +207,7 @@ namespace metrics {
 		"query_latency",
 		"task_latency",
 		"lock_latency",
+		"database_queue_latency",
 	};
 
 	class Metrics final {
@@ -32,16 +32,37 @@ TalkActions &TalkActions::getInstance() {
 
 void TalkActions::clear() {
 	talkActions.clear();
+	talkActionWords.clear();
 }
 
 bool TalkActions::registerLuaEvent(const TalkAction_ptr &talkAction) {
-	auto [iterator, inserted] = talkActions.try_emplace(talkAction->getWords(), talkAction);
-	return inserted;
+	const auto &talkactionWords = talkAction->getWords();
+	auto [iterator, inserted] = talkActions.try_emplace(talkactionWords, talkAction);
+	if (!inserted) {
+		return false;
+	}
+
+	auto addWord = [&](const std::string &word) {
+		auto &entries = talkActionWords.emplace(word);
+		const auto it = std::ranges::upper_bound(entries, talkactionWords, {}, [](const WordEntry &entry) -> const std::string & {
+			return entry.talkAction->getWords();
+		});
+		entries.emplace(it, WordEntry { word, talkAction });
+	};
+
+	if (talkactionWords.find(',') != std::string::npos) {
+		for (const auto &word : split(talkactionWords)) {
+			addWord(word);
+		}
+	} else {
+		addWord(talkactionWords);
+	}
+	return true;
 }
 
 bool TalkActions::checkWord(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &words, std::string_view word, const TalkAction_ptr &talkActionPtr) const {
 	const auto spacePos = std::ranges::find_if(words.begin(), words.end(), ::isspace);
-	const std::string firstWord = words.substr(0, spacePos - words.begin());
+	const std::string_view firstWord(words.data(), spacePos - words.begin());
 
 	// Check for exact equality from saying word and talkaction stored word
 	if (firstWord != word) {
@@ -76,18 +97,18 @@ bool TalkActions::checkWord(const std::shared_ptr<Player> &player, SpeakClasses
 }
 
 TalkActionResult_t TalkActions::checkPlayerCanSayTalkAction(const std::shared_ptr<Player> &player, SpeakClasses type, const std::string &words) const {
-	for (const auto &[talkactionWords, talkActionPtr] : talkActions) {
-		if (talkactionWords.find(',') != std::string::npos) {
-			auto wordsList = split(talkactionWords);
-			for (const auto &word : wordsList) {
-				if (checkWord(player, type, words, word, talkActionPtr)) {
-					return TALKACTION_BREAK;
-				}
-			}
-		} else {
-			if (checkWord(player, type, words, talkactionWords, talkActionPtr)) {
-				return TALKACTION_BREAK;
-			}
+	const auto spacePos = std::ranges::find_if(words.begin(), words.end(), ::isspace);
+	const std::string_view firstWord(words.data(), spacePos - words.begin());
+
+	// The trie is case-folded, talkaction words still have to match exactly
+	const auto* entries = talkActionWords.find(firstWord);
+	if (!entries) {
+		return TALKACTION_CONTINUE;
+	}
+
+	for (const auto &[word, talkActionPtr] : *entries) {
+		if (word == firstWord && checkWord(player, type, words, word, talkActionPtr)) {
+			return TALKACTION_BREAK;
 		}
 	}
 	return TALKACTION_CONTINUE;
@@ -19,6 +19,7 @@
 
 #include "account/account.hpp"
 #include "utils/utils_definitions.hpp"
+#include "utils/word_trie.hpp"
 #include "declarations.hpp"
 
 class Player;
@@ -100,7 +101,14 @@ public:
 	};
 
 private:
+	struct WordEntry {
+		std::string word;
+		TalkAction_ptr talkAction;
+	};
+
 	std::map<std::string, std::shared_ptr<TalkAction>> talkActions;
+	// Every single word of every talkaction, entries kept in talkActions map order
+	WordTrie<std::vector<WordEntry>> talkActionWords;
 };
 
 constexpr auto g_talkActions = TalkActions::getInstance;
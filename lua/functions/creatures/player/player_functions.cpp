@@ -31,6 +31,7 @@
 #include "creatures/players/vip/player_vip.hpp"
 #include "creatures/players/vocations/vocation.hpp"
 #include "creatures/players/wheel/player_wheel.hpp"
+#include "server/network/connection/connection.hpp"
 #include "server/network/protocol/protocolgame.hpp"
 #include "game/game.hpp"
 #include "game/scheduling/save_manager.hpp"
@@ -3460,9 +3461,22 @@ int PlayerFunctions::luaPlayerGetClient(lua_State* L) {
 	// player:getClient()
 	const auto &player = Lua::getUserdataShared<Player>(L, 1);
 	if (player) {
-		lua_createtable(L, 0, 2);
+		lua_createtable(L, 0, 10);
 		Lua::setField(L, "version", player->getProtocolVersion());
 		Lua::setField(L, "os", player->getOperatingSystem());
+		// Socket writes of the last complete second, messages per write show how much each writev batched
+		const auto connection = player->client ? player->client->getConnection() : nullptr;
+		const auto writeStats = connection ? connection->getWriteStats() : Connection::WriteStats {};
+		Lua::setField(L, "bytesSent", writeStats.bytes);
+		Lua::setField(L, "writes", writeStats.writes);
+		Lua::setField(L, "messagesSent", writeStats.messages);
+		// Deflate totals since login, the ratio is compressedBytesOut / compressedBytesIn
+		const auto compressionStats = player->client ? player->client->getCompressionStats() : Protocol::CompressionStats {};
+		Lua::setField(L, "compressedBytesIn", compressionStats.bytesIn);
+		Lua::setField(L, "compressedBytesOut", compressionStats.bytesOut);
+		Lua::setField(L, "compressionCpuUs", compressionStats.cpuNs / 1000);
+		Lua::setField(L, "compressedPackets", compressionStats.compressed);
+		Lua::setField(L, "compressionSkipped", compressionStats.skipped);
 	} else {
 		lua_pushnil(L);
 	}
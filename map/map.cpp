@@ -27,6 +27,7 @@
 #include "lua/callbacks/event_callback.hpp"
 #include "lua/callbacks/events_callbacks.hpp"
 #include "map/spectators.hpp"
+#include "server/network/message/broadcastmessage.hpp"
 #include "utils/astarnodes.hpp"
 
 void Map::load(const std::string &identifier, const Position &pos) {
@@ -187,12 +188,42 @@ std::shared_ptr<Tile> Map::getTile(uint16_t x, uint16_t y, uint8_t z) {
 		return nullptr;
 	}
 
-	const auto &floor = sector->getFloor(z);
+	const auto floor = sector->peekFloor(z);
 	if (!floor) {
 		return nullptr;
 	}
 
-	return getOrCreateTileFromCache(floor, x, y);
+	if (floor->hasTileCache(x, y)) {
+		return getOrCreateTileFromCache(sector->getFloor(z), x, y);
+	}
+
+	// Held until the reference is taken, a replaced tile may otherwise be freed in between
+	MapSector::TileReadGuard guard;
+	const auto tile = floor->peekTile(x, y);
+	return tile ? tile->static_self_cast<Tile>() : nullptr;
+}
+
+Tile* Map::peekTile(uint16_t x, uint16_t y, uint8_t z) {
+	if ((x == 0 && y == 0 && z == 0) || z >= MAP_MAX_LAYERS) {
+		return nullptr;
+	}
+
+	const auto sector = getMapSector(x, y);
+	if (!sector) {
+		return nullptr;
+	}
+
+	const auto floor = sector->peekFloor(z);
+	if (!floor) {
+		return nullptr;
+	}
+
+	if (floor->hasTileCache(x, y)) {
+		// First access creates the tile, the floor keeps owning it
+		return getOrCreateTileFromCache(sector->getFloor(z), x, y).get();
+	}
+
+	return floor->peekTile(x, y);
 }
 
 void Map::refreshZones(uint16_t x, uint16_t y, uint8_t z) {
@@ -366,10 +397,10 @@ void Map::moveCreature(const std::shared_ptr<Creature> &creature, const std::sha
 			++minRangeX;
 		}
 
-		spectators.find<Creature>(oldPos, true, minRangeX, maxRangeX, minRangeY, maxRangeY, false);
+		spectators.find<Creature>(oldPos, true, minRangeX, maxRangeX, minRangeY, maxRangeY);
 	} else {
-		spectators.find<Creature>(oldPos, true, 0, 0, 0, 0, false);
-		spectators.find<Creature>(newPos, true, 0, 0, 0, 0, false);
+		spectators.find<Creature>(oldPos, true);
+		spectators.find<Creature>(newPos, true);
 	}
 
 	const auto playersSpectators = spectators.filter<Player>();
@@ -387,18 +418,20 @@ void Map::moveCreature(const std::shared_ptr<Creature> &creature, const std::sha
 	// remove the creature
 	oldTile->removeThing(creature, 0);
 
+	// add the creature
+	newTile->addThing(creature);
+
 	MapSector* old_sector = getMapSector(oldPos.x, oldPos.y);
 	MapSector* new_sector = getMapSector(newPos.x, newPos.y);
 
-	// Switch the node ownership
+	// Switch the node ownership, the spectator index stores the new position
 	if (old_sector != new_sector) {
 		old_sector->removeCreature(creature);
 		new_sector->addCreature(creature);
+	} else {
+		new_sector->updateCreature(creature);
 	}
 
-	// add the creature
-	newTile->addThing(creature);
-
 	if (!teleport) {
 		if (oldPos.y > newPos.y) {
 			creature->setDirection(DIRECTION_NORTH);
@@ -414,13 +447,14 @@ void Map::moveCreature(const std::shared_ptr<Creature> &creature, const std::sha
 	}
 
 	// send to client
+	BroadcastMessage broadcast;
 	size_t i = 0;
 	for (const auto &spectator : playersSpectators) {
 		// Use the correct stackpos
 		const int32_t stackpos = oldStackPosVector[i++];
 		if (stackpos != -1) {
 			const auto &player = spectator->getPlayer();
-			player->sendCreatureMove(creature, newPos, newTile->getStackposOfCreature(player, creature), oldPos, stackpos, teleport);
+			player->sendCreatureMove(broadcast, creature, newPos, newTile->getStackposOfCreature(player, creature), oldPos, stackpos, teleport);
 		}
 	}
 
@@ -484,6 +518,8 @@ bool Map::checkSightLine(Position start, Position destination) {
 		return true;
 	}
 
+	MapSector::TileReadGuard guard;
+
 	int32_t distanceX = Position::getDistanceX(start, destination);
 	int32_t distanceY = Position::getDistanceY(start, destination);
 
@@ -493,7 +529,7 @@ bool Map::checkSightLine(Position start, Position destination) {
 		while (--distanceX > 0) {
 			start.x += delta;
 
-			const auto &tile = getTile(start.x, start.y, start.z);
+			const auto tile = peekTile(start.x, start.y, start.z);
 			if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
 				return false;
 			}
@@ -504,7 +540,7 @@ bool Map::checkSightLine(Position start, Position destination) {
 		while (--distanceY > 0) {
 			start.y += delta;
 
-			const auto &tile = getTile(start.x, start.y, start.z);
+			const auto tile = peekTile(start.x, start.y, start.z);
 			if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
 				return false;
 			}
@@ -537,7 +573,7 @@ bool Map::checkSightLine(Position start, Position destination) {
 					xIncrease = deltaX;
 				}
 
-				const auto &tile = getTile(start.x + xIncrease, start.y + deltaY, start.z);
+				const auto tile = peekTile(start.x + xIncrease, start.y + deltaY, start.z);
 				if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
 					if (Position::areInRange<1, 1>(start, destination)) {
 						return true;
@@ -568,7 +604,7 @@ bool Map::checkSightLine(Position start, Position destination) {
 					yIncrease = deltaY;
 				}
 
-				const auto &tile = getTile(start.x + deltaX, start.y + yIncrease, start.z);
+				const auto tile = peekTile(start.x + deltaX, start.y + yIncrease, start.z);
 				if (tile && tile->hasProperty(CONST_PROP_BLOCKPROJECTILE)) {
 					if (Position::areInRange<1, 1>(start, destination)) {
 						return true;
@@ -606,12 +642,13 @@ bool Map::isSightClear(const Position &fromPos, const Position &toPos, bool floo
 		return sightClear;
 	}
 
+	MapSector::TileReadGuard guard;
 	uint8_t startZ;
 	if (sightClear && (fromPos.z < toPos.z || fromPos.z == toPos.z)) {
 		startZ = fromPos.z;
 	} else {
 		// Check if we can throw above obstacle
-		const auto &tile = getTile(fromPos.x, fromPos.y, fromPos.z - 1);
+		const auto tile = peekTile(fromPos.x, fromPos.y, fromPos.z - 1);
 		if ((tile && (tile->getGround() || tile->hasProperty(CONST_PROP_BLOCKPROJECTILE))) || !checkSightLine(Position(fromPos.x, fromPos.y, fromPos.z - 1), Position(toPos.x, toPos.y, toPos.z - 1))) {
 			return false;
 		}
@@ -626,7 +663,7 @@ bool Map::isSightClear(const Position &fromPos, const Position &toPos, bool floo
 
 	// now we need to perform a jump between floors to see if everything is clear (literally)
 	for (; startZ != toPos.z; ++startZ) {
-		const auto &tile = getTile(toPos.x, toPos.y, startZ);
+		const auto tile = peekTile(toPos.x, toPos.y, startZ);
 		if (tile && (tile->getGround() || tile->hasProperty(CONST_PROP_BLOCKPROJECTILE))) {
 			return false;
 		}
@@ -649,6 +686,57 @@ std::shared_ptr<Tile> Map::canWalkTo(const std::shared_ptr<Creature> &creature,
 	return tile;
 }
 
+bool Map::isWalkBlocked(const Position &pos, bool monster, bool createTiles /* = true*/) {
+	if (pos.z >= MAP_MAX_LAYERS) {
+		return true;
+	}
+
+	const auto sector = getMapSector(pos.x, pos.y);
+	if (!sector) {
+		return true;
+	}
+
+	const auto floor = sector->peekFloor(pos.z);
+	if (!floor) {
+		return true;
+	}
+
+	auto state = floor->getWalkState(pos.x, pos.y);
+	if (state == Floor::WALK_UNKNOWN) {
+		if (!createTiles && floor->hasTileCache(pos.x, pos.y)) {
+			return false;
+		}
+
+		MapSector::TileReadGuard guard;
+		const auto tile = peekTile(pos.x, pos.y, pos.z);
+		if (!tile || tile->hasFlag(TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT)) {
+			state = Floor::WALK_BLOCKED;
+		} else if (tile->hasFlag(TILESTATE_IMMOVABLEBLOCKSOLID | TILESTATE_IMMOVABLENOFIELDBLOCKPATH)) {
+			state = Floor::WALK_BLOCKED_MONSTER;
+		} else {
+			state = Floor::WALK_FREE;
+		}
+		floor->setWalkState(pos.x, pos.y, state);
+	}
+
+	return state == Floor::WALK_BLOCKED || (monster && state == Floor::WALK_BLOCKED_MONSTER);
+}
+
+void Map::invalidateWalkCache(const Position &pos) {
+	if (pos.z >= MAP_MAX_LAYERS) {
+		return;
+	}
+
+	const auto sector = getMapSector(pos.x, pos.y);
+	if (!sector) {
+		return;
+	}
+
+	if (const auto floor = sector->peekFloor(pos.z)) {
+		floor->invalidateWalkState(pos.x, pos.y);
+	}
+}
+
 bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Position &_targetPos, std::vector<Direction> &dirList, const FrozenPathingConditionCall &pathCondition, const FindPathParams &fpp) {
 	static int_fast32_t allNeighbors[8][2] = {
 		{ -1, 0 }, { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 }
@@ -680,6 +768,15 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 	const int_fast32_t sX = std::abs(targetPos.getX() - pos.getX());
 	const int_fast32_t sY = std::abs(targetPos.getY() - pos.getY());
 
+	const bool isMonster = !withoutCreature && creature->getMonster() != nullptr;
+
+	// Step distances around the target shared by everyone chasing it, a tighter heuristic than the chebyshev distance.
+	// Only for paths that end next to the target, distance keepers stop short of it
+	std::shared_ptr<const FlowFieldCache::Field> flowField;
+	if (!withoutCreature && !fpp.keepDistance && fpp.maxTargetDist <= 1 && targetPos.z == pos.z && g_configManager().getBoolean(PATHFINDING_FLOW_FIELD)) {
+		flowField = flowFields.get(*this, targetPos, isMonster);
+	}
+
 	uint_fast16_t cntDirs = 0;
 
 	const AStarNode* found = nullptr;
@@ -750,6 +847,10 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 			if (neighborNode) {
 				extraCost = neighborNode->c;
 			} else {
+				if (!withoutCreature && isWalkBlocked(pos, isMonster)) {
+					continue;
+				}
+
 				const auto &tile = withoutCreature ? getTile(pos.x, pos.y, pos.z) : canWalkTo(creature, pos);
 				if (!tile) {
 					continue;
@@ -772,7 +873,13 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, const Posit
 				// Does not exist in the open/closed list, create a new node
 				const int_fast32_t dX = std::abs(targetPos.getX() - pos.getX());
 				const int_fast32_t dY = std::abs(targetPos.getY() - pos.getY());
-				if (!nodes.createOpenNode(n, pos.x, pos.y, newf, ((dX - sX) << 3) + ((dY - sY) << 3) + (std::max(dX, dY) << 3), extraCost)) {
+				int_fast32_t distance = std::max(dX, dY);
+				if (flowField) {
+					if (const auto steps = flowField->getSteps(pos); steps != FlowFieldCache::UNREACHABLE) {
+						distance = steps;
+					}
+				}
+				if (!nodes.createOpenNode(n, pos.x, pos.y, newf, ((dX - sX) << 3) + ((dY - sY) << 3) + (distance << 3), extraCost)) {
 					if (found) {
 						break;
 					}
@@ -835,6 +942,7 @@ bool Map::getPathMatching(const std::shared_ptr<Creature> &creature, std::vector
 bool Map::getPathMatchingCond(const std::shared_ptr<Creature> &creature, const Position &targetPos, std::vector<Direction> &dirList, const FrozenPathingConditionCall &pathCondition, const FindPathParams &fpp) {
 	Position pos = creature->getPosition();
 	Position endPos;
+	const bool isMonster = creature->getMonster() != nullptr;
 
 	AStarNodes nodes(pos.x, pos.y, AStarNodes::getTileWalkCost(creature, getTile(pos.x, pos.y, pos.z)));
 
@@ -937,6 +1045,10 @@ bool Map::getPathMatchingCond(const std::shared_ptr<Creature> &creature, const P
 			if (neighborNode) {
 				extraCost = neighborNode->c;
 			} else {
+				if (isWalkBlocked(pos, isMonster)) {
+					continue;
+				}
+
 				const auto &tile = Map::canWalkTo(creature, pos);
 				if (!tile) {
 					continue;
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "mapcache.hpp"
+#include "map/utils/flowfield.hpp"
 #include "map/town.hpp"
 #include "map/house/house.hpp"
 #include "creatures/monsters/spawns/spawn_monster.hpp"
@@ -86,6 +87,16 @@ public:
 		return getTile(pos.x, pos.y, pos.z);
 	}
 
+	/**
+	 * Get a single tile without taking locks or a reference.
+	 * Meant for read-only hot paths, the caller holds a MapSector::TileReadGuard for as long as it uses the pointer.
+	 * \returns A non-owning pointer to that tile.
+	 */
+	Tile* peekTile(uint16_t x, uint16_t y, uint8_t z);
+	Tile* peekTile(const Position &pos) {
+		return peekTile(pos.x, pos.y, pos.z);
+	}
+
 	void refreshZones(uint16_t x, uint16_t y, uint8_t z);
 	void refreshZones(const Position &pos) {
 		refreshZones(pos.x, pos.y, pos.z);
@@ -130,6 +141,15 @@ public:
 
 	std::shared_ptr<Tile> canWalkTo(const std::shared_ptr<Creature> &creature, const Position &pos);
 
+	/**
+	 * Checks the cached creature-independent walkability of a position (missing tiles, floor changes,
+	 * teleports and, for monsters, immovable blocking items). False does not mean walkable, canWalkTo
+	 * still has to check creatures and movable items.
+	 * Without createTiles, tiles still only in the map cache are not created and count as not blocked.
+	 */
+	bool isWalkBlocked(const Position &pos, bool monster, bool createTiles = true);
+	void invalidateWalkCache(const Position &pos);
+
 	bool getPathMatching(const std::shared_ptr<Creature> &creature, std::vector<Direction> &dirList, const FrozenPathingConditionCall &pathCondition, const FindPathParams &fpp);
 	bool getPathMatching(const std::shared_ptr<Creature> &creature, const Position &targetPos, std::vector<Direction> &dirList, const FrozenPathingConditionCall &pathCondition, const FindPathParams &fpp);
 	bool getPathMatchingCond(const std::shared_ptr<Creature> &creature, const Position &targetPos, std::vector<Direction> &dirList, const FrozenPathingConditionCall &pathCondition, const FindPathParams &fpp);
@@ -170,6 +190,8 @@ private:
 	uint32_t width = 0;
 	uint32_t height = 0;
 
+	FlowFieldCache flowFields;
+
 	friend class Game;
 	friend class IOMap;
 	friend class MapCache;
@@ -192,14 +192,12 @@ std::shared_ptr<BasicItem> MapCache::tryReplaceItemFromCache(const std::shared_p
 }
 
 MapSector* MapCache::createMapSector(const uint32_t x, const uint32_t y) {
-	const uint32_t index = x / SECTOR_SIZE | y / SECTOR_SIZE << 16;
-	const auto it = mapSectors.find(index);
-	if (it != mapSectors.end()) {
-		return &it->second;
+	bool created;
+	const auto sector = mapSectors.getOrCreate(x, y, created);
+	if (created) {
+		MapSector::newSector = true;
 	}
-
-	MapSector::newSector = true;
-	return &mapSectors[index];
+	return sector;
 }
 
 MapSector* MapCache::getBestMapSector(uint32_t x, uint32_t y) {
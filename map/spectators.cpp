@@ -19,12 +19,7 @@
 
 #include "creatures/creature.hpp"
 #include "game/game.hpp"
-
-phmap::flat_hash_map<Position, SpectatorsCache> Spectators::spectatorsCache;
-
-void Spectators::clearCache() {
-	spectatorsCache.clear();
-}
+#include "map/utils/spectatorfilter.hpp"
 
 Spectators Spectators::insert(const std::shared_ptr<Creature> &creature) {
 	if (creature) {
@@ -39,54 +34,20 @@ Spectators Spectators::insertAll(const CreatureVector &list) {
 
 		creatures.insert(creatures.end(), list.begin(), list.end());
 
-		// Remove duplicate
 		if (hasValue) {
-			std::unordered_set uset(creatures.begin(), creatures.end());
-			creatures.clear();
-			creatures.insert(creatures.end(), uset.begin(), uset.end());
+			removeDuplicates();
 		}
 	}
 	return *this;
 }
 
-bool Spectators::checkCache(const SpectatorsCache::FloorData &specData, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, const Position &centerPos, bool checkDistance, bool multifloor, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
-	const auto &list = multifloor || !specData.floor ? specData.multiFloor : specData.floor;
-
-	if (!list) {
-		return false;
-	}
-
-	if (!multifloor && !specData.floor) {
-		// Force check the distance of creatures as we only need to pick up creatures from the Floor(centerPos.z)
-		checkDistance = true;
-	}
-
-	if (checkDistance) {
-		CreatureVector spectators;
-		spectators.reserve(creatures.size());
-		for (const auto &creature : *list) {
-			const auto &specPos = creature->getPosition();
-			if ((centerPos.x - specPos.x >= minRangeX
-			     && centerPos.y - specPos.y >= minRangeY
-			     && centerPos.x - specPos.x <= maxRangeX
-			     && centerPos.y - specPos.y <= maxRangeY
-			     && (multifloor || specPos.z == centerPos.z)
-			     && ((onlyPlayers && creature->getPlayer())
-			         || (onlyMonsters && creature->getMonster())
-			         || (onlyNpcs && creature->getNpc())))
-			    || (!onlyPlayers && !onlyMonsters && !onlyNpcs)) {
-				spectators.emplace_back(creature);
-			}
-		}
-		insertAll(spectators);
-	} else {
-		insertAll(*list);
-	}
-
-	return true;
+void Spectators::removeDuplicates() {
+	std::ranges::sort(creatures, std::less {}, [](const auto &creature) { return creature.get(); });
+	const auto [first, last] = std::ranges::unique(creatures, std::equal_to {}, [](const auto &creature) { return creature.get(); });
+	creatures.erase(first, last);
 }
 
-CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
+void Spectators::getSpectators(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
 	uint8_t minRangeZ = centerPos.z;
 	uint8_t maxRangeZ = centerPos.z;
 
@@ -128,8 +89,20 @@ CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifl
 	const int32_t endx2 = x2 - (x2 & SECTOR_MASK);
 	const int32_t endy2 = y2 - (y2 & SECTOR_MASK);
 
-	CreatureVector spectators;
-	spectators.reserve(std::max<uint8_t>(MAP_MAX_VIEW_PORT_X, MAP_MAX_VIEW_PORT_Y) * 2);
+	const uint8_t typeMask = onlyPlayers ? MapSector::SPECTATOR_PLAYER
+		: onlyMonsters                   ? MapSector::SPECTATOR_MONSTER
+		: onlyNpcs                       ? MapSector::SPECTATOR_NPC
+										 : 0;
+
+	const SpectatorRange range {
+		.minX = min_x,
+		.minY = min_y,
+		.minZ = minRangeZ,
+		.centerZ = static_cast<int32_t>(centerPos.getZ()),
+		.width = width,
+		.height = height,
+		.depth = depth,
+	};
 
 	const MapSector* startSector = g_game().map.getMapSector(startx1, starty1);
 	const MapSector* sectorS = startSector;
@@ -137,20 +110,12 @@ CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifl
 		const MapSector* sectorE = sectorS;
 		for (int32_t nx = startx1; nx <= endx2; nx += SECTOR_SIZE) {
 			if (sectorE) {
-				const auto &nodeList = onlyPlayers ? sectorE->player_list
-					: onlyMonsters                 ? sectorE->monster_list
-					: onlyNpcs                     ? sectorE->npc_list
-												   : sectorE->creature_list;
-
-				for (const auto &creature : nodeList) {
-					const auto &cpos = creature->getPosition();
-					if (static_cast<uint32_t>(static_cast<int32_t>(cpos.z) - minRangeZ) <= depth) {
-						const int_fast16_t offsetZ = Position::getOffsetZ(centerPos, cpos);
-						if (static_cast<uint32_t>(cpos.x - offsetZ - min_x) <= width && static_cast<uint32_t>(cpos.y - offsetZ - min_y) <= height) {
-							spectators.emplace_back(creature);
-						}
+				const auto sector = sectorE;
+				SpectatorFilter::forEach(sector->creature_x.data(), sector->creature_y.data(), sector->creature_z.data(), sector->creature_list.size(), range, [&](size_t i) {
+					if (typeMask == 0 || (sector->creature_type[i] & typeMask) != 0) {
+						creatures.emplace_back(sector->creature_list[i]);
 					}
-				}
+				});
 				sectorE = sectorE->sectorE;
 			} else {
 				sectorE = g_game().map.getMapSector(nx + SECTOR_SIZE, ny);
@@ -163,77 +128,20 @@ CreatureVector Spectators::getSpectators(const Position &centerPos, bool multifl
 			sectorS = g_game().map.getMapSector(startx1, ny + SECTOR_SIZE);
 		}
 	}
-
-	return spectators;
 }
 
-Spectators Spectators::find(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, bool useCache) {
+Spectators Spectators::find(const Position &centerPos, bool multifloor, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY) {
 	minRangeX = (minRangeX == 0 ? -MAP_MAX_VIEW_PORT_X : -minRangeX);
 	maxRangeX = (maxRangeX == 0 ? MAP_MAX_VIEW_PORT_X : maxRangeX);
 	minRangeY = (minRangeY == 0 ? -MAP_MAX_VIEW_PORT_Y : -minRangeY);
 	maxRangeY = (maxRangeY == 0 ? MAP_MAX_VIEW_PORT_Y : maxRangeY);
 
-	if (!useCache) {
-		insertAll(getSpectators(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY));
-		return *this;
-	}
-
-	const auto &it = spectatorsCache.find(centerPos);
-	const bool cacheFound = it != spectatorsCache.end();
-	if (cacheFound) {
-		auto &cache = it->second;
-		if (minRangeX < cache.minRangeX || maxRangeX > cache.maxRangeX || minRangeY < cache.minRangeY || maxRangeY > cache.maxRangeY) {
-			// recache with new range
-			cache.minRangeX = minRangeX = std::min<int32_t>(minRangeX, cache.minRangeX);
-			cache.minRangeY = minRangeY = std::min<int32_t>(minRangeY, cache.minRangeY);
-			cache.maxRangeX = maxRangeX = std::max<int32_t>(maxRangeX, cache.maxRangeX);
-			cache.maxRangeY = maxRangeY = std::max<int32_t>(maxRangeY, cache.maxRangeY);
-		} else {
-			const bool checkDistance = minRangeX != cache.minRangeX || maxRangeX != cache.maxRangeX || minRangeY != cache.minRangeY || maxRangeY != cache.maxRangeY;
-
-			if (onlyPlayers || onlyMonsters || onlyNpcs) {
-				static const SpectatorsCache::FloorData EMPTY_FLOOR_DATA;
-
-				const auto &creaturesCache = onlyPlayers ? cache.players
-					: onlyMonsters                       ? cache.monsters
-					: onlyNpcs                           ? cache.npcs
-														 : EMPTY_FLOOR_DATA;
-
-				// check players/monsters/npcs cache
-				if (checkCache(creaturesCache, onlyPlayers, onlyMonsters, onlyNpcs, centerPos, checkDistance, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
-					return *this;
-				}
-
-				// if there is no players/monsters/npcs cache, look for players/monsters/npcs in the creatures cache.
-				if (checkCache(cache.creatures, onlyPlayers, onlyMonsters, onlyNpcs, centerPos, true, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
-					return *this;
-				}
-				// All Creatures
-			} else if (checkCache(cache.creatures, false, false, false, centerPos, checkDistance, multifloor, minRangeX, maxRangeX, minRangeY, maxRangeY)) {
-				return *this;
-			}
-		}
-	}
-
-	const auto &spectators = getSpectators(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY);
-
-	// It is necessary to create the cache even if no spectators is found, so that there is no future query.
-	auto &cache = cacheFound ? it->second : spectatorsCache.emplace(centerPos, SpectatorsCache { .minRangeX = minRangeX, .maxRangeX = maxRangeX, .minRangeY = minRangeY, .maxRangeY = maxRangeY, .creatures = {}, .monsters = {}, .npcs = {}, .players = {} }).first->second;
-	auto &creaturesCache = onlyPlayers ? cache.players
-		: onlyMonsters                 ? cache.monsters
-		: onlyNpcs                     ? cache.npcs
-									   : cache.creatures;
-	auto &creatureList = (multifloor ? creaturesCache.multiFloor : creaturesCache.floor);
-	if (creatureList) {
-		creatureList->clear();
-	} else {
-		creatureList.emplace();
-	}
-
-	if (!spectators.empty()) {
-		insertAll(spectators);
+	// The sector index is always up to date, so the matches are appended straight into this set
+	const auto previousSize = creatures.size();
+	getSpectators(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY);
 
-		creatureList->insert(creatureList->end(), spectators.begin(), spectators.end());
+	if (previousSize > 0 && creatures.size() > previousSize) {
+		removeDuplicates();
 	}
 
 	return *this;
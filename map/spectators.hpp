@@ -26,34 +26,19 @@ struct Position;
 // Forward declaration para CreatureVector
 using CreatureVector = std::vector<std::shared_ptr<Creature>>;
 
-struct SpectatorsCache {
-	struct FloorData {
-		std::optional<CreatureVector> floor;
-		std::optional<CreatureVector> multiFloor;
-	};
-
-	int32_t minRangeX { 0 };
-	int32_t maxRangeX { 0 };
-	int32_t minRangeY { 0 };
-	int32_t maxRangeY { 0 };
-
-	FloorData creatures;
-	FloorData monsters;
-	FloorData npcs;
-	FloorData players;
-};
-
+/**
+ * Creatures found around a position. Queries read the per-sector spectator index
+ * (see MapSector), which is updated as creatures move, so there is no result cache.
+ */
 class Spectators {
 public:
-	static void clearCache();
-
 	template <typename T>
 		requires std::is_base_of_v<Creature, T>
-	Spectators find(const Position &centerPos, bool multifloor = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true) {
+	Spectators find(const Position &centerPos, bool multifloor = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0) {
 		constexpr bool onlyPlayers = std::is_same_v<T, Player>;
 		constexpr bool onlyMonsters = std::is_same_v<T, Monster>;
 		constexpr bool onlyNpcs = std::is_same_v<T, Npc>;
-		return find(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY, useCache);
+		return find(centerPos, multifloor, onlyPlayers, onlyMonsters, onlyNpcs, minRangeX, maxRangeX, minRangeY, maxRangeY);
 	}
 
 	template <typename T>
@@ -103,14 +88,12 @@ public:
 	}
 
 private:
-	static phmap::flat_hash_map<Position, SpectatorsCache> spectatorsCache;
-
-	Spectators find(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0, bool useCache = true);
-	CreatureVector getSpectators(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0);
+	Spectators find(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0);
+	void getSpectators(const Position &centerPos, bool multifloor = false, bool onlyPlayers = false, bool onlyMonsters = false, bool onlyNpcs = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0, int32_t maxRangeY = 0);
 
 	Spectators filter(bool onlyPlayers, bool onlyMonsters, bool onlyNpcs) const;
 
-	bool checkCache(const SpectatorsCache::FloorData &specData, bool onlyPlayers, bool onlyMonsters, bool onlyNpcs, const Position &centerPos, bool checkDistance, bool multifloor, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY);
+	void removeDuplicates();
 
 	CreatureVector creatures;
 };
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "map/utils/flowfield.hpp"
+
+#include "map/map.hpp"
+#include "utils/tools.hpp"
+
+std::shared_ptr<const FlowFieldCache::Field> FlowFieldCache::get(Map &map, const Position &target, bool monster) {
+	const uint64_t key = static_cast<uint64_t>(target.x) | static_cast<uint64_t>(target.y) << 16 | static_cast<uint64_t>(target.z) << 32 | static_cast<uint64_t>(monster) << 40;
+	const auto now = OTSYS_TIME();
+	{
+		std::scoped_lock lock(mutex);
+		if (const auto it = fields.find(key); it != fields.end() && it->second->expiresAt > now) {
+			return it->second;
+		}
+	}
+
+	// Built outside the lock, two threads racing for the same target just build it twice
+	auto field = build(map, target, monster);
+
+	std::scoped_lock lock(mutex);
+	if (fields.size() >= MAX_FIELDS) {
+		for (auto it = fields.begin(); it != fields.end();) {
+			if (it->second->expiresAt <= now) {
+				fields.erase(it++);
+			} else {
+				++it;
+			}
+		}
+	}
+	if (fields.size() < MAX_FIELDS) {
+		fields.insert_or_assign(key, field);
+	}
+	return field;
+}
+
+void FlowFieldCache::clear() {
+	std::scoped_lock lock(mutex);
+	fields.clear();
+}
+
+std::shared_ptr<const FlowFieldCache::Field> FlowFieldCache::build(Map &map, const Position &target, bool monster) {
+	static constexpr std::array<std::pair<int32_t, int32_t>, 8> neighbors = { {
+		{ -1, 0 },
+		{ 0, 1 },
+		{ 1, 0 },
+		{ 0, -1 },
+		{ -1, -1 },
+		{ 1, -1 },
+		{ 1, 1 },
+		{ -1, 1 },
+	} };
+
+	auto field = std::make_shared<Field>();
+	field->target = target;
+	field->expiresAt = OTSYS_TIME() + LIFETIME;
+	field->steps.fill(UNREACHABLE);
+
+	std::array<uint16_t, SIZE * SIZE> queue;
+	size_t head = 0;
+	size_t tail = 0;
+
+	// The target tile itself is always a valid goal, even when a creature blocks it
+	constexpr uint16_t center = RADIUS * SIZE + RADIUS;
+	field->steps[center] = 0;
+	queue[tail++] = center;
+
+	while (head < tail) {
+		const auto index = queue[head++];
+		const int32_t cx = index % SIZE;
+		const int32_t cy = index / SIZE;
+		const auto steps = static_cast<uint16_t>(field->steps[index] + 1);
+
+		for (const auto &[offsetX, offsetY] : neighbors) {
+			const int32_t nx = cx + offsetX;
+			const int32_t ny = cy + offsetY;
+			if (static_cast<uint32_t>(nx) >= SIZE || static_cast<uint32_t>(ny) >= SIZE) {
+				continue;
+			}
+
+			const auto next = static_cast<uint16_t>(ny * SIZE + nx);
+			if (field->steps[next] != UNREACHABLE) {
+				continue;
+			}
+
+			const Position pos(static_cast<uint16_t>(target.x + nx - RADIUS), static_cast<uint16_t>(target.y + ny - RADIUS), target.z);
+			// Never creates tiles, unloaded ones count as walkable so the steps stay a lower bound
+			if (map.isWalkBlocked(pos, monster, false)) {
+				continue;
+			}
+
+			field->steps[next] = steps;
+			queue[tail++] = next;
+		}
+	}
+
+	return field;
+}
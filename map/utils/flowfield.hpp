@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "game/movement/position.hpp"
+
+class Map;
+
+/**
+ * Short-lived step distance fields around pathfinding targets.
+ *
+ * A field holds the number of steps from every tile in a window around the target, found with
+ * a breadth-first search over the cached static walkability (Map::isWalkBlocked). Creatures
+ * chasing the same target share the field and use it as the A* heuristic, so the search is
+ * guided around walls instead of expanding every dead end. Fields expire after LIFETIME ms and
+ * a target that moved simply gets a new field, as the key is its exact position.
+ * Only used for paths ending next to the target (maxTargetDist <= 1).
+ */
+class FlowFieldCache {
+public:
+	static constexpr int32_t RADIUS = 24;
+	static constexpr int32_t SIZE = RADIUS * 2 + 1;
+	static constexpr uint16_t UNREACHABLE = std::numeric_limits<uint16_t>::max();
+	static constexpr int64_t LIFETIME = 500;
+	static constexpr size_t MAX_FIELDS = 1024;
+
+	struct Field {
+		Position target;
+		int64_t expiresAt = 0;
+		std::array<uint16_t, SIZE * SIZE> steps {};
+
+		// Steps from pos to the target, or UNREACHABLE when not reached inside the window
+		uint16_t getSteps(const Position &pos) const {
+			const int32_t dx = pos.x - target.x + RADIUS;
+			const int32_t dy = pos.y - target.y + RADIUS;
+			if (pos.z != target.z || static_cast<uint32_t>(dx) >= SIZE || static_cast<uint32_t>(dy) >= SIZE) {
+				return UNREACHABLE;
+			}
+			return steps[dy * SIZE + dx];
+		}
+	};
+
+	std::shared_ptr<const Field> get(Map &map, const Position &target, bool monster);
+
+	void clear();
+
+private:
+	static std::shared_ptr<const Field> build(Map &map, const Position &target, bool monster);
+
+	std::mutex mutex;
+	phmap::flat_hash_map<uint64_t, std::shared_ptr<const Field>> fields;
+};
@@ -21,57 +21,205 @@
 
 bool MapSector::newSector = false;
 
-void MapSector::addCreature(const std::shared_ptr<Creature> &c) {
-	creature_list.emplace_back(c);
-	if (c->getPlayer()) {
-		player_list.emplace_back(c);
-	} else if (c->getMonster()) {
-		monster_list.emplace_back(c);
-	} else if (c->getNpc()) {
-		npc_list.emplace_back(c);
+namespace {
+	struct alignas(64) TileReader {
+		// Epoch the thread entered its outermost read section at, 0 while outside
+		std::atomic_uint64_t epoch { 0 };
+		std::atomic_bool used { false };
+	};
+
+	struct RetiredTile {
+		std::shared_ptr<Tile> tile;
+		// Epoch of the first reclaim pass after the retirement, 0 until then
+		uint64_t epoch = 0;
+	};
+
+	struct TileEpochs {
+		std::atomic_uint64_t epoch { 1 };
+		std::mutex mutex;
+		std::vector<RetiredTile> retired;
+		// Deque for stable addresses, a slot is reused once its thread exits
+		std::deque<TileReader> readers;
+	};
+
+	TileEpochs &tileEpochs() {
+		static TileEpochs instance;
+		return instance;
+	}
+
+	struct ThreadTileReader {
+		TileReader* reader = nullptr;
+		uint32_t depth = 0;
+
+		~ThreadTileReader() {
+			if (reader) {
+				reader->epoch.store(0, std::memory_order_release);
+				reader->used.store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	thread_local ThreadTileReader threadTileReader;
+
+	TileReader &acquireTileReader() {
+		auto &epochs = tileEpochs();
+		std::scoped_lock lock(epochs.mutex);
+		for (auto &reader : epochs.readers) {
+			bool expected = false;
+			if (reader.used.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+				return reader;
+			}
+		}
+		auto &reader = epochs.readers.emplace_back();
+		reader.used.store(true, std::memory_order_release);
+		return reader;
 	}
 }
 
-void MapSector::removeCreature(const std::shared_ptr<Creature> &c) {
-	auto iter = std::ranges::find(creature_list, c);
-	if (iter == creature_list.end()) {
-		g_logger().error("[{}]: Creature not found in creature_list!", __FUNCTION__);
+MapSector::TileReadGuard::TileReadGuard() {
+	auto &thread = threadTileReader;
+	if (thread.depth++ > 0) {
 		return;
 	}
+	if (!thread.reader) {
+		thread.reader = &acquireTileReader();
+	}
 
-	assert(iter != creature_list.end());
-	*iter = creature_list.back();
-	creature_list.pop_back();
+	thread.reader->epoch.store(tileEpochs().epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+	// Pairs with the fence in reclaimRetiredTiles: either that pass sees this epoch,
+	// or the tile loads below already see every replacement made before it
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
 
-	if (c->getPlayer()) {
-		iter = std::ranges::find(player_list, c);
-		if (iter == player_list.end()) {
-			g_logger().error("[{}]: Player not found in player_list!", __FUNCTION__);
+MapSector::TileReadGuard::~TileReadGuard() {
+	auto &thread = threadTileReader;
+	if (--thread.depth == 0) {
+		thread.reader->epoch.store(0, std::memory_order_release);
+	}
+}
+
+void Floor::setTile(uint16_t x, uint16_t y, std::shared_ptr<Tile> tile) {
+	const auto newTile = tile.get();
+	std::shared_ptr<Tile> oldTile;
+	{
+		std::unique_lock<std::shared_mutex> ul(mutex);
+		tilePtrs[index(x, y)].store(newTile, std::memory_order_release);
+		oldTile = std::exchange(tiles[x & SECTOR_MASK][y & SECTOR_MASK].first, std::move(tile));
+	}
+	invalidateWalkState(x, y);
+
+	if (oldTile && oldTile.get() != newTile) {
+		MapSector::retireTile(std::move(oldTile));
+	}
+}
+
+void MapSector::retireTile(std::shared_ptr<Tile> tile) {
+	auto &epochs = tileEpochs();
+	std::scoped_lock lock(epochs.mutex);
+	epochs.retired.emplace_back(RetiredTile { std::move(tile) });
+}
+
+void MapSector::reclaimRetiredTiles() {
+	std::vector<std::shared_ptr<Tile>> expired;
+	{
+		auto &epochs = tileEpochs();
+		std::scoped_lock lock(epochs.mutex);
+		if (epochs.retired.empty()) {
 			return;
 		}
 
-		assert(iter != player_list.end());
-		*iter = player_list.back();
-		player_list.pop_back();
-	} else if (c->getMonster()) {
-		iter = std::ranges::find(monster_list, c);
-		if (iter == monster_list.end()) {
-			g_logger().error("[{}]: Monster not found in player_list!", __FUNCTION__);
-			return;
+		// Readers that could still hold a tile retired before now entered before this epoch
+		const auto epoch = epochs.epoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		auto oldest = std::numeric_limits<uint64_t>::max();
+		for (const auto &reader : epochs.readers) {
+			const auto readerEpoch = reader.epoch.load(std::memory_order_acquire);
+			if (readerEpoch != 0) {
+				oldest = std::min(oldest, readerEpoch);
+			}
 		}
 
-		assert(iter != monster_list.end());
-		*iter = monster_list.back();
-		monster_list.pop_back();
-	} else if (c->getNpc()) {
-		iter = std::ranges::find(npc_list, c);
-		if (iter == npc_list.end()) {
-			g_logger().error("[{}]: NPC not found in player_list!", __FUNCTION__);
+		std::erase_if(epochs.retired, [&](RetiredTile &retired) {
+			if (retired.epoch == 0) {
+				retired.epoch = epoch;
+			}
+			if (retired.epoch > oldest) {
+				return false;
+			}
+			expired.emplace_back(std::move(retired.tile));
+			return true;
+		});
+	}
+	// Destroyed outside the lock, a tile can own a lot of items
+}
+
+void MapSector::addCreature(const std::shared_ptr<Creature> &c) {
+	const auto index = static_cast<uint32_t>(creature_list.size());
+	creature_list.emplace_back(c);
+	creature_x.emplace_back();
+	creature_y.emplace_back();
+	creature_z.emplace_back();
+	creature_type.emplace_back();
+	setCreatureIndex(index, c);
+}
+
+void MapSector::removeCreature(const std::shared_ptr<Creature> &c) {
+	auto index = c->sectorIndex;
+	if (index >= creature_list.size() || creature_list[index] != c) {
+		const auto iter = std::ranges::find(creature_list, c);
+		if (iter == creature_list.end()) {
+			g_logger().error("[{}]: Creature not found in creature_list!", __FUNCTION__);
 			return;
 		}
+		index = static_cast<uint32_t>(std::distance(creature_list.begin(), iter));
+	}
+
+	const auto last = static_cast<uint32_t>(creature_list.size() - 1);
+	if (index != last) {
+		creature_list[index] = std::move(creature_list[last]);
+		creature_x[index] = creature_x[last];
+		creature_y[index] = creature_y[last];
+		creature_z[index] = creature_z[last];
+		creature_type[index] = creature_type[last];
+		creature_list[index]->sectorIndex = index;
+	}
+
+	creature_list.pop_back();
+	creature_x.pop_back();
+	creature_y.pop_back();
+	creature_z.pop_back();
+	creature_type.pop_back();
+}
+
+void MapSector::updateCreature(const std::shared_ptr<Creature> &c) {
+	const auto index = c->sectorIndex;
+	if (index >= creature_list.size() || creature_list[index] != c) {
+		g_logger().error("[{}]: Creature not found in creature_list!", __FUNCTION__);
+		return;
+	}
 
-		assert(iter != npc_list.end());
-		*iter = npc_list.back();
-		npc_list.pop_back();
+	const auto &pos = c->getPosition();
+	creature_x[index] = pos.x;
+	creature_y[index] = pos.y;
+	creature_z[index] = pos.z;
+}
+
+void MapSector::setCreatureIndex(uint32_t index, const std::shared_ptr<Creature> &c) {
+	c->sectorIndex = index;
+
+	const auto &pos = c->getPosition();
+	creature_x[index] = pos.x;
+	creature_y[index] = pos.y;
+	creature_z[index] = pos.z;
+
+	if (c->getPlayer()) {
+		creature_type[index] = SPECTATOR_PLAYER;
+	} else if (c->getMonster()) {
+		creature_type[index] = SPECTATOR_MONSTER;
+	} else if (c->getNpc()) {
+		creature_type[index] = SPECTATOR_NPC;
+	} else {
+		creature_type[index] = 0;
 	}
 }
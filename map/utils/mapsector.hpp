@@ -32,11 +32,16 @@ struct Floor {
 		return tiles[x & SECTOR_MASK][y & SECTOR_MASK].first;
 	}
 
-	void setTile(uint16_t x, uint16_t y, std::shared_ptr<Tile> tile) {
-		std::unique_lock<std::shared_mutex> ul(mutex);
-		tiles[x & SECTOR_MASK][y & SECTOR_MASK].first = std::move(tile);
+	/**
+	 * Lock-free and refcount-free read of the published tile.
+	 * Only valid inside a MapSector::TileReadGuard, the pointer must not outlive it.
+	 */
+	Tile* peekTile(uint16_t x, uint16_t y) const {
+		return tilePtrs[index(x, y)].load(std::memory_order_acquire);
 	}
 
+	void setTile(uint16_t x, uint16_t y, std::shared_ptr<Tile> tile);
+
 	std::shared_ptr<BasicTile> getTileCache(uint16_t x, uint16_t y) const {
 		std::shared_lock<std::shared_mutex> sl(mutex);
 		return tiles[x & SECTOR_MASK][y & SECTOR_MASK].second;
@@ -45,6 +50,12 @@ struct Floor {
 	void setTileCache(uint16_t x, uint16_t y, const std::shared_ptr<BasicTile> &newTile) {
 		std::unique_lock<std::shared_mutex> ul(mutex);
 		tiles[x & SECTOR_MASK][y & SECTOR_MASK].second = newTile;
+		pendingCache[index(x, y)].store(newTile != nullptr, std::memory_order_release);
+	}
+
+	// True while the tile is still only in the map cache and has to be created on first access
+	bool hasTileCache(uint16_t x, uint16_t y) const {
+		return pendingCache[index(x, y)].load(std::memory_order_acquire);
 	}
 
 	const auto &getTiles() const {
@@ -52,13 +63,49 @@ struct Floor {
 		return tiles;
 	}
 
+	// Cached creature independent walkability of each tile, used by pathfinding (see Map::isWalkBlocked)
+	enum WalkState : uint8_t {
+		WALK_UNKNOWN = 0,
+		WALK_FREE = 1,
+		WALK_BLOCKED_MONSTER = 2, // Only monsters are blocked (immovable blocking items)
+		WALK_BLOCKED = 3,
+	};
+
+	WalkState getWalkState(uint16_t x, uint16_t y) const {
+		const auto i = index(x, y);
+		return static_cast<WalkState>((walkStates[i / 32].load(std::memory_order_acquire) >> (i % 32 * 2)) & 3);
+	}
+
+	void setWalkState(uint16_t x, uint16_t y, WalkState state) {
+		const auto i = index(x, y);
+		const auto shift = i % 32 * 2;
+		auto &word = walkStates[i / 32];
+		auto current = word.load(std::memory_order_relaxed);
+		while (!word.compare_exchange_weak(current, (current & ~(3ULL << shift)) | static_cast<uint64_t>(state) << shift, std::memory_order_release)) { }
+	}
+
+	void invalidateWalkState(uint16_t x, uint16_t y) {
+		const auto i = index(x, y);
+		walkStates[i / 32].fetch_and(~(3ULL << (i % 32 * 2)), std::memory_order_release);
+	}
+
 	uint8_t getZ() const {
 		return z;
 	}
 
 private:
+	static size_t index(uint16_t x, uint16_t y) {
+		return (x & SECTOR_MASK) * SECTOR_SIZE + (y & SECTOR_MASK);
+	}
+
 	std::pair<std::shared_ptr<Tile>, std::shared_ptr<BasicTile>> tiles[SECTOR_SIZE][SECTOR_SIZE] = {};
 
+	// Read mirror of tiles, written under the mutex and published with release stores
+	std::array<std::atomic<Tile*>, SECTOR_SIZE * SECTOR_SIZE> tilePtrs {};
+	std::array<std::atomic_bool, SECTOR_SIZE * SECTOR_SIZE> pendingCache {};
+	// Two bits (WalkState) per tile
+	std::array<std::atomic_uint64_t, SECTOR_SIZE * SECTOR_SIZE / 32> walkStates {};
+
 	mutable std::shared_mutex mutex;
 
 	uint8_t z { 0 };
@@ -81,6 +128,7 @@ public:
 		std::scoped_lock lock(floors_mutex);
 		if (!floors[z]) {
 			floors[z] = std::make_shared<Floor>(static_cast<uint8_t>(z));
+			floorPtrs[z].store(floors[z].get(), std::memory_order_release);
 		}
 		return floors[z];
 	}
@@ -94,24 +142,65 @@ public:
 		return floors[z];
 	}
 
+	// Floors are never removed, so the lock-free lookup can return a plain pointer
+	Floor* peekFloor(uint8_t z) const {
+		return z < MAP_MAX_LAYERS ? floorPtrs[z].load(std::memory_order_acquire) : nullptr;
+	}
+
+	/**
+	 * Read section for Floor::peekTile, on any thread. Guards nest and cost two stores and a fence
+	 * for the outermost one. A tile replaced in a floor is only freed once every thread that entered
+	 * before its replacement has left, see reclaimRetiredTiles.
+	 */
+	class TileReadGuard {
+	public:
+		TileReadGuard();
+		~TileReadGuard();
+
+		TileReadGuard(const TileReadGuard &) = delete;
+		TileReadGuard &operator=(const TileReadGuard &) = delete;
+	};
+
+	// How often the dispatcher frees the retired tiles no reader can see anymore
+	static constexpr uint32_t TILE_RECLAIM_INTERVAL = 1000;
+
+	static void retireTile(std::shared_ptr<Tile> tile);
+	static void reclaimRetiredTiles();
+
 	void addCreature(const std::shared_ptr<Creature> &c);
 
 	void removeCreature(const std::shared_ptr<Creature> &c);
 
+	// Refreshes the indexed position of a creature that moved inside this sector
+	void updateCreature(const std::shared_ptr<Creature> &c);
+
+	enum SpectatorType : uint8_t {
+		SPECTATOR_PLAYER = 1 << 0,
+		SPECTATOR_MONSTER = 1 << 1,
+		SPECTATOR_NPC = 1 << 2,
+	};
+
 private:
+	void setCreatureIndex(uint32_t index, const std::shared_ptr<Creature> &c);
+
 	static bool newSector;
 
 	MapSector* sectorS = nullptr;
 	MapSector* sectorE = nullptr;
 
+	// Spectator index: structure of arrays kept in the same order as creature_list, so range
+	// queries only touch the packed positions and type bits and copy the matching creatures.
+	// The positions are 16-bit lanes for the vectorized filter (see SpectatorFilter).
 	std::vector<std::shared_ptr<Creature>> creature_list;
-	std::vector<std::shared_ptr<Creature>> player_list;
-	std::vector<std::shared_ptr<Creature>> monster_list;
-	std::vector<std::shared_ptr<Creature>> npc_list;
+	std::vector<uint16_t> creature_x;
+	std::vector<uint16_t> creature_y;
+	std::vector<uint16_t> creature_z;
+	std::vector<uint8_t> creature_type;
 
 	mutable std::mutex floors_mutex;
 
 	std::shared_ptr<Floor> floors[MAP_MAX_LAYERS] = {};
+	std::array<std::atomic<Floor*>, MAP_MAX_LAYERS> floorPtrs {};
 
 	uint32_t floorBits = 0;
 
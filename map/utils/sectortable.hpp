@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "map/utils/mapsector.hpp"
+
+/**
+ * Two-level direct-mapped table of map sectors.
+ *
+ * The root covers the whole 16-bit coordinate space (so custom maps loaded at an offset
+ * always fit) and points to region pages of PAGE_SECTORS x PAGE_SECTORS sectors, which
+ * are allocated on demand. A lookup is two shifts, two masks and two loads.
+ * Pages and sectors are published with release stores and never freed while the map lives,
+ * so the returned pointers are stable and can be read from any thread.
+ */
+class SectorTable {
+public:
+	static constexpr uint32_t SECTORS_PER_AXIS = 0x10000 / SECTOR_SIZE;
+	static constexpr uint32_t PAGE_SECTORS = 32; // 512x512 tiles per page with SECTOR_SIZE 16
+	static constexpr uint32_t PAGES_PER_AXIS = SECTORS_PER_AXIS / PAGE_SECTORS;
+
+	static_assert(std::has_single_bit(SECTORS_PER_AXIS) && std::has_single_bit(PAGE_SECTORS));
+
+	SectorTable() = default;
+
+	SectorTable(const SectorTable &) = delete;
+	SectorTable &operator=(const SectorTable &) = delete;
+
+	MapSector* get(uint32_t x, uint32_t y) const {
+		const uint32_t sx = x / SECTOR_SIZE;
+		const uint32_t sy = y / SECTOR_SIZE;
+		// Coordinates below 0 wrap around, so this also rejects them
+		if ((sx | sy) >= SECTORS_PER_AXIS) {
+			return nullptr;
+		}
+
+		const auto page = (*root)[pageIndex(sx, sy)].load(std::memory_order_acquire);
+		return page ? page->sectors[slotIndex(sx, sy)].load(std::memory_order_acquire) : nullptr;
+	}
+
+	/**
+	 * Returns the sector, creating it when needed. Only called by the thread that owns the map writes.
+	 * \param created Set to true when the sector did not exist.
+	 */
+	MapSector* getOrCreate(uint32_t x, uint32_t y, bool &created) {
+		created = false;
+		const uint32_t sx = x / SECTOR_SIZE;
+		const uint32_t sy = y / SECTOR_SIZE;
+		if ((sx | sy) >= SECTORS_PER_AXIS) {
+			return nullptr;
+		}
+
+		auto &pageRef = (*root)[pageIndex(sx, sy)];
+		auto page = pageRef.load(std::memory_order_acquire);
+		if (!page) {
+			auto &newPage = pages.emplace_back(std::make_unique<Page>());
+			page = newPage.get();
+			pageRef.store(page, std::memory_order_release);
+		}
+
+		auto &sectorRef = page->sectors[slotIndex(sx, sy)];
+		auto sector = sectorRef.load(std::memory_order_acquire);
+		if (!sector) {
+			sector = new MapSector();
+			sectorRef.store(sector, std::memory_order_release);
+			++sectorCount;
+			created = true;
+		}
+		return sector;
+	}
+
+	size_t size() const {
+		return sectorCount;
+	}
+
+	size_t pageCount() const {
+		return pages.size();
+	}
+
+private:
+	struct Page {
+		Page() = default;
+		Page(const Page &) = delete;
+		Page &operator=(const Page &) = delete;
+
+		~Page() {
+			for (auto &sector : sectors) {
+				delete sector.load(std::memory_order_relaxed);
+			}
+		}
+
+		std::array<std::atomic<MapSector*>, PAGE_SECTORS * PAGE_SECTORS> sectors {};
+	};
+
+	static uint32_t pageIndex(uint32_t sx, uint32_t sy) {
+		return (sy / PAGE_SECTORS) * PAGES_PER_AXIS + sx / PAGE_SECTORS;
+	}
+
+	static uint32_t slotIndex(uint32_t sx, uint32_t sy) {
+		return (sy & (PAGE_SECTORS - 1)) * PAGE_SECTORS + (sx & (PAGE_SECTORS - 1));
+	}
+
+	using Root = std::array<std::atomic<Page*>, PAGES_PER_AXIS * PAGES_PER_AXIS>;
+
+	// 128x128 page pointers (128 KB), the pages themselves are owned by the pages vector
+	std::unique_ptr<Root> root = std::make_unique<Root>();
+
+	std::vector<std::unique_ptr<Page>> pages;
+	size_t sectorCount = 0;
+};
@@ -0,0 +1,197 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/**
+ * Range check of the spectator query, as done by Spectators::getSpectators:
+ * the z must be in [minZ, minZ + depth] and x/y are shifted by the floor offset
+ * before being checked against the [minX, minX + width] x [minY, minY + height] area.
+ */
+struct SpectatorRange {
+	int32_t minX = 0;
+	int32_t minY = 0;
+	int32_t minZ = 0;
+	int32_t centerZ = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t depth = 0;
+
+	bool contains(int32_t x, int32_t y, int32_t z) const {
+		if (static_cast<uint32_t>(z - minZ) > depth) {
+			return false;
+		}
+
+		const int32_t offsetZ = centerZ - z;
+		return static_cast<uint32_t>(x - offsetZ - minX) <= width && static_cast<uint32_t>(y - offsetZ - minY) <= height;
+	}
+};
+
+/**
+ * Filters the packed positions of a MapSector spectator index.
+ *
+ * The vector kernels do the range check in 16-bit lanes with wrapping arithmetic, which can
+ * only let extra candidates through (never drop one), so every candidate is confirmed with
+ * SpectatorRange::contains before f is called. Both paths report the same indexes in order.
+ */
+class SpectatorFilter {
+public:
+	template <typename F>
+	static void forEach(const uint16_t* xs, const uint16_t* ys, const uint16_t* zs, size_t count, const SpectatorRange &range, F &&f) {
+		size_t i = 0;
+#if defined(__AVX2__)
+		i = forEachAVX2(xs, ys, zs, count, range, f);
+#elif defined(__SSE2__)
+		i = forEachSSE2(xs, ys, zs, count, range, f);
+#elif defined(__NEON__)
+		i = forEachNEON(xs, ys, zs, count, range, f);
+#endif
+		forEachScalar(xs, ys, zs, i, count, range, f);
+	}
+
+	template <typename F>
+	static void forEachScalar(const uint16_t* xs, const uint16_t* ys, const uint16_t* zs, size_t begin, size_t count, const SpectatorRange &range, F &&f) {
+		for (size_t i = begin; i < count; ++i) {
+			if (range.contains(xs[i], ys[i], zs[i])) {
+				f(i);
+			}
+		}
+	}
+
+private:
+	// Lane constants: x + z - (centerZ + minX) <= width, same for y, and z - minZ <= depth (all unsigned, mod 2^16)
+	struct Lanes {
+		explicit Lanes(const SpectatorRange &range) :
+			baseX(static_cast<uint16_t>(range.centerZ + range.minX)),
+			baseY(static_cast<uint16_t>(range.centerZ + range.minY)),
+			baseZ(static_cast<uint16_t>(range.minZ)),
+			width(static_cast<uint16_t>(std::min<uint32_t>(range.width, 0xFFFF))),
+			height(static_cast<uint16_t>(std::min<uint32_t>(range.height, 0xFFFF))),
+			depth(static_cast<uint16_t>(std::min<uint32_t>(range.depth, 0xFFFF))) { }
+
+		uint16_t baseX, baseY, baseZ;
+		uint16_t width, height, depth;
+	};
+
+	template <typename F>
+	static void confirm(const uint16_t* xs, const uint16_t* ys, const uint16_t* zs, size_t i, const SpectatorRange &range, F &f) {
+		if (range.contains(xs[i], ys[i], zs[i])) {
+			f(i);
+		}
+	}
+
+#if defined(__AVX2__)
+	template <typename F>
+	static size_t forEachAVX2(const uint16_t* xs, const uint16_t* ys, const uint16_t* zs, size_t count, const SpectatorRange &range, F &f) {
+		const Lanes lanes(range);
+		const __m256i baseX = _mm256_set1_epi16(static_cast<int16_t>(lanes.baseX));
+		const __m256i baseY = _mm256_set1_epi16(static_cast<int16_t>(lanes.baseY));
+		const __m256i baseZ = _mm256_set1_epi16(static_cast<int16_t>(lanes.baseZ));
+		const __m256i width = _mm256_set1_epi16(static_cast<int16_t>(lanes.width));
+		const __m256i height = _mm256_set1_epi16(static_cast<int16_t>(lanes.height));
+		const __m256i depth = _mm256_set1_epi16(static_cast<int16_t>(lanes.depth));
+		const __m256i zero = _mm256_setzero_si256();
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i));
+			const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + i));
+			const __m256i z = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(zs + i));
+
+			// a <= b (unsigned) is equivalent to saturating a - b == 0
+			const __m256i inZ = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(z, baseZ), depth), zero);
+			const __m256i inX = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(_mm256_add_epi16(x, z), baseX), width), zero);
+			const __m256i inY = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(_mm256_add_epi16(y, z), baseY), height), zero);
+
+			// Two mask bits per 16-bit lane
+			auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(inZ, _mm256_and_si256(inX, inY))));
+			while (mask != 0) {
+				const auto bit = std::countr_zero(mask);
+				confirm(xs, ys, zs, i + bit / 2, range, f);
+				mask &= ~(3U << bit);
+			}
+		}
+		return i;
+	}
+#endif
+
+#if defined(__SSE2__)
+	template <typename F>
+	static size_t forEachSSE2(const uint16_t* xs, const uint16_t* ys, const uint16_t* zs, size_t count, const SpectatorRange &range, F &f) {
+		const Lanes lanes(range);
+		const __m128i baseX = _mm_set1_epi16(static_cast<int16_t>(lanes.baseX));
+		const __m128i baseY = _mm_set1_epi16(static_cast<int16_t>(lanes.baseY));
+		const __m128i baseZ = _mm_set1_epi16(static_cast<int16_t>(lanes.baseZ));
+		const __m128i width = _mm_set1_epi16(static_cast<int16_t>(lanes.width));
+		const __m128i height = _mm_set1_epi16(static_cast<int16_t>(lanes.height));
+		const __m128i depth = _mm_set1_epi16(static_cast<int16_t>(lanes.depth));
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i));
+			const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i));
+			const __m128i z = _mm_loadu_si128(reinterpret_cast<const __m128i*>(zs + i));
+
+			const __m128i inZ = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(z, baseZ), depth), zero);
+			const __m128i inX = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(_mm_add_epi16(x, z), baseX), width), zero);
+			const __m128i inY = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(_mm_add_epi16(y, z), baseY), height), zero);
+
+			auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(inZ, _mm_and_si128(inX, inY))));
+			while (mask != 0) {
+				const auto bit = std::countr_zero(mask);
+				confirm(xs, ys, zs, i + bit / 2, range, f);
+				mask &= ~(3U << bit);
+			}
+		}
+		return i;
+	}
+#endif
+
+#if defined(__NEON__)
+	template <typename F>
+	static size_t forEachNEON(const uint16_t* xs, const uint16_t* ys, const uint16_t* zs, size_t count, const SpectatorRange &range, F &f) {
+		const Lanes lanes(range);
+		const uint16x8_t baseX = vdupq_n_u16(lanes.baseX);
+		const uint16x8_t baseY = vdupq_n_u16(lanes.baseY);
+		const uint16x8_t baseZ = vdupq_n_u16(lanes.baseZ);
+		const uint16x8_t width = vdupq_n_u16(lanes.width);
+		const uint16x8_t height = vdupq_n_u16(lanes.height);
+		const uint16x8_t depth = vdupq_n_u16(lanes.depth);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const uint16x8_t x = vld1q_u16(xs + i);
+			const uint16x8_t y = vld1q_u16(ys + i);
+			const uint16x8_t z = vld1q_u16(zs + i);
+
+			const uint16x8_t inZ = vcleq_u16(vsubq_u16(z, baseZ), depth);
+			const uint16x8_t inX = vcleq_u16(vsubq_u16(vaddq_u16(x, z), baseX), width);
+			const uint16x8_t inY = vcleq_u16(vsubq_u16(vaddq_u16(y, z), baseY), height);
+
+			// Narrow to one byte per lane and scan the 64-bit mask
+			auto mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(vandq_u16(inZ, vandq_u16(inX, inY)))), 0);
+			while (mask != 0) {
+				const auto bit = std::countr_zero(mask);
+				confirm(xs, ys, zs, i + bit / 8, range, f);
+				mask &= ~(0xFFULL << bit);
+			}
+		}
+		return i;
+	}
+#endif
+};
@@ -52,6 +52,7 @@
 #include <variant>
 #include <numeric>
 #include <cmath>
+#include <bit>
 #include <mutex>
 #include <stack>
 #include <source_location>
@@ -0,0 +1,215 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "security/xtea.hpp"
+
+#include "utils/simd.hpp"
+
+namespace xtea {
+	namespace {
+		constexpr uint32_t delta = 0x61C88647;
+
+		// Blocks are read in native (little-endian) order, as the client writes them
+		void loadBlock(const uint8_t* data, uint32_t &v0, uint32_t &v1) {
+			std::memcpy(&v0, data, 4);
+			std::memcpy(&v1, data + 4, 4);
+		}
+
+		void storeBlock(uint8_t* data, uint32_t v0, uint32_t v1) {
+			std::memcpy(data, &v0, 4);
+			std::memcpy(data + 4, &v1, 4);
+		}
+
+		void encryptBlocks(uint8_t* data, size_t begin, size_t length, const RoundKeys &keys) {
+			for (size_t pos = begin; pos < length; pos += 8) {
+				uint32_t v0, v1;
+				loadBlock(data + pos, v0, v1);
+				for (const auto &[k0, k1] : keys.encrypt) {
+					v0 += ((v1 << 4 ^ v1 >> 5) + v1) ^ k0;
+					v1 += ((v0 << 4 ^ v0 >> 5) + v0) ^ k1;
+				}
+				storeBlock(data + pos, v0, v1);
+			}
+		}
+
+		void decryptBlocks(uint8_t* data, size_t begin, size_t length, const RoundKeys &keys) {
+			for (size_t pos = begin; pos < length; pos += 8) {
+				uint32_t v0, v1;
+				loadBlock(data + pos, v0, v1);
+				for (const auto &[k0, k1] : keys.decrypt) {
+					v1 -= ((v0 << 4 ^ v0 >> 5) + v0) ^ k0;
+					v0 -= ((v1 << 4 ^ v1 >> 5) + v1) ^ k1;
+				}
+				storeBlock(data + pos, v0, v1);
+			}
+		}
+
+#if defined(__AVX2__)
+		constexpr size_t SIMD_BYTES = 64;
+
+		// [a0 a1 b0 b1 | c0 c1 d0 d1] [e0 e1 f0 f1 | g0 g1 h0 h1] -> v0 = [a0 b0 e0 f0 | c0 d0 g0 h0], v1 = the odd words
+		void deinterleave(__m256i lo, __m256i hi, __m256i &v0, __m256i &v1) {
+			lo = _mm256_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+			hi = _mm256_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+			v0 = _mm256_unpacklo_epi64(lo, hi);
+			v1 = _mm256_unpackhi_epi64(lo, hi);
+		}
+
+		void interleave(__m256i v0, __m256i v1, __m256i &lo, __m256i &hi) {
+			lo = _mm256_shuffle_epi32(_mm256_unpacklo_epi64(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+			hi = _mm256_shuffle_epi32(_mm256_unpackhi_epi64(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+		}
+
+		__m256i mix(__m256i v) {
+			return _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v, 4), _mm256_srli_epi32(v, 5)), v);
+		}
+
+		template <bool Encrypt>
+		size_t transformSimd(uint8_t* data, size_t length, const RoundKeys &keys) {
+			size_t pos = 0;
+			for (; pos + SIMD_BYTES <= length; pos += SIMD_BYTES) {
+				auto* lanes = reinterpret_cast<__m256i*>(data + pos);
+				__m256i v0, v1;
+				deinterleave(_mm256_loadu_si256(lanes), _mm256_loadu_si256(lanes + 1), v0, v1);
+				if constexpr (Encrypt) {
+					for (const auto &[k0, k1] : keys.encrypt) {
+						v0 = _mm256_add_epi32(v0, _mm256_xor_si256(mix(v1), _mm256_set1_epi32(static_cast<int32_t>(k0))));
+						v1 = _mm256_add_epi32(v1, _mm256_xor_si256(mix(v0), _mm256_set1_epi32(static_cast<int32_t>(k1))));
+					}
+				} else {
+					for (const auto &[k0, k1] : keys.decrypt) {
+						v1 = _mm256_sub_epi32(v1, _mm256_xor_si256(mix(v0), _mm256_set1_epi32(static_cast<int32_t>(k0))));
+						v0 = _mm256_sub_epi32(v0, _mm256_xor_si256(mix(v1), _mm256_set1_epi32(static_cast<int32_t>(k1))));
+					}
+				}
+				__m256i lo, hi;
+				interleave(v0, v1, lo, hi);
+				_mm256_storeu_si256(lanes, lo);
+				_mm256_storeu_si256(lanes + 1, hi);
+			}
+			return pos;
+		}
+#elif defined(__SSE2__)
+		constexpr size_t SIMD_BYTES = 32;
+
+		// [a0 a1 b0 b1] [c0 c1 d0 d1] -> v0 = [a0 b0 c0 d0], v1 = [a1 b1 c1 d1]
+		void deinterleave(__m128i lo, __m128i hi, __m128i &v0, __m128i &v1) {
+			lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+			hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+			v0 = _mm_unpacklo_epi64(lo, hi);
+			v1 = _mm_unpackhi_epi64(lo, hi);
+		}
+
+		void interleave(__m128i v0, __m128i v1, __m128i &lo, __m128i &hi) {
+			lo = _mm_shuffle_epi32(_mm_unpacklo_epi64(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+			hi = _mm_shuffle_epi32(_mm_unpackhi_epi64(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+		}
+
+		__m128i mix(__m128i v) {
+			return _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v, 4), _mm_srli_epi32(v, 5)), v);
+		}
+
+		template <bool Encrypt>
+		size_t transformSimd(uint8_t* data, size_t length, const RoundKeys &keys) {
+			size_t pos = 0;
+			for (; pos + SIMD_BYTES <= length; pos += SIMD_BYTES) {
+				auto* lanes = reinterpret_cast<__m128i*>(data + pos);
+				__m128i v0, v1;
+				deinterleave(_mm_loadu_si128(lanes), _mm_loadu_si128(lanes + 1), v0, v1);
+				if constexpr (Encrypt) {
+					for (const auto &[k0, k1] : keys.encrypt) {
+						v0 = _mm_add_epi32(v0, _mm_xor_si128(mix(v1), _mm_set1_epi32(static_cast<int32_t>(k0))));
+						v1 = _mm_add_epi32(v1, _mm_xor_si128(mix(v0), _mm_set1_epi32(static_cast<int32_t>(k1))));
+					}
+				} else {
+					for (const auto &[k0, k1] : keys.decrypt) {
+						v1 = _mm_sub_epi32(v1, _mm_xor_si128(mix(v0), _mm_set1_epi32(static_cast<int32_t>(k0))));
+						v0 = _mm_sub_epi32(v0, _mm_xor_si128(mix(v1), _mm_set1_epi32(static_cast<int32_t>(k1))));
+					}
+				}
+				__m128i lo, hi;
+				interleave(v0, v1, lo, hi);
+				_mm_storeu_si128(lanes, lo);
+				_mm_storeu_si128(lanes + 1, hi);
+			}
+			return pos;
+		}
+#elif defined(__NEON__)
+		constexpr size_t SIMD_BYTES = 32;
+
+		uint32x4_t mix(uint32x4_t v) {
+			return vaddq_u32(veorq_u32(vshlq_n_u32(v, 4), vshrq_n_u32(v, 5)), v);
+		}
+
+		template <bool Encrypt>
+		size_t transformSimd(uint8_t* data, size_t length, const RoundKeys &keys) {
+			size_t pos = 0;
+			for (; pos + SIMD_BYTES <= length; pos += SIMD_BYTES) {
+				auto* words = reinterpret_cast<uint32_t*>(data + pos);
+				// vld2 splits the even (v0) and odd (v1) words of 4 blocks
+				uint32x4x2_t v = vld2q_u32(words);
+				if constexpr (Encrypt) {
+					for (const auto &[k0, k1] : keys.encrypt) {
+						v.val[0] = vaddq_u32(v.val[0], veorq_u32(mix(v.val[1]), vdupq_n_u32(k0)));
+						v.val[1] = vaddq_u32(v.val[1], veorq_u32(mix(v.val[0]), vdupq_n_u32(k1)));
+					}
+				} else {
+					for (const auto &[k0, k1] : keys.decrypt) {
+						v.val[1] = vsubq_u32(v.val[1], veorq_u32(mix(v.val[0]), vdupq_n_u32(k0)));
+						v.val[0] = vsubq_u32(v.val[0], veorq_u32(mix(v.val[1]), vdupq_n_u32(k1)));
+					}
+				}
+				vst2q_u32(words, v);
+			}
+			return pos;
+		}
+#else
+		template <bool>
+		size_t transformSimd(uint8_t*, size_t, const RoundKeys &) {
+			return 0;
+		}
+#endif
+	}
+
+	RoundKeys expandKey(const Key &key) {
+		RoundKeys keys;
+
+		uint32_t sum = 0;
+		for (auto &[k0, k1] : keys.encrypt) {
+			k0 = sum + key[sum & 3];
+			sum -= delta;
+			k1 = sum + key[(sum >> 11) & 3];
+		}
+
+		sum = 0xC6EF3720;
+		for (auto &[k0, k1] : keys.decrypt) {
+			k0 = sum + key[(sum >> 11) & 3];
+			sum += delta;
+			k1 = sum + key[sum & 3];
+		}
+
+		return keys;
+	}
+
+	void encrypt(uint8_t* data, size_t length, const RoundKeys &keys) {
+		encryptBlocks(data, transformSimd<true>(data, length, keys), length, keys);
+	}
+
+	void decrypt(uint8_t* data, size_t length, const RoundKeys &keys) {
+		decryptBlocks(data, transformSimd<false>(data, length, keys), length, keys);
+	}
+}
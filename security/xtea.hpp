@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/**
+ * XTEA in ECB mode, as used by the client protocol.
+ *
+ * Blocks are independent, so the SIMD kernels (AVX2: 8 blocks, SSE2/NEON: 4 blocks)
+ * run the 32 rounds over several blocks at once and the scalar path only handles the tail.
+ * The kernel is picked at compile time from the target flags, like the rest of utils/simd.hpp.
+ */
+namespace xtea {
+	using Key = std::array<uint32_t, 4>;
+
+	// key[sum & 3] / key[(sum >> 11) & 3] mixed with the round sum, computed once per key
+	struct RoundKeys {
+		std::array<std::array<uint32_t, 2>, 32> encrypt {};
+		std::array<std::array<uint32_t, 2>, 32> decrypt {};
+	};
+
+	RoundKeys expandKey(const Key &key);
+
+	// length must be a multiple of 8
+	void encrypt(uint8_t* data, size_t length, const RoundKeys &keys);
+	void decrypt(uint8_t* data, size_t length, const RoundKeys &keys);
+}
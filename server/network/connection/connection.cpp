@@ -80,7 +80,7 @@ void Connection::close(bool force) {
 		g_dispatcher().addEvent([protocol = protocol] { protocol->release(); }, __FUNCTION__, std::chrono::milliseconds(CONNECTION_WRITE_TIMEOUT * 1000).count());
 	}
 
-	if (messageQueue.empty() || force) {
+	if ((!writing && messageQueue.empty()) || force) {
 		closeSocket();
 	}
 }
@@ -325,14 +325,17 @@ void Connection::send(const OutputMessage_ptr &outputMessage) {
 		return;
 	}
 
-	bool noPendingWrite = messageQueue.empty();
+	// Everything queued while a write is in flight goes out with the next batch
+	bool noPendingWrite = !writing && messageQueue.empty();
 	messageQueue.emplace_back(outputMessage);
 
 	if (noPendingWrite) {
 		if (socket.is_open()) {
 			try {
+				writing = true;
 				asio::post(socket.get_executor(), [self = shared_from_this()] { self->internalWorker(); });
 			} catch (const std::system_error &e) {
+				writing = false;
 				g_logger().error("[Connection::send] - Exception in posting write operation: {}", e.what());
 				close(FORCE_CLOSE);
 			}
@@ -346,18 +349,21 @@ void Connection::send(const OutputMessage_ptr &outputMessage) {
 void Connection::internalWorker() {
 	std::unique_lock lock(connectionLock);
 	if (messageQueue.empty()) {
+		writing = false;
 		if (connectionState == CONNECTION_STATE_CLOSED) {
 			closeSocket();
 		}
 		return;
 	}
 
-	const auto &outputMessage = messageQueue.front();
+	writeQueue.swap(messageQueue);
 	lock.unlock();
-	protocol->onSendMessage(outputMessage);
+	for (const auto &outputMessage : writeQueue) {
+		protocol->onSendMessage(outputMessage);
+	}
 	lock.lock();
 
-	internalSend(outputMessage);
+	internalSend();
 }
 
 uint32_t Connection::getIP() {
@@ -376,39 +382,82 @@ uint32_t Connection::getIP() {
 	return ip;
 }
 
-void Connection::internalSend(const OutputMessage_ptr &outputMessage) {
+Connection::WriteStats Connection::getWriteStats() {
+	std::scoped_lock lock(connectionLock);
+	const auto second = OTSYS_TIME() / 1000;
+	if (second == writeStatsSecond) {
+		return lastWriteStats;
+	} else if (second == writeStatsSecond + 1) {
+		return currentWriteStats;
+	}
+	// Nothing written during the last second
+	return {};
+}
+
+void Connection::internalSend() {
+	writeBuffers.clear();
+	for (const auto &outputMessage : writeQueue) {
+		writeBuffers.emplace_back(outputMessage->getOutputBuffer(), outputMessage->getLength());
+	}
+
 	writeTimer.expires_from_now(std::chrono::seconds(CONNECTION_WRITE_TIMEOUT));
 	writeTimer.async_wait([self = std::weak_ptr<Connection>(shared_from_this())](const std::error_code &error) { Connection::handleTimeout(self, error); });
 
 	try {
-		asio::async_write(socket, asio::buffer(outputMessage->getOutputBuffer(), outputMessage->getLength()), [self = shared_from_this()](const std::error_code &error, std::size_t N) { self->onWriteOperation(error); });
+		asio::async_write(socket, writeBuffers, [self = shared_from_this()](const std::error_code &error, std::size_t N) { self->onWriteOperation(error, N); });
 	} catch (const std::system_error &e) {
 		g_logger().error("[Connection::internalSend] - Exception in async_write: {}", e.what());
 		close(FORCE_CLOSE);
 	}
 }
 
-void Connection::onWriteOperation(const std::error_code &error) {
+void Connection::updateWriteStats(size_t bytes, size_t messages) {
+	const auto second = OTSYS_TIME() / 1000;
+	if (second != writeStatsSecond) {
+		lastWriteStats = second == writeStatsSecond + 1 ? currentWriteStats : WriteStats {};
+		if (currentWriteStats.writes != 0) {
+			g_metrics().addCounter("network_bytes_sent", static_cast<double>(currentWriteStats.bytes));
+			g_metrics().addCounter("network_write_calls", currentWriteStats.writes);
+			g_metrics().addCounter("network_messages_sent", currentWriteStats.messages);
+		}
+		currentWriteStats = {};
+		writeStatsSecond = second;
+	}
+
+	currentWriteStats.bytes += bytes;
+	currentWriteStats.writes++;
+	currentWriteStats.messages += static_cast<uint32_t>(messages);
+}
+
+void Connection::onWriteOperation(const std::error_code &error, size_t bytesTransferred) {
 	std::unique_lock lock(connectionLock);
 	writeTimer.cancel();
 
 	if (error) {
 		g_logger().error("[Connection::onWriteOperation] - Write error: {}", error.message());
+		writeQueue.clear();
 		messageQueue.clear();
+		writing = false;
 		close(FORCE_CLOSE);
 		return;
 	}
 
-	messageQueue.pop_front();
+	updateWriteStats(bytesTransferred, writeQueue.size());
+	writeQueue.clear();
 
 	if (!messageQueue.empty()) {
-		const auto &outputMessage = messageQueue.front();
+		writeQueue.swap(messageQueue);
 		lock.unlock();
-		protocol->onSendMessage(outputMessage);
+		for (const auto &outputMessage : writeQueue) {
+			protocol->onSendMessage(outputMessage);
+		}
 		lock.lock();
-		internalSend(outputMessage);
-	} else if (connectionState == CONNECTION_STATE_CLOSED) {
-		closeSocket();
+		internalSend();
+	} else {
+		writing = false;
+		if (connectionState == CONNECTION_STATE_CLOSED) {
+			closeSocket();
+		}
 	}
 }
 
@@ -57,6 +57,12 @@ private:
 
 class Connection : public std::enable_shared_from_this<Connection> {
 public:
+	struct WriteStats {
+		uint64_t bytes = 0;
+		uint32_t writes = 0; // async_write calls, one writev each
+		uint32_t messages = 0;
+	};
+
 	// Constructor
 	Connection(asio::io_service &initIoService, ConstServicePort_ptr initservicePort);
 	// Constructor end
@@ -79,18 +85,22 @@ public:
 
 	uint32_t getIP();
 
+	// Totals of the last complete second
+	WriteStats getWriteStats();
+
 private:
 	void parseProxyIdentification(const std::error_code &error);
 	void parseHeader(const std::error_code &error);
 	void parsePacket(const std::error_code &error);
 
-	void onWriteOperation(const std::error_code &error);
+	void onWriteOperation(const std::error_code &error, size_t bytesTransferred);
 
 	static void handleTimeout(ConnectionWeak_ptr connectionWeak, const std::error_code &error);
 
 	void closeSocket();
 	void internalWorker();
-	void internalSend(const OutputMessage_ptr &outputMessage);
+	void internalSend();
+	void updateWriteStats(size_t bytes, size_t messages);
 
 	asio::ip::tcp::socket &getSocket() {
 		return socket;
@@ -101,7 +111,15 @@ private:
 
 	std::recursive_mutex connectionLock;
 
-	std::list<OutputMessage_ptr> messageQueue;
+	// Messages queued by send, swapped with writeQueue when the previous write completes,
+	// so both keep their capacity and the whole batch goes out in a single writev
+	std::vector<OutputMessage_ptr> messageQueue;
+	std::vector<OutputMessage_ptr> writeQueue;
+	std::vector<asio::const_buffer> writeBuffers;
+
+	WriteStats currentWriteStats;
+	WriteStats lastWriteStats;
+	int64_t writeStatsSecond = 0;
 
 	ConstServicePort_ptr service_port;
 	Protocol_ptr protocol;
@@ -116,6 +134,7 @@ private:
 
 	std::underlying_type_t<ConnectionState_t> connectionState = CONNECTION_STATE_OPEN;
 	bool receivedFirst = false;
+	bool writing = false;
 
 	friend class ServicePort;
 	friend class ConnectionManager;
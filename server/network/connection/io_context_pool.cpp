@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "server/network/connection/io_context_pool.hpp"
+
+IoContextPool::~IoContextPool() {
+	stop();
+}
+
+void IoContextPool::start(uint16_t threadCount) {
+	if (!contexts.empty()) {
+		return;
+	}
+
+	contexts.reserve(threadCount);
+	workGuards.reserve(threadCount);
+	threads.reserve(threadCount);
+	for (uint16_t i = 0; i < threadCount; ++i) {
+		auto &context = contexts.emplace_back(std::make_unique<asio::io_context>(1));
+		workGuards.emplace_back(asio::make_work_guard(*context));
+	}
+
+	for (uint16_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back([context = contexts[i].get(), i] {
+			try {
+				context->run();
+			} catch (const std::exception &e) {
+				g_logger().error("[IoContextPool] - Network thread {} stopped: {}", i, e.what());
+			}
+		});
+	}
+
+	if (threadCount > 0) {
+		g_logger().info("Network using {} io threads", threadCount);
+	}
+}
+
+void IoContextPool::stop() {
+	workGuards.clear();
+	for (const auto &context : contexts) {
+		context->stop();
+	}
+
+	for (auto &thread : threads) {
+		if (thread.joinable() && thread.get_id() != std::this_thread::get_id()) {
+			thread.join();
+		}
+	}
+	threads.clear();
+}
+
+asio::io_service &IoContextPool::next() {
+	if (contexts.empty()) {
+		return mainContext;
+	}
+	return *contexts[nextContext.fetch_add(1, std::memory_order_relaxed) % contexts.size()];
+}
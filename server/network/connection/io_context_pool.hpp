@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/**
+ * Network io contexts, each one is run by a single thread.
+ *
+ * Accepted connections are bound round-robin to one of the contexts, so the reads, packet
+ * decryption and writes of a connection always run on the same thread (no strand needed)
+ * while different connections are spread over all of them. Game state is still only
+ * touched by the dispatcher, protocols keep posting their work to it.
+ * Without threads every connection stays on the main io context, as before.
+ */
+class IoContextPool {
+public:
+	explicit IoContextPool(asio::io_service &mainContext) :
+		mainContext(mainContext) { }
+	~IoContextPool();
+
+	// non-copyable
+	IoContextPool(const IoContextPool &) = delete;
+	IoContextPool &operator=(const IoContextPool &) = delete;
+
+	void start(uint16_t threadCount);
+	void stop();
+
+	// Context for a new connection
+	asio::io_service &next();
+
+	size_t size() const {
+		return contexts.size();
+	}
+
+private:
+	using WorkGuard = asio::executor_work_guard<asio::io_context::executor_type>;
+
+	asio::io_service &mainContext;
+
+	std::vector<std::unique_ptr<asio::io_context>> contexts;
+	std::vector<WorkGuard> workGuards;
+	std::vector<std::thread> threads;
+	std::atomic_size_t nextContext = 0;
+};
@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#include "server/network/message/broadcastmessage.hpp"
+
+#include "lib/metrics/metrics.hpp"
+
+namespace {
+	struct BroadcastStats {
+		uint64_t encodedBytes = 0;
+		uint64_t sentBytes = 0;
+		uint32_t broadcasts = 0;
+	};
+}
+
+BroadcastMessage::~BroadcastMessage() {
+	if (encodedBytes == 0) {
+		return;
+	}
+
+	// Broadcasts happen per creature step, the counters are only flushed every STATS_FLUSH of them
+	static thread_local BroadcastStats pending;
+	pending.encodedBytes += encodedBytes;
+	pending.sentBytes += sentBytes;
+	if (++pending.broadcasts < STATS_FLUSH) {
+		return;
+	}
+
+	g_metrics().addCounter("network_broadcast_bytes_encoded", static_cast<double>(pending.encodedBytes));
+	g_metrics().addCounter("network_broadcast_bytes_sent", static_cast<double>(pending.sentBytes));
+	pending = {};
+}
+
+NetworkMessage &BroadcastMessage::scratch() {
+	static thread_local NetworkMessage msg;
+	msg.reset();
+	return msg;
+}
@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "server/network/message/networkmessage.hpp"
+
+/**
+ * Immutable encoded packet body, shared by every connection it is appended to.
+ */
+class SharedMessage {
+public:
+	explicit SharedMessage(const NetworkMessage &msg) :
+		bytes(msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION, msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION + msg.getLength()) { }
+
+	const uint8_t* data() const {
+		return bytes.data();
+	}
+
+	size_t size() const {
+		return bytes.size();
+	}
+
+private:
+	const std::vector<uint8_t> bytes;
+};
+
+using SharedMessage_ptr = std::shared_ptr<const SharedMessage>;
+
+/**
+ * A packet sent to many players at once (effects, speech, creature steps).
+ *
+ * The body is encoded on first use for each protocol flavour (old and current client) and the
+ * same bytes are then appended to the output buffer of every viewer, XTEA and compression still
+ * happen per connection when the buffer is flushed. Dispatcher thread only, lives for one broadcast.
+ */
+class BroadcastMessage {
+public:
+	BroadcastMessage() = default;
+	~BroadcastMessage();
+
+	// non-copyable
+	BroadcastMessage(const BroadcastMessage &) = delete;
+	BroadcastMessage &operator=(const BroadcastMessage &) = delete;
+
+	template <typename F>
+	const SharedMessage_ptr &get(bool oldProtocol, F &&encode) {
+		auto &payload = payloads[oldProtocol];
+		if (!payload) {
+			auto &msg = scratch();
+			encode(msg, oldProtocol);
+			payload = std::make_shared<const SharedMessage>(msg);
+			encodedBytes += payload->size();
+		}
+		sentBytes += payload->size();
+		return payload;
+	}
+
+	/**
+	 * For packets that also carry a small per viewer value (a stack position), one payload per key.
+	 * The encoding must not depend on the protocol flavour.
+	 */
+	template <typename F>
+	const SharedMessage_ptr &getKeyed(uint32_t key, F &&encode) {
+		auto it = std::ranges::find(keyedPayloads, key, &KeyedPayload::first);
+		if (it == keyedPayloads.end()) {
+			auto &msg = scratch();
+			encode(msg);
+			it = keyedPayloads.emplace(keyedPayloads.end(), key, std::make_shared<const SharedMessage>(msg));
+			encodedBytes += it->second->size();
+		}
+		sentBytes += it->second->size();
+		return it->second;
+	}
+
+private:
+	using KeyedPayload = std::pair<uint32_t, SharedMessage_ptr>;
+
+	static constexpr uint32_t STATS_FLUSH = 256;
+
+	static NetworkMessage &scratch();
+
+	std::array<SharedMessage_ptr, 2> payloads;
+	std::vector<KeyedPayload> keyedPayloads;
+	uint64_t encodedBytes = 0;
+	uint64_t sentBytes = 0;
+};
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "server/network/message/networkmessage.hpp"
+#include "server/network/message/broadcastmessage.hpp"
 #include "server/network/connection/connection.hpp"
 
 class Protocol;
@@ -61,6 +62,14 @@ public:
 		info.position += msgLen;
 	}
 
+	void append(const SharedMessage &msg) {
+		std::span<const unsigned char> sourceSpan(msg.data(), msg.size());
+		std::span<unsigned char> destSpan(buffer.data() + info.position, msg.size());
+		std::ranges::copy(sourceSpan, destSpan.begin());
+		info.length += msg.size();
+		info.position += msg.size();
+	}
+
 	void append(const OutputMessage_ptr &msg) {
 		auto msgLen = msg->getLength();
 		std::span<const unsigned char> sourceSpan(msg->getBuffer() + INITIAL_BUFFER_POSITION, msgLen);
@@ -20,12 +20,53 @@
 #include "config/configmanager.hpp"
 #include "server/network/connection/connection.hpp"
 #include "server/network/message/outputmessage.hpp"
+#include "lib/metrics/metrics.hpp"
 #include "security/rsa.hpp"
 #include "game/scheduling/dispatcher.hpp"
 #include "utils/tools.hpp"
 
+namespace {
+	// Compression time of all connections in the current second, used to lower the level under CPU pressure
+	std::atomic_int64_t compressionSecond = 0;
+	std::atomic_uint64_t compressionSecondNs = 0;
+	std::atomic_int32_t compressionLevelReduction = 0;
+
+	constexpr int32_t MAX_COMPRESSION_LEVEL_REDUCTION = 8;
+
+	int32_t adaptiveCompressionLevel(int32_t baseLevel) {
+		return std::max<int32_t>(1, baseLevel - compressionLevelReduction.load(std::memory_order_relaxed));
+	}
+
+	void addCompressionTime(uint64_t elapsedNs) {
+		const auto budgetMs = g_configManager().getNumber(PACKET_COMPRESSION_CPU_BUDGET);
+		if (budgetMs <= 0) {
+			compressionLevelReduction.store(0, std::memory_order_relaxed);
+			return;
+		}
+
+		const auto second = OTSYS_TIME() / 1000;
+		auto current = compressionSecond.load(std::memory_order_relaxed);
+		if (second == current || !compressionSecond.compare_exchange_strong(current, second, std::memory_order_relaxed)) {
+			compressionSecondNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+			return;
+		}
+
+		// First packet of a new second, one level step per second in either direction
+		const auto spentNs = compressionSecondNs.exchange(elapsedNs, std::memory_order_relaxed);
+		const auto budgetNs = static_cast<uint64_t>(budgetMs) * 1000000;
+		auto reduction = compressionLevelReduction.load(std::memory_order_relaxed);
+		if (second == current + 1 && spentNs > budgetNs) {
+			reduction = std::min(reduction + 1, MAX_COMPRESSION_LEVEL_REDUCTION);
+		} else if (spentNs < budgetNs / 2) {
+			reduction = std::max(reduction - 1, 0);
+		}
+		compressionLevelReduction.store(reduction, std::memory_order_relaxed);
+	}
+}
+
 Protocol::Protocol(const Connection_ptr &initConnection) :
-	connectionPtr(initConnection) { }
+	connectionPtr(initConnection),
+	streamingCompression(g_configManager().getBoolean(PACKET_COMPRESSION_STREAMING)) { }
 
 void Protocol::onSendMessage(const OutputMessage_ptr &msg) {
 	if (!rawMessages) {
@@ -134,66 +175,6 @@ void Protocol::disconnect() const {
 	}
 }
 
-void Protocol::XTEA_transform(uint8_t* buffer, size_t messageLength, bool encrypt) const {
-	constexpr uint32_t delta = 0x61C88647;
-	size_t readPos = 0;
-	const std::array<uint32_t, 4> newKey = key;
-
-	std::array<std::array<uint32_t, 2>, 32> precachedControlSum;
-	uint32_t sum = encrypt ? 0 : 0xC6EF3720;
-
-	// Precompute control sums
-	if (encrypt) {
-		for (size_t i = 0; i < 32; ++i) {
-			precachedControlSum[i][0] = sum + newKey[sum & 3];
-			sum -= delta;
-			precachedControlSum[i][1] = sum + newKey[(sum >> 11) & 3];
-		}
-	} else {
-		for (size_t i = 0; i < 32; ++i) {
-			precachedControlSum[i][0] = sum + newKey[(sum >> 11) & 3];
-			sum += delta;
-			precachedControlSum[i][1] = sum + newKey[sum & 3];
-		}
-	}
-
-	while (readPos < messageLength) {
-		std::array<uint8_t, 8> tempBuffer;
-		std::ranges::copy_n(buffer + readPos, 8, tempBuffer.begin());
-
-		// Convert bytes to uint32_t considering little-endian order
-		std::array<uint8_t, 4> bytes0;
-		std::array<uint8_t, 4> bytes1;
-		std::copy_n(tempBuffer.begin(), 4, bytes0.begin());
-		std::copy_n(tempBuffer.begin() + 4, 4, bytes1.begin());
-
-		uint32_t vData0 = std::bit_cast<uint32_t>(bytes0);
-		uint32_t vData1 = std::bit_cast<uint32_t>(bytes1);
-
-		if (encrypt) {
-			for (size_t i = 0; i < 32; ++i) {
-				vData0 += ((vData1 << 4 ^ vData1 >> 5) + vData1) ^ precachedControlSum[i][0];
-				vData1 += ((vData0 << 4 ^ vData0 >> 5) + vData0) ^ precachedControlSum[i][1];
-			}
-		} else {
-			for (size_t i = 0; i < 32; ++i) {
-				vData1 -= ((vData0 << 4 ^ vData0 >> 5) + vData0) ^ precachedControlSum[i][0];
-				vData0 -= ((vData1 << 4 ^ vData1 >> 5) + vData1) ^ precachedControlSum[i][1];
-			}
-		}
-
-		// Convert vData back to bytes
-		bytes0 = std::bit_cast<std::array<uint8_t, 4>>(vData0);
-		bytes1 = std::bit_cast<std::array<uint8_t, 4>>(vData1);
-
-		// Copy transformed bytes back to buffer
-		std::copy_n(bytes0.begin(), 4, buffer + readPos);
-		std::copy_n(bytes1.begin(), 4, buffer + readPos + 4);
-
-		readPos += 8;
-	}
-}
-
 void Protocol::XTEA_encrypt(OutputMessage &outputMessage) const {
 	// Ensure the message length is a multiple of 8
 	size_t paddingBytes = outputMessage.getLength() % 8;
@@ -204,7 +185,7 @@ void Protocol::XTEA_encrypt(OutputMessage &outputMessage) const {
 	uint8_t* buffer = outputMessage.getOutputBuffer();
 	size_t messageLength = outputMessage.getLength();
 
-	XTEA_transform(buffer, messageLength, true);
+	xtea::encrypt(buffer, messageLength, xteaKeys);
 }
 
 bool Protocol::XTEA_decrypt(NetworkMessage &msg) const {
@@ -216,7 +197,7 @@ bool Protocol::XTEA_decrypt(NetworkMessage &msg) const {
 	uint8_t* buffer = msg.getBuffer() + msg.getBufferPosition();
 	size_t messageLength = msgLength;
 
-	XTEA_transform(buffer, messageLength, false);
+	xtea::decrypt(buffer, messageLength, xteaKeys);
 
 	uint8_t paddingSize = msg.getByte();
 	uint16_t innerLength = messageLength - paddingSize;
@@ -255,60 +236,138 @@ uint32_t Protocol::getIP() const {
 	return 0;
 }
 
-bool Protocol::compression(OutputMessage &outputMessage) const {
+bool Protocol::compression(OutputMessage &outputMessage) {
 	if (checksumMethod != CHECKSUM_METHOD_SEQUENCE) {
 		return false;
 	}
 
-	static thread_local auto compress_ptr = std::make_unique<ZStream>();
-	static const auto &compress = compress_ptr;
+	const auto outputMessageSize = outputMessage.getLength();
+	if (outputMessageSize > NETWORKMESSAGE_MAXSIZE) {
+		g_logger().error("[NetworkMessage::compression] - Exceded NetworkMessage max size: {}, actually size: {}", NETWORKMESSAGE_MAXSIZE, outputMessageSize);
+		return false;
+	}
+
+	if (compressionBackoff > 0) {
+		--compressionBackoff;
+		std::scoped_lock lock { compressionStatsLock };
+		++compressionStats.skipped;
+		return false;
+	}
+
+	// Per packet mode shares one stream per network thread, reset after every packet
+	static thread_local const auto threadCompress = std::make_unique<ZStream>(THREAD_WINDOW_BITS, THREAD_MEM_LEVEL);
+	static thread_local const auto buffer = std::make_unique<std::array<char, NETWORKMESSAGE_MAXSIZE>>();
+	if (streamingCompression && !compressStream) {
+		compressStream = std::make_unique<ZStream>(STREAM_WINDOW_BITS, STREAM_MEM_LEVEL);
+	}
 
+	const auto &compress = streamingCompression ? compressStream : threadCompress;
 	if (!compress->stream) {
 		return false;
 	}
 
-	const auto outputMessageSize = outputMessage.getLength();
-	if (outputMessageSize > NETWORKMESSAGE_MAXSIZE) {
-		g_logger().error("[NetworkMessage::compression] - Exceded NetworkMessage max size: {}, actually size: {}", NETWORKMESSAGE_MAXSIZE, outputMessageSize);
+	auto* stream = compress->stream.get();
+	// Whatever goes into a streaming deflate has to be sent, so never feed what may not fit
+	if (deflateBound(stream, outputMessageSize) + 16 > buffer->size()) {
 		return false;
 	}
 
-	compress->stream->next_in = outputMessage.getOutputBuffer();
-	compress->stream->avail_in = outputMessageSize;
-	compress->stream->next_out = reinterpret_cast<Bytef*>(compress->buffer.data());
-	compress->stream->avail_out = NETWORKMESSAGE_MAXSIZE;
+	const auto start = std::chrono::steady_clock::now();
+
+	stream->next_out = reinterpret_cast<Bytef*>(buffer->data());
+	stream->avail_out = buffer->size();
+
+	// Switched before the packet is fed, otherwise deflateParams compresses it at the old level.
+	// Whatever it flushes of the stream history lands in the buffer ahead of this packet.
+	if (const auto level = adaptiveCompressionLevel(compress->baseLevel); level != compress->level) {
+		stream->avail_in = 0;
+		const auto paramsRet = deflateParams(stream, level, Z_DEFAULT_STRATEGY);
+		if (paramsRet == Z_OK) {
+			compress->level = level;
+		} else if (paramsRet != Z_BUF_ERROR) {
+			g_logger().error("[Protocol::compression] - Failed to change the compression level to {}, error: {}", level, paramsRet);
+		}
+	}
+
+	stream->next_in = outputMessage.getOutputBuffer();
+	stream->avail_in = outputMessageSize;
+
+	const int32_t ret = deflate(stream, streamingCompression ? Z_SYNC_FLUSH : Z_FINISH);
+	const auto totalSize = buffer->size() - stream->avail_out;
+	if (!streamingCompression) {
+		deflateReset(stream);
+	}
+
+	const auto elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	addCompressionTime(elapsedNs);
 
-	const int32_t ret = deflate(compress->stream.get(), Z_FINISH);
 	if (ret != Z_OK && ret != Z_STREAM_END) {
+		if (streamingCompression) {
+			// The client history is lost, stop compressing this connection
+			deflateEnd(stream);
+			compressStream->stream.reset();
+		}
 		return false;
 	}
 
-	const auto totalSize = compress->stream->total_out;
-	deflateReset(compress->stream.get());
-
 	if (totalSize == 0) {
 		return false;
 	}
 
+	addCompressionStats(outputMessageSize, totalSize, elapsedNs);
+
+	// Incompressible payload, in per packet mode it is simply sent as it is
+	if (totalSize >= outputMessageSize) {
+		compressionBackoff = COMPRESSION_BACKOFF;
+		if (!streamingCompression) {
+			return false;
+		}
+	}
+
 	outputMessage.reset();
-	outputMessage.addBytes(compress->buffer.data(), totalSize);
+	outputMessage.addBytes(buffer->data(), totalSize);
 
 	return true;
 }
 
-Protocol::ZStream::ZStream() noexcept {
+void Protocol::addCompressionStats(size_t bytesIn, size_t bytesOut, uint64_t cpuNs) {
+	const auto add = [&](CompressionStats &stats) {
+		stats.bytesIn += bytesIn;
+		stats.bytesOut += bytesOut;
+		stats.cpuNs += cpuNs;
+		++stats.compressed;
+	};
+	add(pendingCompressionStats);
+	{
+		std::scoped_lock lock { compressionStatsLock };
+		add(compressionStats);
+	}
+
+	if (pendingCompressionStats.compressed >= COMPRESSION_STATS_FLUSH) {
+		g_metrics().addCounter("network_compression_bytes_in", static_cast<double>(pendingCompressionStats.bytesIn));
+		g_metrics().addCounter("network_compression_bytes_out", static_cast<double>(pendingCompressionStats.bytesOut));
+		g_metrics().addCounter("network_compression_cpu_us", static_cast<double>(pendingCompressionStats.cpuNs) / 1000);
+		pendingCompressionStats = {};
+	}
+}
+
+Protocol::ZStream::ZStream(int32_t windowBits, int32_t memLevel) noexcept {
 	const int32_t compressionLevel = g_configManager().getNumber(COMPRESSION_LEVEL);
 	if (compressionLevel <= 0) {
 		return;
 	}
 
+	baseLevel = compressionLevel;
+	level = compressionLevel;
+
 	stream = std::make_unique<z_stream>();
 	stream->zalloc = nullptr;
 	stream->zfree = nullptr;
 	stream->opaque = nullptr;
 
-	if (deflateInit2(stream.get(), compressionLevel, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
-		stream.reset();
+	// Raw deflate, a smaller window is still read by the client's 15 bit inflate window
+	if (deflateInit2(stream.get(), compressionLevel, Z_DEFLATED, -windowBits, memLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
 		g_logger().error("[Protocol::enableCompression()] - Zlib deflateInit2 error: {}", (stream->msg ? stream->msg : " unknown error"));
+		stream.reset();
 	}
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "server/server_definitions.hpp"
+#include "security/xtea.hpp"
 
 class OutputMessage;
 using OutputMessage_ptr = std::shared_ptr<OutputMessage>;
@@ -60,6 +61,20 @@ public:
 
 	void send(OutputMessage_ptr msg) const;
 
+	struct CompressionStats {
+		uint64_t bytesIn = 0;
+		uint64_t bytesOut = 0;
+		uint64_t cpuNs = 0;
+		uint32_t compressed = 0;
+		uint32_t skipped = 0; // Sent as they are, after packets that did not shrink
+	};
+
+	// Totals of the connection, safe to read from any thread
+	CompressionStats getCompressionStats() const {
+		std::scoped_lock lock { compressionStatsLock };
+		return compressionStats;
+	}
+
 protected:
 	void disconnect() const;
 
@@ -67,7 +82,9 @@ protected:
 		encryptionEnabled = true;
 	}
 	void setXTEAKey(const uint32_t* newKey) {
-		std::ranges::copy(newKey, newKey + 4, this->key.begin());
+		xtea::Key key;
+		std::ranges::copy(newKey, newKey + 4, key.begin());
+		xteaKeys = xtea::expandKey(key);
 	}
 
 	void setChecksumMethod(ChecksumMethods_t method) {
@@ -84,30 +101,50 @@ protected:
 
 private:
 	struct ZStream {
-		ZStream() noexcept;
+		ZStream(int32_t windowBits, int32_t memLevel) noexcept;
 
 		~ZStream() {
 			deflateEnd(stream.get());
 		}
 
 		std::unique_ptr<z_stream> stream;
-		std::array<char, NETWORKMESSAGE_MAXSIZE> buffer {};
+		int32_t baseLevel = 0;
+		int32_t level = 0;
 	};
 
-	void XTEA_transform(uint8_t* buffer, size_t messageLength, bool encrypt) const;
+	// Packets that did not shrink make the next ones skip compression
+	static constexpr uint8_t COMPRESSION_BACKOFF = 8;
+	static constexpr uint32_t COMPRESSION_STATS_FLUSH = 64;
+	// Deflate keeps (1 << (windowBits + 2)) + (1 << (memLevel + 9)) bytes, the per thread stream uses the
+	// zlib maximum (about 389 KB with its state), a per connection stream a smaller window and hash (about 53 KB)
+	static constexpr int32_t THREAD_WINDOW_BITS = 15;
+	static constexpr int32_t THREAD_MEM_LEVEL = 9;
+	static constexpr int32_t STREAM_WINDOW_BITS = 12;
+	static constexpr int32_t STREAM_MEM_LEVEL = 6;
+
 	void XTEA_encrypt(OutputMessage &msg) const;
 	bool XTEA_decrypt(NetworkMessage &msg) const;
-	bool compression(OutputMessage &msg) const;
+	bool compression(OutputMessage &msg);
+	void addCompressionStats(size_t bytesIn, size_t bytesOut, uint64_t cpuNs);
 
 	OutputMessage_ptr outputBuffer;
 
 	const ConnectionWeak_ptr connectionPtr;
-	std::array<uint32_t, 4> key = {};
+	xtea::RoundKeys xteaKeys;
 	uint32_t serverSequenceNumber = 0;
 	uint32_t clientSequenceNumber = 0;
 	std::underlying_type_t<ChecksumMethods_t> checksumMethod = CHECKSUM_METHOD_NONE;
 	bool encryptionEnabled = false;
 	bool rawMessages = false;
 
+	// Streaming mode keeps the deflate history of the connection (sync flush between packets)
+	std::unique_ptr<ZStream> compressStream;
+	CompressionStats compressionStats;
+	mutable std::mutex compressionStatsLock;
+	// Not yet added to the metrics counters, only touched by the network thread
+	CompressionStats pendingCompressionStats;
+	uint8_t compressionBackoff = 0;
+	bool streamingCompression = false;
+
 	friend class Connection;
 };
@@ -573,43 +573,7 @@ void ProtocolGame::login(const std::string &name, uint32_t accountId, OperatingS
 			return;
 		}
 
-		if (g_game().getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin)) {
-			disconnectClient("The game is just going down.\nPlease try again later.");
-			return;
-		}
-
-		if (g_game().getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin)) {
-			auto maintainMessage = g_configManager().getString(MAINTAIN_MODE_MESSAGE);
-			if (!maintainMessage.empty()) {
-				disconnectClient(maintainMessage);
-			} else {
-				disconnectClient("Server is currently closed.\nPlease try again later.");
-			}
-			return;
-		}
-
-		bool maxClientsByIP = g_configManager().getBoolean(TOGGLE_MAX_CONNECTIONS_BY_IP);
-		if (maxClientsByIP && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin)) {
-			uint32_t ip = player->getIP();
-			std::vector<std::shared_ptr<Player>> playersByIP = g_game().getPlayersByIP(ip);
-			uint32_t maxConnections = static_cast<uint32_t>(g_configManager().getNumber(MAX_IP_CONNECTIONS));
-			if ((playersByIP.size() + 1) > maxConnections) {
-				std::stringstream maxConnectMsg;
-				maxConnectMsg << "You have been disconnected. The maximum number of connections allowed per IP is " << maxConnections << ".";
-				disconnectClient(maxConnectMsg.str().c_str());
-				return;
-			}
-		}
-
-		if (g_configManager().getBoolean(ONLY_PREMIUM_ACCOUNT) && !player->isPremium() && (player->getGroup()->id < GROUP_TYPE_GAMEMASTER || player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER)) {
-			disconnectClient("Your premium time for this account is out.\n\nTo play please buy additional premium time from our website");
-			return;
-		}
-
-		auto onlineCount = g_game().getPlayersByAccount(player->getAccount()).size();
-		auto maxOnline = g_configManager().getNumber(MAX_PLAYERS_PER_ACCOUNT);
-		if (player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && onlineCount >= maxOnline) {
-			disconnectClient(fmt::format("You may only login with {} character{}\nof your account at the same time.", maxOnline, maxOnline > 1 ? "s" : ""));
+		if (!canEnterGame()) {
 			return;
 		}
 
@@ -652,60 +616,142 @@ void ProtocolGame::login(const std::string &name, uint32_t accountId, OperatingS
 			return;
 		}
 
-		if (!IOLoginData::loadPlayerById(player, player->getGUID(), false)) {
-			disconnectClient("Your character could not be loaded.");
-			g_logger().warn("Player {} could not be loaded", player->getName());
-			return;
-		}
+		IOLoginData::loadPlayerAsync(player, false, [self = getThis(), operatingSystem](bool loaded) {
+			self->finishLogin(operatingSystem, loaded);
+		});
+		return;
+	}
 
-		player->setOperatingSystem(operatingSystem);
+	replaceLogin(foundPlayer, operatingSystem);
+}
 
-		const auto tile = g_game().map.getOrCreateTile(player->getLoginPosition());
-		// moving from a pz tile to a non-pz tile
-		if (maxOnline > 1 && player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && !tile->hasFlag(TILESTATE_PROTECTIONZONE)) {
-			auto maxOutsizePZ = g_configManager().getNumber(MAX_PLAYERS_OUTSIDE_PZ_PER_ACCOUNT);
-			auto accountPlayers = g_game().getPlayersByAccount(player->getAccount());
-			int countOutsizePZ = 0;
-			for (const auto &accountPlayer : accountPlayers) {
-				if (accountPlayer != player && accountPlayer->getTile() && !accountPlayer->getTile()->hasFlag(TILESTATE_PROTECTIONZONE)) {
-					++countOutsizePZ;
-				}
-			}
-			if (countOutsizePZ >= maxOutsizePZ) {
-				disconnectClient(fmt::format("You can only have {} character{} from your account outside of a protection zone.", maxOutsizePZ == 1 ? "one" : std::to_string(maxOutsizePZ), maxOutsizePZ > 1 ? "s" : ""));
-				return;
-			}
+bool ProtocolGame::canEnterGame() const {
+	// Saves and kicks already ran, nobody may be placed anymore
+	if (g_game().getGameState() == GAME_STATE_SHUTDOWN) {
+		disconnectClient("The game is just going down.\nPlease try again later.");
+		return false;
+	}
+
+	if (g_game().getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin)) {
+		disconnectClient("The game is just going down.\nPlease try again later.");
+		return false;
+	}
+
+	if (g_game().getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin)) {
+		auto maintainMessage = g_configManager().getString(MAINTAIN_MODE_MESSAGE);
+		if (!maintainMessage.empty()) {
+			disconnectClient(maintainMessage);
+		} else {
+			disconnectClient("Server is currently closed.\nPlease try again later.");
 		}
+		return false;
+	}
 
-		if (!g_game().placeCreature(player, player->getLoginPosition()) && !g_game().placeCreature(player, player->getTemplePosition(), false, true)) {
-			disconnectClient("Temple position is wrong. Please, contact the administrator.");
-			g_logger().warn("Player {} temple position is wrong", player->getName());
-			return;
+	bool maxClientsByIP = g_configManager().getBoolean(TOGGLE_MAX_CONNECTIONS_BY_IP);
+	if (maxClientsByIP && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin)) {
+		uint32_t ip = player->getIP();
+		std::vector<std::shared_ptr<Player>> playersByIP = g_game().getPlayersByIP(ip);
+		uint32_t maxConnections = static_cast<uint32_t>(g_configManager().getNumber(MAX_IP_CONNECTIONS));
+		if ((playersByIP.size() + 1) > maxConnections) {
+			std::stringstream maxConnectMsg;
+			maxConnectMsg << "You have been disconnected. The maximum number of connections allowed per IP is " << maxConnections << ".";
+			disconnectClient(maxConnectMsg.str().c_str());
+			return false;
 		}
+	}
+
+	if (g_configManager().getBoolean(ONLY_PREMIUM_ACCOUNT) && !player->isPremium() && (player->getGroup()->id < GROUP_TYPE_GAMEMASTER || player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER)) {
+		disconnectClient("Your premium time for this account is out.\n\nTo play please buy additional premium time from our website");
+		return false;
+	}
+
+	auto onlineCount = g_game().getPlayersByAccount(player->getAccount()).size();
+	auto maxOnline = g_configManager().getNumber(MAX_PLAYERS_PER_ACCOUNT);
+	if (player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && onlineCount >= maxOnline) {
+		disconnectClient(fmt::format("You may only login with {} character{}\nof your account at the same time.", maxOnline, maxOnline > 1 ? "s" : ""));
+		return false;
+	}
+
+	return true;
+}
+
+void ProtocolGame::replaceLogin(const std::shared_ptr<Player> &foundPlayer, OperatingSystem_t operatingSystem) {
+	if (eventConnect != 0 || !g_configManager().getBoolean(REPLACE_KICK_ON_LOGIN)) {
+		// Already trying to connect
+		disconnectClient("You are already logged in.");
+		return;
+	}
+
+	if (foundPlayer->client) {
+		foundPlayer->disconnect();
+		foundPlayer->isConnecting = true;
 
-		player->lastIP = player->getIP();
-		player->lastLoad = OTSYS_TIME();
-		player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
-		acceptPackets = true;
+		eventConnect = g_dispatcher().scheduleEvent(
+			1000,
+			[self = getThis(), playerName = foundPlayer->getName(), operatingSystem] { self->connect(playerName, operatingSystem); }, "ProtocolGame::connect"
+		);
 	} else {
-		if (eventConnect != 0 || !g_configManager().getBoolean(REPLACE_KICK_ON_LOGIN)) {
-			// Already trying to connect
-			disconnectClient("You are already logged in.");
-			return;
-		}
+		connect(foundPlayer->getName(), operatingSystem);
+	}
+	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
+	sendBosstiaryCooldownTimer();
+}
 
-		if (foundPlayer->client) {
-			foundPlayer->disconnect();
-			foundPlayer->isConnecting = true;
+void ProtocolGame::finishLogin(OperatingSystem_t operatingSystem, bool loaded) {
+	if (!player || isConnectionExpired()) {
+		// ProtocolGame::release() ran while the player was loading, nobody is waiting for it anymore
+		return;
+	}
 
-			eventConnect = g_dispatcher().scheduleEvent(
-				1000,
-				[self = getThis(), playerName = foundPlayer->getName(), operatingSystem] { self->connect(playerName, operatingSystem); }, "ProtocolGame::connect"
-			);
-		} else {
-			connect(foundPlayer->getName(), operatingSystem);
+	// Another login of the same character got in while this one was loading, take it over like login() would
+	if (const auto foundPlayer = g_game().getPlayerByName(player->getName())) {
+		player = nullptr;
+		replaceLogin(foundPlayer, operatingSystem);
+		return;
+	}
+
+	if (!loaded) {
+		disconnectClient("Your character could not be loaded.");
+		g_logger().warn("Player {} could not be loaded", player->getName());
+		return;
+	}
+
+	// Nothing holds a slot while the load runs, the game state and the limits may have changed since login()
+	if (!canEnterGame()) {
+		return;
+	}
+
+	player->setOperatingSystem(operatingSystem);
+
+	const auto maxOnline = g_configManager().getNumber(MAX_PLAYERS_PER_ACCOUNT);
+	const auto tile = g_game().map.getOrCreateTile(player->getLoginPosition());
+	// moving from a pz tile to a non-pz tile
+	if (maxOnline > 1 && player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && !tile->hasFlag(TILESTATE_PROTECTIONZONE)) {
+		auto maxOutsizePZ = g_configManager().getNumber(MAX_PLAYERS_OUTSIDE_PZ_PER_ACCOUNT);
+		auto accountPlayers = g_game().getPlayersByAccount(player->getAccount());
+		int countOutsizePZ = 0;
+		for (const auto &accountPlayer : accountPlayers) {
+			if (accountPlayer != player && accountPlayer->getTile() && !accountPlayer->getTile()->hasFlag(TILESTATE_PROTECTIONZONE)) {
+				++countOutsizePZ;
+			}
+		}
+		if (countOutsizePZ >= maxOutsizePZ) {
+			disconnectClient(fmt::format("You can only have {} character{} from your account outside of a protection zone.", maxOutsizePZ == 1 ? "one" : std::to_string(maxOutsizePZ), maxOutsizePZ > 1 ? "s" : ""));
+			return;
 		}
 	}
+
+	if (!g_game().placeCreature(player, player->getLoginPosition()) && !g_game().placeCreature(player, player->getTemplePosition(), false, true)) {
+		disconnectClient("Temple position is wrong. Please, contact the administrator.");
+		g_logger().warn("Player {} temple position is wrong", player->getName());
+		return;
+	}
+
+	player->lastIP = player->getIP();
+	player->lastLoad = OTSYS_TIME();
+	player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
+	acceptPackets = true;
+
 	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
 	sendBosstiaryCooldownTimer();
 }
@@ -858,22 +904,6 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage &msg) {
 
 	std::string characterName = msg.getString();
 
-	const auto &onlinePlayer = g_game().getPlayerByName(characterName);
-	const auto &foundPlayer = !onlinePlayer ? g_game().getDeadPlayer(characterName) : onlinePlayer;
-	if (foundPlayer && foundPlayer->client) {
-		if (foundPlayer->isDead()) {
-			disconnectClient("You are already logged in.");
-			return;
-		}
-
-		auto message = fmt::format("You are already connected through another client. Please use only one client at a time!");
-		if (foundPlayer->getProtocolVersion() != getVersion() && foundPlayer->isOldProtocol() != oldProtocol) {
-			message = fmt::format("You are already logged in using protocol '{}'. Please log out from the other session to connect here.", foundPlayer->getProtocolVersion());
-		}
-
-		foundPlayer->client->disconnectClient(message);
-	}
-
 	auto timeStamp = msg.get<uint32_t>();
 	uint8_t randNumber = msg.getByte();
 	if (challengeTimestamp != timeStamp || challengeRandom != randNumber) {
@@ -940,7 +970,36 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage &msg) {
 		return;
 	}
 
-	g_dispatcher().addEvent([self = getThis(), characterName, accountId, operatingSystem] { self->login(characterName, accountId, operatingSystem); }, __FUNCTION__);
+	// This runs on a network thread, everything touching the game happens in the dispatcher event
+	g_dispatcher().addEvent(
+		[self = getThis(), characterName, accountId, operatingSystem] {
+			if (self->disconnectOtherClient(characterName)) {
+				self->login(characterName, accountId, operatingSystem);
+			}
+		},
+		__FUNCTION__
+	);
+}
+
+bool ProtocolGame::disconnectOtherClient(const std::string &characterName) const {
+	const auto &onlinePlayer = g_game().getPlayerByName(characterName);
+	const auto &foundPlayer = !onlinePlayer ? g_game().getDeadPlayer(characterName) : onlinePlayer;
+	if (!foundPlayer || !foundPlayer->client) {
+		return true;
+	}
+
+	if (foundPlayer->isDead()) {
+		disconnectClient("You are already logged in.");
+		return false;
+	}
+
+	auto message = fmt::format("You are already connected through another client. Please use only one client at a time!");
+	if (foundPlayer->getProtocolVersion() != getVersion() && foundPlayer->isOldProtocol() != oldProtocol) {
+		message = fmt::format("You are already logged in using protocol '{}'. Please log out from the other session to connect here.", foundPlayer->getProtocolVersion());
+	}
+
+	foundPlayer->client->disconnectClient(message);
+	return true;
 }
 
 void ProtocolGame::sendLoginChallenge() {
@@ -985,6 +1044,12 @@ void ProtocolGame::writeToOutputBuffer(NetworkMessage &msg) {
 	});
 }
 
+void ProtocolGame::writeToOutputBuffer(const SharedMessage_ptr &msg) {
+	g_dispatcher().safeCall([self = getThis(), msg] {
+		self->getOutputBuffer(static_cast<int32_t>(msg->size()))->append(*msg);
+	});
+}
+
 void ProtocolGame::parsePacket(NetworkMessage &msg) {
 	if (!acceptPackets || g_game().getGameState() == GAME_STATE_SHUTDOWN || msg.getLength() <= 0) {
 		return;
@@ -1487,26 +1552,19 @@ void ProtocolGame::GetTileDescription(const std::shared_ptr<Tile> &tile, Network
 		msg.add<uint16_t>(0x00); // Env effects
 	}
 
-	int32_t count;
-	std::shared_ptr<Item> ground = tile->getGround();
-	if (ground) {
-		AddItem(msg, ground);
-		count = 1;
-	} else {
-		count = 0;
-	}
+	TileItemsEncoding uncached;
+	const auto &encoding = getTileItemsEncoding(tile, uncached);
+	const bool isPlayerTile = tile->getPosition() == player->getPosition();
 
-	const TileItemVector* items = tile->getItemList();
-	if (items) {
-		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end; ++it) {
-			AddItem(msg, *it);
+	int32_t count = 0;
+	for (size_t i = 0; i < encoding.topItems; ++i) {
+		addEncodedItem(msg, encoding, i);
 
-			count++;
-			if (count == 9 && tile->getPosition() == player->getPosition()) {
-				break;
-			} else if (count == 10) {
-				return;
-			}
+		count++;
+		if (count == 9 && isPlayerTile) {
+			break;
+		} else if (count == 10) {
+			return;
 		}
 	}
 
@@ -1518,7 +1576,7 @@ void ProtocolGame::GetTileDescription(const std::shared_ptr<Tile> &tile, Network
 				continue;
 			}
 
-			if (tile->getPosition() == player->getPosition() && count == 9 && !playerAdded) {
+			if (isPlayerTile && count == 9 && !playerAdded) {
 				creature = player;
 			}
 
@@ -1537,15 +1595,67 @@ void ProtocolGame::GetTileDescription(const std::shared_ptr<Tile> &tile, Network
 		}
 	}
 
+	for (size_t i = encoding.topItems; i < encoding.ends.size(); ++i) {
+		addEncodedItem(msg, encoding, i);
+
+		if (++count == 10) {
+			return;
+		}
+	}
+}
+
+const TileItemsEncoding &ProtocolGame::getTileItemsEncoding(const std::shared_ptr<Tile> &tile, TileItemsEncoding &uncached) {
+	if (const auto* cached = tile->getItemsEncoding(oldProtocol)) {
+		return *cached;
+	}
+
+	// Map items are never held by a player, so AddItem writes the same bytes for every viewer
+	static thread_local NetworkMessage scratch;
+	scratch.reset();
+
+	const auto start = scratch.getBufferPosition();
+	bool cacheable = true;
+	auto encodeItem = [&](const std::shared_ptr<Item> &item) {
+		const ItemType &it = Item::items[item->getID()];
+		if (it.expire || it.expireStop || it.clockExpire) {
+			cacheable = false;
+		}
+		AddItem(scratch, item);
+		uncached.ends.emplace_back(static_cast<uint16_t>(scratch.getBufferPosition() - start));
+	};
+
+	// No more than 10 things are sent per tile, the rest is never needed
+	if (const auto &ground = tile->getGround()) {
+		encodeItem(ground);
+	}
+
+	const TileItemVector* items = tile->getItemList();
 	if (items) {
-		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
-			AddItem(msg, *it);
+		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end && uncached.ends.size() < 10; ++it) {
+			encodeItem(*it);
+		}
+	}
+	uncached.topItems = static_cast<uint8_t>(uncached.ends.size());
 
-			if (++count == 10) {
-				return;
-			}
+	if (items) {
+		size_t downItems = 0;
+		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end && downItems < 10; ++it, ++downItems) {
+			encodeItem(*it);
 		}
 	}
+
+	const auto* bytes = scratch.getBuffer() + start;
+	uncached.bytes.assign(bytes, bytes + (scratch.getBufferPosition() - start));
+
+	if (!cacheable) {
+		return uncached;
+	}
+	return tile->setItemsEncoding(oldProtocol, std::move(uncached));
+}
+
+void ProtocolGame::addEncodedItem(NetworkMessage &msg, const TileItemsEncoding &encoding, size_t index) {
+	const size_t begin = index == 0 ? 0 : encoding.ends[index - 1];
+	msg.addBytes(reinterpret_cast<const char*>(encoding.bytes.data() + begin), encoding.ends[index] - begin);
 }
 
 void ProtocolGame::GetMapDescription(int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, NetworkMessage &msg) {
@@ -4741,6 +4851,23 @@ void ProtocolGame::sendTextMessage(const TextMessage &message) {
 		return;
 	}
 
+	NetworkMessage msg;
+	encodeTextMessage(msg, oldProtocol, message);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::sendTextMessage(BroadcastMessage &broadcast, const TextMessage &message) {
+	if (message.type == MESSAGE_NONE) {
+		sendTextMessage(message);
+		return;
+	}
+
+	writeToOutputBuffer(broadcast.get(oldProtocol, [&](NetworkMessage &msg, bool old) {
+		encodeTextMessage(msg, old, message);
+	}));
+}
+
+void ProtocolGame::encodeTextMessage(NetworkMessage &msg, bool oldProtocol, const TextMessage &message) {
 	MessageClasses internalType = message.type;
 	if (oldProtocol && message.type > MESSAGE_LAST_OLDPROTOCOL) {
 		switch (internalType) {
@@ -4800,7 +4927,6 @@ void ProtocolGame::sendTextMessage(const TextMessage &message) {
 		}
 	}
 
-	NetworkMessage msg;
 	msg.addByte(0xB4);
 	msg.addByte(internalType);
 	switch (internalType) {
@@ -4841,7 +4967,6 @@ void ProtocolGame::sendTextMessage(const TextMessage &message) {
 			break;
 	}
 	msg.addString(message.text);
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendClosePrivate(uint16_t channelId) {
@@ -6553,6 +6678,17 @@ void ProtocolGame::sendCreatureTurn(const std::shared_ptr<Creature> &creature, u
 
 void ProtocolGame::sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos /* = nullptr*/) {
 	NetworkMessage msg;
+	encodeCreatureSay(msg, oldProtocol, creature, type, text, pos);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::sendCreatureSay(BroadcastMessage &broadcast, const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos /* = nullptr*/) {
+	writeToOutputBuffer(broadcast.get(oldProtocol, [&](NetworkMessage &msg, bool old) {
+		encodeCreatureSay(msg, old, creature, type, text, pos);
+	}));
+}
+
+void ProtocolGame::encodeCreatureSay(NetworkMessage &msg, bool oldProtocol, const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos) {
 	msg.addByte(0xAA);
 
 	static uint32_t statementId = 0;
@@ -6584,7 +6720,6 @@ void ProtocolGame::sendCreatureSay(const std::shared_ptr<Creature> &creature, Sp
 	}
 
 	msg.addString(text);
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendToChannel(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, uint16_t channelId) {
@@ -6707,6 +6842,20 @@ void ProtocolGame::sendDistanceShoot(const Position &from, const Position &to, u
 		return;
 	}
 	NetworkMessage msg;
+	encodeDistanceShoot(msg, oldProtocol, from, to, type);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::sendDistanceShoot(BroadcastMessage &broadcast, const Position &from, const Position &to, uint16_t type) {
+	if (oldProtocol && type > 0xFF) {
+		return;
+	}
+	writeToOutputBuffer(broadcast.get(oldProtocol, [&](NetworkMessage &msg, bool old) {
+		encodeDistanceShoot(msg, old, from, to, type);
+	}));
+}
+
+void ProtocolGame::encodeDistanceShoot(NetworkMessage &msg, bool oldProtocol, const Position &from, const Position &to, uint16_t type) {
 	if (oldProtocol) {
 		msg.addByte(0x85);
 		msg.addPosition(from);
@@ -6721,7 +6870,6 @@ void ProtocolGame::sendDistanceShoot(const Position &from, const Position &to, u
 		msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.y) - static_cast<int32_t>(from.y))));
 		msg.addByte(MAGIC_EFFECTS_END_LOOP);
 	}
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendRestingStatus(uint8_t protection) {
@@ -6775,6 +6923,21 @@ void ProtocolGame::sendMagicEffect(const Position &pos, uint16_t type) {
 	}
 
 	NetworkMessage msg;
+	encodeMagicEffect(msg, oldProtocol, pos, type);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::sendMagicEffect(BroadcastMessage &broadcast, const Position &pos, uint16_t type) {
+	if (!canSee(pos) || (oldProtocol && type > 0xFF)) {
+		return;
+	}
+
+	writeToOutputBuffer(broadcast.get(oldProtocol, [&](NetworkMessage &msg, bool old) {
+		encodeMagicEffect(msg, old, pos, type);
+	}));
+}
+
+void ProtocolGame::encodeMagicEffect(NetworkMessage &msg, bool oldProtocol, const Position &pos, uint16_t type) {
 	if (oldProtocol) {
 		msg.addByte(0x83);
 		msg.addPosition(pos);
@@ -6786,7 +6949,6 @@ void ProtocolGame::sendMagicEffect(const Position &pos, uint16_t type) {
 		msg.add<uint16_t>(type);
 		msg.addByte(MAGIC_EFFECTS_END_LOOP);
 	}
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::removeMagicEffect(const Position &pos, uint16_t type) {
@@ -6794,6 +6956,20 @@ void ProtocolGame::removeMagicEffect(const Position &pos, uint16_t type) {
 		return;
 	}
 	NetworkMessage msg;
+	encodeRemoveMagicEffect(msg, oldProtocol, pos, type);
+	writeToOutputBuffer(msg);
+}
+
+void ProtocolGame::removeMagicEffect(BroadcastMessage &broadcast, const Position &pos, uint16_t type) {
+	if (oldProtocol && type > 0xFF) {
+		return;
+	}
+	writeToOutputBuffer(broadcast.get(oldProtocol, [&](NetworkMessage &msg, bool old) {
+		encodeRemoveMagicEffect(msg, old, pos, type);
+	}));
+}
+
+void ProtocolGame::encodeRemoveMagicEffect(NetworkMessage &msg, bool oldProtocol, const Position &pos, uint16_t type) {
 	msg.addByte(0x84);
 	msg.addPosition(pos);
 	if (oldProtocol) {
@@ -6801,7 +6977,6 @@ void ProtocolGame::removeMagicEffect(const Position &pos, uint16_t type) {
 	} else {
 		msg.add<uint16_t>(type);
 	}
-	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendCreatureHealth(const std::shared_ptr<Creature> &creature) {
@@ -7289,10 +7464,7 @@ void ProtocolGame::sendMoveCreature(const std::shared_ptr<Creature> &creature, c
 			sendAddCreature(creature, newPos, newStackPos, false);
 		} else {
 			NetworkMessage msg;
-			msg.addByte(0x6D);
-			msg.addPosition(oldPos);
-			msg.addByte(static_cast<uint8_t>(oldStackPos));
-			msg.addPosition(newPos);
+			encodeMoveCreature(msg, newPos, oldPos, oldStackPos);
 			writeToOutputBuffer(msg);
 		}
 	} else if (canSee(oldPos)) {
@@ -7302,6 +7474,26 @@ void ProtocolGame::sendMoveCreature(const std::shared_ptr<Creature> &creature, c
 	}
 }
 
+void ProtocolGame::sendMoveCreature(BroadcastMessage &broadcast, const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport) {
+	// Only the plain step seen by others is the same for every viewer, it still depends on the stack position
+	const bool step = !teleport && !(oldPos.z == MAP_INIT_SURFACE_LAYER && newPos.z >= MAP_INIT_SURFACE_LAYER + 1) && oldStackPos < 10;
+	if (creature == player || !step || !canSee(oldPos) || !canSee(newPos)) {
+		sendMoveCreature(creature, newPos, newStackPos, oldPos, oldStackPos, teleport);
+		return;
+	}
+
+	writeToOutputBuffer(broadcast.getKeyed(static_cast<uint32_t>(oldStackPos), [&](NetworkMessage &msg) {
+		encodeMoveCreature(msg, newPos, oldPos, oldStackPos);
+	}));
+}
+
+void ProtocolGame::encodeMoveCreature(NetworkMessage &msg, const Position &newPos, const Position &oldPos, int32_t oldStackPos) {
+	msg.addByte(0x6D);
+	msg.addPosition(oldPos);
+	msg.addByte(static_cast<uint8_t>(oldStackPos));
+	msg.addPosition(newPos);
+}
+
 void ProtocolGame::sendInventoryItem(Slots_t slot, const std::shared_ptr<Item> &item) {
 	NetworkMessage msg;
 	if (item) {
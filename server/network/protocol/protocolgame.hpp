@@ -41,12 +41,15 @@ enum class SourceEffect_t : uint8_t;
 enum class HouseAuctionType : uint8_t;
 
 class NetworkMessage;
+class BroadcastMessage;
+class SharedMessage;
 class Player;
 class VIPGroup;
 class Game;
 class House;
 class Container;
 class Tile;
+struct TileItemsEncoding;
 class Connection;
 class ProtocolGame;
 class PreySlot;
@@ -71,6 +74,7 @@ struct HistoryMarketOffer;
 struct LightInfo;
 
 using ProtocolGame_ptr = std::shared_ptr<ProtocolGame>;
+using SharedMessage_ptr = std::shared_ptr<const SharedMessage>;
 using ItemVector = std::vector<std::shared_ptr<Item>>;
 using InvitedMap = std::map<uint32_t, std::shared_ptr<Player>>;
 using UsersMap = std::map<uint32_t, std::shared_ptr<Player>>;
@@ -127,8 +131,18 @@ private:
 		return std::static_pointer_cast<ProtocolGame>(shared_from_this());
 	}
 	void connect(const std::string &playerName, OperatingSystem_t operatingSystem);
+	// Places the player once its load finished on the database threads
+	void finishLogin(OperatingSystem_t operatingSystem, bool loaded);
+	// Game state and per ip/account limits, disconnects with the reason when the player may not enter
+	bool canEnterGame() const;
+	// Kicks the logged in copy of the character and takes it over when replaceKickOnLogin allows it
+	void replaceLogin(const std::shared_ptr<Player> &foundPlayer, OperatingSystem_t operatingSystem);
+	// Disconnects another client using the character, false when this login must stop. Dispatcher only
+	bool disconnectOtherClient(const std::string &characterName) const;
 	void disconnectClient(const std::string &message) const;
 	void writeToOutputBuffer(NetworkMessage &msg);
+	// Appends a broadcast body shared with other connections, no per-viewer copy of the message
+	void writeToOutputBuffer(const SharedMessage_ptr &msg);
 
 	void release() override;
 
@@ -320,8 +334,14 @@ private:
 
 	void sendAllowBugReport();
 	void sendDistanceShoot(const Position &from, const Position &to, uint16_t type);
+	void sendDistanceShoot(BroadcastMessage &broadcast, const Position &from, const Position &to, uint16_t type);
 	void sendMagicEffect(const Position &pos, uint16_t type);
+	void sendMagicEffect(BroadcastMessage &broadcast, const Position &pos, uint16_t type);
 	void removeMagicEffect(const Position &pos, uint16_t type);
+	void removeMagicEffect(BroadcastMessage &broadcast, const Position &pos, uint16_t type);
+	static void encodeDistanceShoot(NetworkMessage &msg, bool oldProtocol, const Position &from, const Position &to, uint16_t type);
+	static void encodeMagicEffect(NetworkMessage &msg, bool oldProtocol, const Position &pos, uint16_t type);
+	static void encodeRemoveMagicEffect(NetworkMessage &msg, bool oldProtocol, const Position &pos, uint16_t type);
 	void sendRestingStatus(uint8_t protection);
 	void sendCreatureHealth(const std::shared_ptr<Creature> &creature);
 	void sendPartyCreatureUpdate(const std::shared_ptr<Creature> &target);
@@ -337,6 +357,8 @@ private:
 	void sendPingBack();
 	void sendCreatureTurn(const std::shared_ptr<Creature> &creature, uint32_t stackpos);
 	void sendCreatureSay(const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos = nullptr);
+	void sendCreatureSay(BroadcastMessage &broadcast, const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos = nullptr);
+	static void encodeCreatureSay(NetworkMessage &msg, bool oldProtocol, const std::shared_ptr<Creature> &creature, SpeakClasses type, const std::string &text, const Position* pos);
 
 	// Unjust Panel
 	void sendUnjustifiedPoints(const uint8_t &dayProgress, const uint8_t &dayLeft, const uint8_t &weekProgress, const uint8_t &weekLeft, const uint8_t &monthProgress, const uint8_t &monthLeft, const uint8_t &skullDuration);
@@ -348,6 +370,8 @@ private:
 	void sendStats();
 	void sendBasicData();
 	void sendTextMessage(const TextMessage &message);
+	void sendTextMessage(BroadcastMessage &broadcast, const TextMessage &message);
+	static void encodeTextMessage(NetworkMessage &msg, bool oldProtocol, const TextMessage &message);
 	void sendReLoginWindow(uint8_t unfairFightReduction);
 
 	void sendTutorial(uint8_t tutorialId);
@@ -446,6 +470,8 @@ private:
 
 	void sendAddCreature(const std::shared_ptr<Creature> &creature, const Position &pos, int32_t stackpos, bool isLogin);
 	void sendMoveCreature(const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport);
+	void sendMoveCreature(BroadcastMessage &broadcast, const std::shared_ptr<Creature> &creature, const Position &newPos, int32_t newStackPos, const Position &oldPos, int32_t oldStackPos, bool teleport);
+	static void encodeMoveCreature(NetworkMessage &msg, const Position &newPos, const Position &oldPos, int32_t oldStackPos);
 
 	// containers
 	void sendAddContainerItem(uint8_t cid, uint16_t slot, const std::shared_ptr<Item> &item);
@@ -478,6 +504,9 @@ private:
 	// Help functions
 	// translate a tile to clientreadable format
 	void GetTileDescription(const std::shared_ptr<Tile> &tile, NetworkMessage &msg);
+	// encoded items of a tile, cached on the tile unless they show a running timer
+	const TileItemsEncoding &getTileItemsEncoding(const std::shared_ptr<Tile> &tile, TileItemsEncoding &uncached);
+	static void addEncodedItem(NetworkMessage &msg, const TileItemsEncoding &encoding, size_t index);
 
 	// translate a floor to clientreadable format
 	void GetFloorDescription(NetworkMessage &msg, int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, int32_t offset, int32_t &skip);
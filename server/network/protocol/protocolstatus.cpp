@@ -24,23 +24,30 @@
 #include "game/scheduling/dispatcher.hpp"
 #include "server/network/message/outputmessage.hpp"
 
+std::mutex ProtocolStatus::ipConnectMapLock;
 std::map<uint32_t, int64_t> ProtocolStatus::ipConnectMap;
 const uint64_t ProtocolStatus::start = OTSYS_TIME(true);
 
 void ProtocolStatus::onRecvFirstMessage(NetworkMessage &msg) {
 	const uint32_t ip = getIP();
-	if (ip != 0x0100007F) {
-		const std::string ipStr = convertIPToString(ip);
-		if (ipStr != g_configManager().getString(IP)) {
+	bool throttled = false;
+	const bool rateLimited = ip != 0x0100007F && convertIPToString(ip) != g_configManager().getString(IP);
+	{
+		std::scoped_lock lock { ipConnectMapLock };
+		if (rateLimited) {
 			const auto it = ipConnectMap.find(ip);
 			if (it != ipConnectMap.end() && (OTSYS_TIME() < (it->second + g_configManager().getNumber(STATUSQUERY_TIMEOUT)))) {
-				disconnect();
-				return;
+				throttled = true;
 			}
 		}
+		if (!throttled) {
+			ipConnectMap[ip] = OTSYS_TIME();
+		}
+	}
+	if (throttled) {
+		disconnect();
+		return;
 	}
-
-	ipConnectMap[ip] = OTSYS_TIME();
 
 	switch (msg.getByte()) {
 		// XML info protocol
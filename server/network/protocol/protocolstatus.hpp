@@ -41,5 +41,7 @@ public:
 	static const uint64_t start;
 
 private:
+	// Status requests arrive on every network thread
+	static std::mutex ipConnectMapLock;
 	static std::map<uint32_t, int64_t> ipConnectMap;
 };
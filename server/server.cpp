@@ -32,6 +32,7 @@ ServiceManager::~ServiceManager() {
 
 void ServiceManager::die() {
 	io_service.stop();
+	io_pool.stop();
 }
 
 void ServiceManager::run() {
@@ -42,6 +43,7 @@ void ServiceManager::run() {
 
 	assert(!running);
 	running = true;
+	io_pool.start(static_cast<uint16_t>(std::max<int32_t>(0, g_configManager().getNumber(NETWORK_THREADS))));
 	io_service.run();
 }
 
@@ -95,7 +97,8 @@ void ServicePort::accept() {
 		return;
 	}
 
-	auto connection = ConnectionManager::getInstance().createConnection(io_service, shared_from_this());
+	// Accepted here, but all further work of the connection runs on its own context
+	auto connection = ConnectionManager::getInstance().createConnection(io_pool.next(), shared_from_this());
 	acceptor->async_accept(connection->getSocket(), [self = shared_from_this(), connection](const std::error_code &error) { self->onAccept(connection, error); });
 }
 
@@ -19,6 +19,7 @@
 
 #include "lib/metrics/metrics.hpp"
 #include "server/network/connection/connection.hpp"
+#include "server/network/connection/io_context_pool.hpp"
 #include "server/signals.hpp"
 
 class Protocol;
@@ -57,8 +58,8 @@ public:
 
 class ServicePort : public std::enable_shared_from_this<ServicePort> {
 public:
-	explicit ServicePort(asio::io_service &init_io_service) :
-		io_service(init_io_service) { }
+	ServicePort(asio::io_service &init_io_service, IoContextPool &init_io_pool) :
+		io_service(init_io_service), io_pool(init_io_pool) { }
 	~ServicePort();
 
 	// non-copyable
@@ -81,6 +82,7 @@ private:
 	void accept();
 
 	asio::io_service &io_service;
+	IoContextPool &io_pool;
 	std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
 	std::vector<Service_ptr> services;
 
@@ -113,6 +115,7 @@ private:
 	phmap::flat_hash_map<uint16_t, ServicePort_ptr> acceptors;
 
 	asio::io_service io_service;
+	IoContextPool io_pool { io_service };
 	Signals signals { io_service };
 	asio::high_resolution_timer death_timer { io_service };
 	bool running = false;
@@ -132,7 +135,7 @@ bool ServiceManager::add(uint16_t port) {
 	const auto foundServicePort = acceptors.find(port);
 
 	if (foundServicePort == acceptors.end()) {
-		service_port = std::make_shared<ServicePort>(io_service);
+		service_port = std::make_shared<ServicePort>(io_service, io_pool);
 		service_port->open(port);
 		acceptors[port] = service_port;
 	} else {
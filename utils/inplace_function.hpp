@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// inplace_function is a move-only std::function replacement that keeps the callable
+// inside the object when it fits in Capacity bytes, so no heap allocation is done.
+// Bigger callables still work, they are boxed on the heap and counted in heapAllocations().
+
+namespace stdext {
+	struct inplace_function_stats {
+		static std::atomic_uint_fast64_t &heapAllocations() {
+			static std::atomic_uint_fast64_t counter = 0;
+			return counter;
+		}
+	};
+
+	template <typename Signature, size_t Capacity = 64>
+	class inplace_function;
+
+	template <typename R, typename... Args, size_t Capacity>
+	class inplace_function<R(Args...), Capacity> {
+	public:
+		inplace_function() noexcept = default;
+		inplace_function(std::nullptr_t) noexcept { }
+
+		template <typename F, typename D = std::decay_t<F>>
+			requires(!std::is_same_v<D, inplace_function> && std::is_invocable_r_v<R, D &, Args...>)
+		inplace_function(F &&f) {
+			if constexpr (std::is_pointer_v<D> || std::is_member_pointer_v<D> || std::is_same_v<D, std::function<R(Args...)>>) {
+				if (!f) {
+					return;
+				}
+			}
+
+			if constexpr (fitsInline<D>()) {
+				::new (static_cast<void*>(&storage)) D(std::forward<F>(f));
+				vtable = &inlineVTable<D>;
+			} else {
+				::new (static_cast<void*>(&storage)) D*(new D(std::forward<F>(f)));
+				vtable = &heapVTable<D>;
+				inplace_function_stats::heapAllocations().fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		inplace_function(inplace_function &&other) noexcept {
+			moveFrom(other);
+		}
+
+		inplace_function &operator=(inplace_function &&other) noexcept {
+			if (this != &other) {
+				reset();
+				moveFrom(other);
+			}
+			return *this;
+		}
+
+		inplace_function &operator=(std::nullptr_t) noexcept {
+			reset();
+			return *this;
+		}
+
+		inplace_function(const inplace_function &) = delete;
+		inplace_function &operator=(const inplace_function &) = delete;
+
+		~inplace_function() {
+			reset();
+		}
+
+		R operator()(Args... args) const {
+			if (!vtable) {
+				throw std::bad_function_call();
+			}
+			return vtable->invoke(const_cast<void*>(static_cast<const void*>(&storage)), std::forward<Args>(args)...);
+		}
+
+		explicit operator bool() const noexcept {
+			return vtable != nullptr;
+		}
+
+		bool operator==(std::nullptr_t) const noexcept {
+			return vtable == nullptr;
+		}
+
+		void reset() noexcept {
+			if (vtable) {
+				vtable->destroy(&storage);
+				vtable = nullptr;
+			}
+		}
+
+	private:
+		struct VTable {
+			R (*invoke)(void*, Args &&...);
+			void (*move)(void* dst, void* src) noexcept;
+			void (*destroy)(void*) noexcept;
+		};
+
+		template <typename D>
+		static constexpr bool fitsInline() {
+			return sizeof(D) <= Capacity && alignof(D) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<D>;
+		}
+
+		template <typename D>
+		static constexpr VTable inlineVTable {
+			[](void* p, Args &&... args) -> R { return std::invoke(*static_cast<D*>(p), std::forward<Args>(args)...); },
+			[](void* dst, void* src) noexcept {
+				::new (dst) D(std::move(*static_cast<D*>(src)));
+				static_cast<D*>(src)->~D();
+			},
+			[](void* p) noexcept { static_cast<D*>(p)->~D(); }
+		};
+
+		template <typename D>
+		static constexpr VTable heapVTable {
+			[](void* p, Args &&... args) -> R { return std::invoke(**static_cast<D**>(p), std::forward<Args>(args)...); },
+			[](void* dst, void* src) noexcept { ::new (dst) D*(*static_cast<D**>(src)); },
+			[](void* p) noexcept { delete *static_cast<D**>(p); }
+		};
+
+		void moveFrom(inplace_function &other) noexcept {
+			if (other.vtable) {
+				other.vtable->move(&storage, &other.storage);
+				vtable = std::exchange(other.vtable, nullptr);
+			}
+		}
+
+		alignas(std::max_align_t) std::byte storage[Capacity];
+		const VTable* vtable = nullptr;
+	};
+}
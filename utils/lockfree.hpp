@@ -74,3 +74,48 @@ public:
 		::operator delete(p);
 	}
 };
+
+/**
+ * Bounded lock-free MPSC queue with an unbounded, mutex guarded overflow.
+ *
+ * Producers only take the mutex when the ring is full, and keep using the overflow
+ * until the consumer drains it, so the order of a single producer is preserved.
+ * The consumer (drain) only takes the mutex when something overflowed.
+ */
+template <typename T, size_t CAPACITY>
+class LockfreeOverflowQueue {
+public:
+	void push(T &&value) {
+		if (!overflowing.load(std::memory_order_acquire) && ring.try_push(std::move(value))) {
+			return;
+		}
+
+		std::scoped_lock lock(mutex);
+		overflow.emplace_back(std::move(value));
+		overflowing.store(true, std::memory_order_release);
+	}
+
+	// Single consumer only
+	template <typename F>
+	void drain(F &&consume) {
+		T value;
+		while (ring.try_pop(value)) {
+			consume(std::move(value));
+		}
+
+		if (overflowing.load(std::memory_order_acquire)) {
+			std::scoped_lock lock(mutex);
+			for (auto &item : overflow) {
+				consume(std::move(item));
+			}
+			overflow.clear();
+			overflowing.store(false, std::memory_order_release);
+		}
+	}
+
+private:
+	atomic_queue::AtomicQueue2<T, CAPACITY> ring;
+	std::atomic_bool overflowing = false;
+	std::vector<T> overflow;
+	std::mutex mutex;
+};
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////
+// Crystal Server - an opensource roleplaying game
+////////////////////////////////////////////////////////////////////////
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+/**
+ * Prefix trie over ASCII case-folded words (same folding as strncasecmp in the C locale).
+ * Nodes and values live in flat vectors and every node keeps its edges sorted, so lookups
+ * cost O(length) and never allocate. Built while scripts load, cleared on reload.
+ */
+template <typename T>
+class WordTrie {
+public:
+	void clear() {
+		nodes.assign(1, Node {});
+		values.clear();
+	}
+
+	/**
+	 * Returns the value stored under the word, default constructing it first if needed.
+	 * The reference is invalidated by the next emplace.
+	 */
+	T &emplace(std::string_view word) {
+		uint32_t node = 0;
+		for (const char ch : word) {
+			const auto folded = fold(ch);
+			auto &edges = nodes[node].edges;
+			const auto it = std::ranges::lower_bound(edges, folded, {}, &Edge::ch);
+			if (it != edges.end() && it->ch == folded) {
+				node = it->node;
+				continue;
+			}
+
+			const auto next = static_cast<uint32_t>(nodes.size());
+			edges.insert(it, Edge { folded, next });
+			nodes.emplace_back();
+			node = next;
+		}
+
+		auto &value = nodes[node].value;
+		if (value == NO_VALUE) {
+			value = static_cast<uint32_t>(values.size());
+			values.emplace_back();
+		}
+		return values[value];
+	}
+
+	const T* find(std::string_view word) const {
+		uint32_t node = 0;
+		for (const char ch : word) {
+			node = child(node, fold(ch));
+			if (node == NO_NODE) {
+				return nullptr;
+			}
+		}
+		return valueOf(node);
+	}
+
+	/**
+	 * Value of the longest stored word that is a prefix of text, its length goes to matchLength.
+	 */
+	const T* findLongestPrefix(std::string_view text, size_t &matchLength) const {
+		const T* match = valueOf(0);
+		matchLength = 0;
+
+		uint32_t node = 0;
+		for (size_t pos = 0; pos < text.size(); ++pos) {
+			node = child(node, fold(text[pos]));
+			if (node == NO_NODE) {
+				break;
+			}
+
+			if (const auto* value = valueOf(node)) {
+				match = value;
+				matchLength = pos + 1;
+			}
+		}
+		return match;
+	}
+
+	[[nodiscard]] size_t size() const {
+		return values.size();
+	}
+
+	[[nodiscard]] bool empty() const {
+		return values.empty();
+	}
+
+private:
+	static constexpr uint32_t NO_NODE = 0;
+	static constexpr uint32_t NO_VALUE = std::numeric_limits<uint32_t>::max();
+
+	struct Edge {
+		uint8_t ch;
+		uint32_t node;
+	};
+
+	struct Node {
+		std::vector<Edge> edges;
+		uint32_t value = NO_VALUE;
+	};
+
+	static uint8_t fold(char ch) {
+		const auto byte = static_cast<uint8_t>(ch);
+		return byte >= 'A' && byte <= 'Z' ? byte + ('a' - 'A') : byte;
+	}
+
+	// The root is never a child, so its index doubles as "no node"
+	uint32_t child(uint32_t node, uint8_t ch) const {
+		const auto &edges = nodes[node].edges;
+		const auto it = std::ranges::lower_bound(edges, ch, {}, &Edge::ch);
+		return it != edges.end() && it->ch == ch ? it->node : NO_NODE;
+	}
+
+	const T* valueOf(uint32_t node) const {
+		const auto value = nodes[node].value;
+		return value == NO_VALUE ? nullptr : &values[value];
+	}
+
+	std::vector<Node> nodes { Node {} };
+	std::vector<T> values;
+};